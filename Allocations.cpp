@@ -0,0 +1,359 @@
+#include "Allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+
+namespace allocations {
+
+	namespace {
+
+		const uint32_t subsystem_count = static_cast<uint32_t>(Subsystem::eCount);
+
+		std::atomic<uint64_t> allocation_counts[subsystem_count] = {};
+
+		thread_local Subsystem current_subsystem = Subsystem::eGeneral;
+
+		// Sits directly in front of each tracked block
+		struct TrackedHeader {
+
+			size_t size;
+			size_t offset;
+
+		};
+
+		void count(Subsystem subsystem) {
+
+			allocation_counts[static_cast<uint32_t>(subsystem)].fetch_add(1, std::memory_order_relaxed);
+
+		}
+
+		void* allocate(size_t size) {
+
+			count(current_subsystem);
+
+			// Zero-byte requests must still return a unique pointer
+			void* memory = std::malloc(size > 0 ? size : 1);
+
+			if (!memory) {
+
+				throw std::bad_alloc();
+
+			}
+
+			return memory;
+
+		}
+
+		void* allocateUncounted(size_t size, size_t alignment) {
+
+#ifdef _MSC_VER
+			void* memory = _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+			// aligned_alloc wants the size in whole multiples of the alignment
+			size_t rounded_size = ((size > 0 ? size : 1) + alignment - 1) / alignment * alignment;
+			void* memory = std::aligned_alloc(alignment, rounded_size);
+#endif
+
+			return memory;
+
+		}
+
+		void* allocateAligned(size_t size, size_t alignment) {
+
+			count(current_subsystem);
+			void* memory = allocateUncounted(size, alignment);
+
+			if (!memory) {
+
+				throw std::bad_alloc();
+
+			}
+
+			return memory;
+
+		}
+
+		void freeAligned(void* memory) {
+
+#ifdef _MSC_VER
+			_aligned_free(memory);
+#else
+			std::free(memory);
+#endif
+
+		}
+
+	}
+
+	const char* getSubsystemName(Subsystem subsystem) {
+
+		switch (subsystem) {
+
+		case Subsystem::eGeneral:
+			return "general";
+		case Subsystem::eScene:
+			return "scene";
+		case Subsystem::eRender:
+			return "render";
+		case Subsystem::eVulkan:
+			return "vulkan";
+		default:
+			return "unknown";
+
+		}
+
+	}
+
+	uint64_t Counts::get(Subsystem subsystem) const {
+
+		return allocations[static_cast<uint32_t>(subsystem)];
+
+	}
+
+	uint64_t Counts::getTotal() const {
+
+		uint64_t total = 0;
+
+		for (uint32_t i = 0; i < subsystem_count; ++i) {
+
+			total += allocations[i];
+
+		}
+
+		return total;
+
+	}
+
+	Counts Counts::operator-(const Counts& earlier) const {
+
+		Counts difference;
+
+		for (uint32_t i = 0; i < subsystem_count; ++i) {
+
+			difference.allocations[i] = allocations[i] - earlier.allocations[i];
+
+		}
+
+		return difference;
+
+	}
+
+	uint64_t getAllocationCount() {
+
+		return getCounts().getTotal();
+
+	}
+
+	Counts getCounts() {
+
+		Counts counts;
+
+		for (uint32_t i = 0; i < subsystem_count; ++i) {
+
+			counts.allocations[i] = allocation_counts[i].load(std::memory_order_relaxed);
+
+		}
+
+		return counts;
+
+	}
+
+	Subsystem getCurrentSubsystem() {
+
+		return current_subsystem;
+
+	}
+
+	Scope::Scope(Subsystem subsystem) {
+
+		previous = current_subsystem;
+		current_subsystem = subsystem;
+
+	}
+
+	Scope::~Scope() {
+
+		current_subsystem = previous;
+
+	}
+
+	void* allocateTracked(size_t size, size_t alignment, Subsystem subsystem) {
+
+		// The header takes a whole alignment step so the memory after it stays aligned
+		alignment = std::max(alignment, sizeof(TrackedHeader));
+		char* block = static_cast<char*>(allocateUncounted(size + alignment, alignment));
+
+		if (!block) {
+
+			return nullptr;
+
+		}
+
+		count(subsystem);
+
+		char* memory = block + alignment;
+		TrackedHeader* header = reinterpret_cast<TrackedHeader*>(memory) - 1;
+		header->size = size;
+		header->offset = alignment;
+
+		return memory;
+
+	}
+
+	void* reallocateTracked(void* memory, size_t size, size_t alignment, Subsystem subsystem) {
+
+		if (!memory) {
+
+			return allocateTracked(size, alignment, subsystem);
+
+		}
+
+		if (size == 0) {
+
+			freeTracked(memory);
+			return nullptr;
+
+		}
+
+		void* moved = allocateTracked(size, alignment, subsystem);
+
+		if (!moved) {
+
+			return nullptr;
+
+		}
+
+		const TrackedHeader* header = static_cast<const TrackedHeader*>(memory) - 1;
+		std::memcpy(moved, memory, std::min(size, header->size));
+		freeTracked(memory);
+
+		return moved;
+
+	}
+
+	void freeTracked(void* memory) {
+
+		if (!memory) {
+
+			return;
+
+		}
+
+		const TrackedHeader* header = static_cast<const TrackedHeader*>(memory) - 1;
+		freeAligned(static_cast<char*>(memory) - header->offset);
+
+	}
+
+	void countInternal(Subsystem subsystem) {
+
+		count(subsystem);
+
+	}
+
+}
+
+// Replacing the global operators routes every C++ allocation through the counter
+
+void* operator new(size_t size) {
+
+	return allocations::allocate(size);
+
+}
+
+void* operator new[](size_t size) {
+
+	return allocations::allocate(size);
+
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+
+	try {
+
+		return allocations::allocate(size);
+
+	}
+	catch (const std::bad_alloc&) {
+
+		return nullptr;
+
+	}
+
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+
+	try {
+
+		return allocations::allocate(size);
+
+	}
+	catch (const std::bad_alloc&) {
+
+		return nullptr;
+
+	}
+
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+
+	return allocations::allocateAligned(size, static_cast<size_t>(alignment));
+
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+
+	return allocations::allocateAligned(size, static_cast<size_t>(alignment));
+
+}
+
+void operator delete(void* memory) noexcept {
+
+	std::free(memory);
+
+}
+
+void operator delete[](void* memory) noexcept {
+
+	std::free(memory);
+
+}
+
+void operator delete(void* memory, size_t) noexcept {
+
+	std::free(memory);
+
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+
+	std::free(memory);
+
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+
+	allocations::freeAligned(memory);
+
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept {
+
+	allocations::freeAligned(memory);
+
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept {
+
+	allocations::freeAligned(memory);
+
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept {
+
+	allocations::freeAligned(memory);
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace allocations {
+
+	// Who an allocation is charged to. Each thread charges its own allocations to the subsystem of its
+	// innermost Scope, jobs run under the subsystem of the thread that spawned them
+	enum class Subsystem : uint32_t {
+
+		eGeneral,
+		eScene,
+		eRender,
+		// Host memory the Vulkan driver asks for through the allocation callbacks
+		eVulkan,
+		eCount
+
+	};
+
+	const char* getSubsystemName(Subsystem subsystem);
+
+	struct Counts {
+
+		uint64_t allocations[static_cast<uint32_t>(Subsystem::eCount)];
+
+		uint64_t get(Subsystem subsystem) const;
+		uint64_t getTotal() const;
+		// Allocations made between two reads
+		Counts operator-(const Counts& earlier) const;
+
+	};
+
+	// Calls to the global operator new and Vulkan allocation callbacks since startup, from every thread.
+	// Differences between two reads show whether code in between allocated
+	uint64_t getAllocationCount();
+	Counts getCounts();
+
+	Subsystem getCurrentSubsystem();
+
+	// Charges the calling thread's allocations to a subsystem until it goes out of scope
+	class Scope {
+
+	public:
+
+		explicit Scope(Subsystem subsystem);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+
+		Subsystem previous;
+
+	};
+
+	// Counted allocations for the Vulkan callbacks, which need an alignment and a realloc the global operators lack.
+	// The block size is kept in front of the memory so reallocate knows how much to copy
+	void* allocateTracked(size_t size, size_t alignment, Subsystem subsystem);
+	void* reallocateTracked(void* memory, size_t size, size_t alignment, Subsystem subsystem);
+	void freeTracked(void* memory);
+
+	// The driver allocating memory itself, reported through the internal allocation notification
+	void countInternal(Subsystem subsystem);
+
+}
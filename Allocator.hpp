@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include "Allocations.hpp"
+
+namespace vkUtil {
+
+	// Inline unlike the other helpers, translation units besides Engine.cpp create objects too
+
+	// Driver requests go through the tracked allocator, charged to Vulkan whichever scope is active
+	inline VKAPI_ATTR void* VKAPI_CALL allocateHost(void*, size_t size, size_t alignment, VkSystemAllocationScope) {
+
+		return allocations::allocateTracked(size, alignment, allocations::Subsystem::eVulkan);
+
+	}
+
+	inline VKAPI_ATTR void* VKAPI_CALL reallocateHost(void*, void* memory, size_t size, size_t alignment, VkSystemAllocationScope) {
+
+		return allocations::reallocateTracked(memory, size, alignment, allocations::Subsystem::eVulkan);
+
+	}
+
+	inline VKAPI_ATTR void VKAPI_CALL freeHost(void*, void* memory) {
+
+		allocations::freeTracked(memory);
+
+	}
+
+	inline VKAPI_ATTR void VKAPI_CALL notifyInternalAllocation(void*, size_t, VkInternalAllocationType, VkSystemAllocationScope) {
+
+		allocations::countInternal(allocations::Subsystem::eVulkan);
+
+	}
+
+	inline VKAPI_ATTR void VKAPI_CALL notifyInternalFree(void*, size_t, VkInternalAllocationType, VkSystemAllocationScope) {
+
+	}
+
+	// Counts the driver's host allocations, passed to every create call and its matching destroy
+	inline const vk::AllocationCallbacks* hostAllocator() {
+
+		static const vk::AllocationCallbacks callbacks(
+			nullptr, allocateHost, reallocateHost, freeHost, notifyInternalAllocation, notifyInternalFree
+		);
+
+		return &callbacks;
+
+	}
+
+}
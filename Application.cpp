@@ -1,12 +1,28 @@
 #include "Application.hpp"
+#include "Benchmarks.hpp"
+#include "RenderThread.hpp"
+#include "Allocations.hpp"
+#include <thread>
 
-Application::Application(const bool& debug, int width, int height) {
+Application::Application(const bool& debug, const bool& render_thread, int width, int height, const EngineSettings& settings) {
+
+	start_time = std::chrono::steady_clock::now();
+
+	this->render_thread = render_thread;
 
 	buildGlfwWindow(debug, width, height);
 
-	graphics_engine = new Engine(debug, width, height, window);
+	// The main thread joins in whenever it waits on jobs, so one worker fewer than there are cores.
+	// Made ahead of the engine, which compiles its pipelines on it
+	job_system = new jobs::JobSystem(std::max(1u, std::thread::hardware_concurrency()) - 1);
+
+	graphics_engine = new Engine(debug, width, height, window, settings, job_system);
 
-	scene = new Scene();
+	scene = new Scene(job_system);
+
+	snapshot_index = 0;
+	readFramebufferSize(snapshots[0]);
+	extractSnapshot(snapshots[0]);
 
 }
 
@@ -27,13 +43,190 @@ void Application::buildGlfwWindow(const bool& debug, int width, int height) {
 
 void Application::runApplication() {
 
+	if (render_thread) {
+
+		runRenderThread();
+		return;
+
+	}
+
 	while (!glfwWindowShouldClose(window)) {
 
 		glfwPollEvents();
-		graphics_engine->render(scene);
+		waitWhileMinimized();
+		renderFrame();
+		calculateFrameRate();
+	}
+
+
+}
+
+void Application::runRenderThread() {
+
+	RenderThread renderer(graphics_engine);
+
+	// The next snapshot is extracted while the render thread records and submits the last one
+	while (!glfwWindowShouldClose(window)) {
+
+		glfwPollEvents();
+		waitWhileMinimized();
+
+		SceneSnapshot& snapshot = renderer.getSnapshot();
+		readFramebufferSize(snapshot);
+		extractSnapshot(snapshot);
+
+		renderer.publish();
 		calculateFrameRate();
+
 	}
 
+}
+
+void Application::readFramebufferSize(SceneSnapshot& snapshot) {
+
+	glfwGetFramebufferSize(window, &snapshot.framebuffer_width, &snapshot.framebuffer_height);
+
+}
+
+void Application::extractSnapshot(SceneSnapshot& snapshot) {
+
+	float aspect_ratio = static_cast<float>(snapshot.framebuffer_width) / static_cast<float>(std::max(1, snapshot.framebuffer_height));
+	scene->extractSnapshot(aspect_ratio, snapshot);
+
+}
+
+void Application::renderFrame() {
+
+	SceneSnapshot& current = snapshots[snapshot_index];
+	SceneSnapshot& next = snapshots[1 - snapshot_index];
+
+	readFramebufferSize(next);
+
+	// The scene is only read through the snapshot being rendered, so the next one can be extracted meanwhile
+	jobs::Counter extraction;
+	job_system->run([this, &next]() { extractSnapshot(next); }, extraction);
+
+	graphics_engine->render(current);
+	job_system->wait(extraction);
+
+	snapshot_index = 1 - snapshot_index;
+
+}
+
+void Application::waitWhileMinimized() {
+
+	// GLFW only waits for events on the main thread, so the engine skips frames and the waiting happens here
+	int framebuffer_width, framebuffer_height;
+	glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+
+	while ((framebuffer_width == 0 || framebuffer_height == 0) && !glfwWindowShouldClose(window)) {
+
+		glfwWaitEvents();
+		glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+
+	}
+
+}
+
+bool Application::runBenchmark() {
+
+	// Nothing has been drawn yet, so this frame is the one the startup time is measured to
+	renderFrame();
+	std::cout << "Startup to first frame: " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count() << " ms\n";
+
+	bool allocation_free = benchmark::runCpuBenchmarks(*job_system);
+	graphics_engine->benchmarkPipelineWarmUp();
+	graphics_engine->benchmarkShaderOptimization();
+	graphics_engine->benchmarkPipelineLibraries();
+
+	const double seconds_per_mode = 5.0;
+
+	graphics_engine->setDepthPrepass(false);
+	graphics_engine->setDrawBatching(false);
+	allocation_free &= benchmarkFrames("Depth test only, one draw per object", seconds_per_mode);
+
+	graphics_engine->setDrawBatching(true);
+	allocation_free &= benchmarkFrames("Depth test only", seconds_per_mode);
+
+	graphics_engine->setDepthPrepass(true);
+	allocation_free &= benchmarkFrames("Depth pre-pass + EQUAL shading", seconds_per_mode);
+
+	// Switching modes back and forth should be served from the cache after the first time
+	graphics_engine->setDepthPrepass(false);
+	graphics_engine->setDepthPrepass(true);
+
+	vkUtil::PipelineCacheStatistics pipeline_statistics = graphics_engine->getPipelineCacheStatistics();
+	std::cout << "Pipeline cache: " << pipeline_statistics.pipeline_hits << " hits, " << pipeline_statistics.pipeline_misses << " misses, "
+		<< pipeline_statistics.layout_hits << "/" << pipeline_statistics.layout_misses << " layout and "
+		<< pipeline_statistics.render_pass_hits << "/" << pipeline_statistics.render_pass_misses << " render pass and "
+		<< pipeline_statistics.library_hits << "/" << pipeline_statistics.library_misses << " library hits/misses, "
+		<< pipeline_statistics.creation_time << " ms building pipelines\n";
+
+	return allocation_free;
+
+}
+
+bool Application::benchmarkFrames(const std::string& label, double seconds) {
+
+	// Let the first frames of a new mode settle before measuring
+	double warmup_end = glfwGetTime() + 0.5;
+
+	while (!glfwWindowShouldClose(window) && glfwGetTime() < warmup_end) {
+
+		glfwPollEvents();
+		renderFrame();
+
+	}
+
+	int frames = 0;
+	vkUtil::FrameStatistics totals = {};
+	allocations::Counts allocations_before = allocations::getCounts();
+	double start_time = glfwGetTime();
+
+	while (!glfwWindowShouldClose(window) && glfwGetTime() - start_time < seconds) {
+
+		glfwPollEvents();
+		renderFrame();
+
+		vkUtil::FrameStatistics statistics = graphics_engine->getStatistics();
+		totals.gpu_frame_time += statistics.gpu_frame_time;
+		totals.depth_prepass_time += statistics.depth_prepass_time;
+		totals.shading_time += statistics.shading_time;
+		totals.draw_count += statistics.draw_count;
+		totals.batch_count += statistics.batch_count;
+		totals.pipeline_binds += statistics.pipeline_binds;
+		totals.descriptor_set_binds += statistics.descriptor_set_binds;
+		++frames;
+
+	}
+
+	double elapsed = glfwGetTime() - start_time;
+	allocations::Counts frame_allocations = allocations::getCounts() - allocations_before;
+	frames = std::max(1, frames);
+
+	// The driver's own allocations are reported but not held against the frame, the engine can't avoid them
+	uint64_t engine_allocations = frame_allocations.getTotal() - frame_allocations.get(allocations::Subsystem::eVulkan);
+
+	std::cout << label << ": " << frames / elapsed << " fps, GPU "
+		<< totals.gpu_frame_time / frames << " ms/frame (pre-pass "
+		<< totals.depth_prepass_time / frames << " ms, shading "
+		<< totals.shading_time / frames << " ms), "
+		<< totals.batch_count / frames << " draws of " << totals.draw_count / std::max(1u, totals.batch_count) << " objects on average, "
+		<< totals.pipeline_binds / frames << " pipeline and " << totals.descriptor_set_binds / frames << " descriptor set binds per frame, "
+		<< engine_allocations << " heap allocations" << (engine_allocations == 0 ? "\n" : " (should be none)\n");
+
+	std::cout << "  allocations per frame:";
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(allocations::Subsystem::eCount); ++i) {
+
+		allocations::Subsystem subsystem = static_cast<allocations::Subsystem>(i);
+		std::cout << " " << allocations::getSubsystemName(subsystem) << " " << static_cast<double>(frame_allocations.get(subsystem)) / frames;
+
+	}
+
+	std::cout << "\n";
+
+	return engine_allocations == 0;
 
 }
 
@@ -61,5 +254,6 @@ Application::~Application() {
 
 	delete graphics_engine;
 	delete scene;
+	delete job_system;
 
 }
\ No newline at end of file
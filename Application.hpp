@@ -4,6 +4,8 @@
 #include <vulkan/vulkan.hpp>
 #include "Engine.hpp"
 #include "Scene.hpp"
+#include "JobSystem.hpp"
+#include <chrono>
 
 class Application {
 
@@ -12,6 +14,16 @@ private:
 	Engine* graphics_engine;
 	GLFWwindow* window;
 	Scene* scene;
+	jobs::JobSystem* job_system;
+	// Render on a thread of its own from scene snapshots instead of between event polls
+	bool render_thread;
+
+	// Without the render thread one snapshot is rendered while the next is extracted
+	SceneSnapshot snapshots[2];
+	int snapshot_index;
+
+	// Taken as the application starts, for the startup time --benchmark reports
+	std::chrono::steady_clock::time_point start_time;
 
 	double last_time, current_time;
 	int num_frames;
@@ -21,10 +33,25 @@ private:
 
 	void calculateFrameRate();
 
+	void waitWhileMinimized();
+
+	void runRenderThread();
+
+	// Fills the snapshot's framebuffer size, main thread only
+	void readFramebufferSize(SceneSnapshot& snapshot);
+	void extractSnapshot(SceneSnapshot& snapshot);
+
+	void renderFrame();
+
+	// Returns false if the steady-state frames allocated outside the driver
+	bool benchmarkFrames(const std::string& label, double seconds);
+
 public:
 
-	Application(const bool& debug, int width, int height);
+	Application(const bool& debug, const bool& render_thread, int width, int height, const EngineSettings& settings);
 	~Application();
 	void runApplication();
+	// Returns false if a steady-state loop allocated, so scripts can catch the regression
+	bool runBenchmark();
 
 };
\ No newline at end of file
@@ -0,0 +1,675 @@
+#include "Benchmarks.hpp"
+#include "Bvh.hpp"
+#include "SpatialGrid.hpp"
+#include "TransformHierarchy.hpp"
+#include "Scene.hpp"
+#include "RenderQueue.hpp"
+#include "Allocations.hpp"
+#include <glm/glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+
+namespace benchmark {
+
+	namespace {
+
+		double millisecondsSince(std::chrono::steady_clock::time_point start) {
+
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		}
+
+		std::vector<vkUtil::AABB> makeRandomBounds(uint32_t count, std::mt19937& generator) {
+
+			std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+			std::uniform_real_distribution<float> size(0.25f, 2.0f);
+
+			std::vector<vkUtil::AABB> bounds(count);
+
+			for (vkUtil::AABB& box : bounds) {
+
+				glm::vec3 center = glm::vec3(position(generator), position(generator), position(generator));
+				glm::vec3 half_extent = glm::vec3(size(generator), size(generator), size(generator));
+				box = { center - half_extent, center + half_extent };
+
+			}
+
+			return bounds;
+
+		}
+
+		void benchmarkBvh(uint32_t object_count, jobs::JobSystem& job_system) {
+
+			std::mt19937 generator(1234);
+			std::vector<vkUtil::AABB> bounds = makeRandomBounds(object_count, generator);
+
+			vkUtil::Bvh bvh;
+
+			auto start = std::chrono::steady_clock::now();
+			bvh.build(bounds, &job_system);
+			double build_time = millisecondsSince(start);
+
+			// Every object drifts a little, as in a frame of a moving crowd
+			std::uniform_real_distribution<float> drift(-0.5f, 0.5f);
+
+			for (vkUtil::AABB& box : bounds) {
+
+				glm::vec3 offset = glm::vec3(drift(generator), drift(generator), drift(generator));
+				box.min += offset;
+				box.max += offset;
+
+			}
+
+			start = std::chrono::steady_clock::now();
+			bvh.refit(bounds);
+			double refit_time = millisecondsSince(start);
+
+			std::vector<uint32_t> moved_objects;
+
+			for (uint32_t i = 0; i < object_count; i += 100) {
+
+				moved_objects.push_back(i);
+
+			}
+
+			start = std::chrono::steady_clock::now();
+			bvh.refit(bounds, moved_objects);
+			double partial_refit_time = millisecondsSince(start);
+
+			glm::mat4 view = glm::lookAtLH(glm::vec3(0.0f, 0.0f, -600.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			glm::mat4 projection = glm::perspectiveLH_ZO(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+			vkUtil::Frustum frustum = vkUtil::extractFrustum(projection * view);
+
+			std::vector<uint32_t> visible_objects;
+			visible_objects.reserve(object_count);
+
+			start = std::chrono::steady_clock::now();
+			bvh.cullFrustum(bounds, frustum, visible_objects);
+			double cull_time = millisecondsSince(start);
+
+			const uint32_t ray_count = 100000;
+			std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+			uint32_t hits = 0;
+
+			start = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < ray_count; ++i) {
+
+				glm::vec3 origin = glm::vec3(coordinate(generator), coordinate(generator), -600.0f);
+				glm::vec3 direction = glm::vec3(coordinate(generator), coordinate(generator), 600.0f) * 0.001f;
+				hits += bvh.raycast(bounds, origin, direction, std::numeric_limits<float>::max()).hit ? 1 : 0;
+
+			}
+
+			double ray_time = millisecondsSince(start);
+
+			std::cout << "BVH, " << object_count << " objects, " << bvh.getNodes().size() << " nodes\n"
+				<< "  SAH build: " << build_time << " ms\n"
+				<< "  full refit: " << refit_time << " ms\n"
+				<< "  refit of " << moved_objects.size() << " moved objects: " << partial_refit_time << " ms\n"
+				<< "  frustum cull: " << cull_time << " ms, " << visible_objects.size() << " visible\n"
+				<< "  " << ray_count << " picking rays: " << ray_time << " ms, " << hits << " hits\n";
+
+		}
+
+		// Moving objects: the loose grid updates in place, the BVH keeps its topology and loosens
+		void benchmarkDynamicObjects(uint32_t object_count, uint32_t frame_count, jobs::JobSystem& job_system) {
+
+			std::mt19937 generator(5678);
+			std::vector<vkUtil::AABB> bounds = makeRandomBounds(object_count, generator);
+
+			// Around six objects per occupied cell at this density
+			vkUtil::SpatialGrid grid(50.0f);
+			vkUtil::Bvh bvh;
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < object_count; ++i) {
+
+				grid.insert(i, bounds[i]);
+
+			}
+
+			double insert_time = millisecondsSince(start);
+
+			bvh.build(bounds, &job_system);
+
+			glm::mat4 view = glm::lookAtLH(glm::vec3(0.0f, 0.0f, -600.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+			glm::mat4 projection = glm::perspectiveLH_ZO(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+			vkUtil::Frustum frustum = vkUtil::extractFrustum(projection * view);
+
+			std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+			std::vector<uint32_t> visible_objects;
+			visible_objects.reserve(object_count);
+
+			double move_time = 0.0;
+			double query_time = 0.0;
+			double parallel_query_time = 0.0;
+			double refit_time = 0.0;
+			double bvh_query_time = 0.0;
+			double last_bvh_query_time = 0.0;
+
+			for (uint32_t frame = 0; frame < frame_count; ++frame) {
+
+				for (vkUtil::AABB& box : bounds) {
+
+					glm::vec3 offset = glm::vec3(step(generator), step(generator), step(generator));
+					box.min += offset;
+					box.max += offset;
+
+				}
+
+				start = std::chrono::steady_clock::now();
+
+				for (uint32_t i = 0; i < object_count; ++i) {
+
+					grid.move(i, bounds[i]);
+
+				}
+
+				move_time += millisecondsSince(start);
+
+				start = std::chrono::steady_clock::now();
+				grid.queryFrustum(frustum, visible_objects);
+				query_time += millisecondsSince(start);
+
+				start = std::chrono::steady_clock::now();
+				grid.queryFrustumParallel(frustum, visible_objects, job_system);
+				parallel_query_time += millisecondsSince(start);
+				job_system.resetThreadArenas();
+
+				start = std::chrono::steady_clock::now();
+				bvh.refit(bounds);
+				refit_time += millisecondsSince(start);
+
+				start = std::chrono::steady_clock::now();
+				bvh.cullFrustum(bounds, frustum, visible_objects);
+				last_bvh_query_time = millisecondsSince(start);
+				bvh_query_time += last_bvh_query_time;
+
+			}
+
+			bvh.build(bounds, &job_system);
+
+			start = std::chrono::steady_clock::now();
+			bvh.cullFrustum(bounds, frustum, visible_objects);
+			double rebuilt_query_time = millisecondsSince(start);
+
+			std::cout << "Dynamic objects, " << object_count << " objects moving for " << frame_count << " frames\n"
+				<< "  grid insert: " << object_count / insert_time / 1000.0 << " M objects/s\n"
+				<< "  grid move: " << object_count * frame_count / move_time / 1000.0 << " M objects/s\n"
+				<< "  grid frustum query: " << query_time / frame_count << " ms, "
+				<< parallel_query_time / frame_count << " ms on " << job_system.getThreadCount() << " threads\n"
+				<< "  BVH refit: " << refit_time / frame_count << " ms, query: " << bvh_query_time / frame_count << " ms\n"
+				<< "  BVH query after " << frame_count << " frames of refits: "
+				<< last_bvh_query_time << " ms, " << rebuilt_query_time << " ms once rebuilt\n";
+
+		}
+
+		void benchmarkEntityStore(uint32_t entity_count) {
+
+			std::mt19937 generator(9012);
+			std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+
+			ecs::EntityStore entities;
+			std::vector<ecs::Entity> handles(entity_count);
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < entity_count; ++i) {
+
+				// Every fourth entity is static, so queries span two archetypes
+				handles[i] = (i % 4 == 0) ? entities.create<Transform, vkUtil::AABB, Renderable, StaticBody>()
+					: entities.create<Transform, vkUtil::AABB, Renderable>();
+				entities.get<Transform>(handles[i])->position = glm::vec3(position(generator), position(generator), position(generator));
+				entities.get<Renderable>(handles[i])->bounding_radius = 1.0f;
+
+			}
+
+			double create_time = millisecondsSince(start);
+
+			const glm::vec3 velocity = glm::vec3(0.01f, 0.0f, 0.0f);
+
+			// A system pass: move every object and recompute its bounds, one contiguous run per chunk
+			start = std::chrono::steady_clock::now();
+
+			entities.forEachChunk<Transform, vkUtil::AABB, const Renderable>([&](const ecs::Entity*, uint32_t count,
+				Transform* transforms, vkUtil::AABB* bounds, const Renderable* renderables) {
+
+				for (uint32_t i = 0; i < count; ++i) {
+
+					transforms[i].position += velocity;
+					glm::vec3 half_extent = glm::vec3(renderables[i].bounding_radius);
+					bounds[i] = { transforms[i].position - half_extent, transforms[i].position + half_extent };
+
+				}
+
+			});
+
+			double chunk_time = millisecondsSince(start);
+
+			// The same pass through handle lookups in shuffled order, as a per-object update would do it
+			std::vector<ecs::Entity> shuffled = handles;
+			std::shuffle(shuffled.begin(), shuffled.end(), generator);
+
+			start = std::chrono::steady_clock::now();
+
+			for (ecs::Entity entity : shuffled) {
+
+				Transform* transform = entities.get<Transform>(entity);
+				transform->position += velocity;
+				glm::vec3 half_extent = glm::vec3(entities.get<Renderable>(entity)->bounding_radius);
+				*entities.get<vkUtil::AABB>(entity) = { transform->position - half_extent, transform->position + half_extent };
+
+			}
+
+			double lookup_time = millisecondsSince(start);
+
+			// Churn: a third of the entities die and are replaced, recycling their indices
+			start = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < entity_count; i += 3) {
+
+				entities.destroy(handles[i]);
+				handles[i] = entities.create<Transform, vkUtil::AABB, Renderable>();
+
+			}
+
+			double churn_time = millisecondsSince(start);
+
+			std::cout << "Entity store, " << entity_count << " entities\n"
+				<< "  create: " << create_time << " ms\n"
+				<< "  transform and bounds update by chunk: " << chunk_time << " ms\n"
+				<< "  same update by handle lookup: " << lookup_time << " ms\n"
+				<< "  destroy and recreate a third: " << churn_time << " ms\n";
+
+		}
+
+		void benchmarkTransformHierarchy(uint32_t object_count, jobs::JobSystem& job_system) {
+
+			std::mt19937 generator(3456);
+			std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+
+			// Every object past the roots hangs off a random earlier one, which gives a few dozen levels
+			const uint32_t root_count = object_count / 100;
+			vkUtil::TransformHierarchy hierarchy;
+
+			for (uint32_t i = 0; i < object_count; ++i) {
+
+				uint32_t parent = i < root_count ? vkUtil::TransformHierarchy::no_parent : generator() % i;
+				glm::mat4 local = glm::translate(glm::mat4(1.0f), glm::vec3(offset(generator), offset(generator), offset(generator)));
+				hierarchy.insert(i, parent, local);
+
+			}
+
+			std::vector<uint32_t> changed_objects;
+
+			auto start = std::chrono::steady_clock::now();
+			hierarchy.update(&job_system, changed_objects);
+			double full_time = millisecondsSince(start);
+			job_system.resetThreadArenas();
+
+			changed_objects.clear();
+			start = std::chrono::steady_clock::now();
+			hierarchy.update(&job_system, changed_objects);
+			double idle_time = millisecondsSince(start);
+			job_system.resetThreadArenas();
+
+			// One root in a hundred moves, its whole subtree follows
+			for (uint32_t root = 0; root < root_count; root += 100) {
+
+				hierarchy.setLocal(root, glm::translate(glm::mat4(1.0f), glm::vec3(offset(generator), 0.0f, 0.0f)));
+
+			}
+
+			changed_objects.clear();
+			start = std::chrono::steady_clock::now();
+			hierarchy.update(&job_system, changed_objects);
+			double partial_time = millisecondsSince(start);
+			job_system.resetThreadArenas();
+
+			std::cout << "Transform hierarchy, " << object_count << " objects on " << job_system.getThreadCount() << " threads\n"
+				<< "  full update: " << full_time << " ms\n"
+				<< "  update with nothing moved: " << idle_time << " ms\n"
+				<< "  update with 1% of roots moved: " << partial_time << " ms, " << changed_objects.size() << " objects changed\n";
+
+		}
+
+		// Returns false if still frames allocated
+		bool benchmarkSnapshotExtraction(uint32_t object_count, uint32_t frame_count, jobs::JobSystem& job_system) {
+
+			std::mt19937 generator(4567);
+			std::uniform_real_distribution<float> spread(-20.0f, 20.0f);
+			std::uniform_real_distribution<float> distance(0.0f, 60.0f);
+			std::uniform_real_distribution<float> step(-0.05f, 0.05f);
+
+			Scene scene(&job_system);
+			std::vector<ecs::Entity> moving_objects;
+
+			for (uint32_t i = 0; i < object_count; ++i) {
+
+				glm::vec3 position = glm::vec3(spread(generator), spread(generator), distance(generator));
+				ecs::Entity object = scene.addObject(position, i % 4 == 0 ? SpatialClass::eDynamic : SpatialClass::eStatic);
+
+				if (i % 4 == 0) {
+
+					moving_objects.push_back(object);
+
+				}
+
+			}
+
+			SceneSnapshot snapshot;
+			snapshot.framebuffer_width = 1280;
+			snapshot.framebuffer_height = 720;
+
+			auto start = std::chrono::steady_clock::now();
+			scene.extractSnapshot(16.0f / 9.0f, snapshot);
+			double first_time = millisecondsSince(start);
+
+			double move_time = 0.0;
+			double extract_time = 0.0;
+
+			for (uint32_t frame = 0; frame < frame_count; ++frame) {
+
+				start = std::chrono::steady_clock::now();
+
+				for (ecs::Entity object : moving_objects) {
+
+					scene.moveObject(object, scene.getPosition(object.index) + glm::vec3(step(generator), step(generator), 0.0f));
+
+				}
+
+				move_time += millisecondsSince(start);
+
+				start = std::chrono::steady_clock::now();
+				scene.extractSnapshot(16.0f / 9.0f, snapshot);
+				extract_time += millisecondsSince(start);
+
+			}
+
+			// Moving objects into new grid cells allocates, so the steady state is measured with everything still
+			scene.extractSnapshot(16.0f / 9.0f, snapshot);
+			uint64_t allocations_before = allocations::getAllocationCount();
+
+			for (uint32_t frame = 0; frame < frame_count; ++frame) {
+
+				scene.extractSnapshot(16.0f / 9.0f, snapshot);
+
+			}
+
+			uint64_t steady_allocations = allocations::getAllocationCount() - allocations_before;
+
+			std::cout << "Snapshot extraction, " << object_count << " objects, a quarter moving\n"
+				<< "  first extraction: " << first_time << " ms\n"
+				<< "  moving objects: " << move_time / frame_count << " ms/frame\n"
+				<< "  extraction: " << extract_time / frame_count << " ms/frame, " << snapshot.item_count << " items, "
+				<< snapshot.arena.getCapacity() / 1024 << " KiB arena\n"
+				<< "  heap allocations extracting " << frame_count << " still frames: " << steady_allocations
+				<< (steady_allocations == 0 ? "\n" : " (should be none)\n");
+
+			return steady_allocations == 0;
+
+		}
+
+		struct BindCounts {
+
+			uint32_t pipelines;
+			uint32_t materials;
+			uint32_t meshes;
+
+		};
+
+		// Binds a recorder needs when it only rebinds what differs from the previous draw
+		BindCounts countBinds(const vkUtil::RenderQueue& queue) {
+
+			BindCounts counts = {};
+			const uint32_t unbound = 0xFFFFFFFF;
+			uint32_t pipeline = unbound, material = unbound, mesh = unbound;
+
+			for (uint32_t i = 0; i < queue.getDrawCount(); ++i) {
+
+				const vkUtil::QueuedDraw& draw = queue.getDraws()[i];
+
+				counts.pipelines += vkUtil::RenderQueue::getPipeline(draw.key) != pipeline;
+				counts.materials += vkUtil::RenderQueue::getMaterial(draw.key) != material;
+				counts.meshes += vkUtil::RenderQueue::getMesh(draw.key) != mesh;
+
+				pipeline = vkUtil::RenderQueue::getPipeline(draw.key);
+				material = vkUtil::RenderQueue::getMaterial(draw.key);
+				mesh = vkUtil::RenderQueue::getMesh(draw.key);
+
+			}
+
+			return counts;
+
+		}
+
+		// Returns false if any frame after the first allocated
+		bool benchmarkRenderQueue(uint32_t draw_count, uint32_t frame_count) {
+
+			std::mt19937 generator(6789);
+			std::uniform_real_distribution<float> depth(0.1f, 100.0f);
+
+			// Draws arrive in scene order, each with one of 4 pipelines, 64 materials and 32 meshes
+			vkUtil::RenderQueue queue;
+			vkUtil::FrameArena arena;
+			std::vector<uint64_t> keys(draw_count);
+			queue.begin(arena, draw_count);
+
+			for (uint32_t i = 0; i < draw_count; ++i) {
+
+				keys[i] = vkUtil::RenderQueue::makeKey(generator() % 4, generator() % 64, generator() % 32, depth(generator));
+				queue.add(keys[i], i);
+
+			}
+
+			BindCounts unsorted = countBinds(queue);
+
+			double radix_time = 0.0;
+			double std_sort_time = 0.0;
+			std::vector<vkUtil::QueuedDraw> std_sorted(draw_count);
+			uint64_t queue_allocations = 0;
+
+			for (uint32_t frame = 0; frame < frame_count; ++frame) {
+
+				uint64_t allocations_before = allocations::getAllocationCount();
+				arena.reset();
+				queue.begin(arena, draw_count);
+
+				for (uint32_t i = 0; i < draw_count; ++i) {
+
+					queue.add(keys[i], i);
+
+				}
+
+				std::copy(queue.getDraws(), queue.getDraws() + draw_count, std_sorted.begin());
+
+				auto start = std::chrono::steady_clock::now();
+				queue.sort();
+				radix_time += millisecondsSince(start);
+
+				// The first frame sizes the arena
+				if (frame > 0) {
+
+					queue_allocations += allocations::getAllocationCount() - allocations_before;
+
+				}
+
+
+				start = std::chrono::steady_clock::now();
+				std::sort(std_sorted.begin(), std_sorted.end(), [](const vkUtil::QueuedDraw& a, const vkUtil::QueuedDraw& b) {
+
+					return a.key < b.key;
+
+				});
+				std_sort_time += millisecondsSince(start);
+
+			}
+
+			BindCounts sorted = countBinds(queue);
+			bool same_order = std::equal(std_sorted.begin(), std_sorted.end(), queue.getDraws(),
+				[](const vkUtil::QueuedDraw& a, const vkUtil::QueuedDraw& b) { return a.key == b.key; });
+
+			std::cout << "Render queue, " << draw_count << " draws per frame\n"
+				<< "  scene order: " << unsorted.pipelines << " pipeline, " << unsorted.materials << " material and "
+				<< unsorted.meshes << " mesh binds\n"
+				<< "  sorted by key: " << sorted.pipelines << " pipeline, " << sorted.materials << " material and "
+				<< sorted.meshes << " mesh binds\n"
+				<< "  radix sort: " << radix_time / frame_count << " ms, std::sort " << std_sort_time / frame_count << " ms"
+				<< (same_order ? "" : " (orders differ)") << "\n"
+				<< "  heap allocations after the first frame: " << queue_allocations << (queue_allocations == 0 ? "\n" : " (should be none)\n");
+
+			return queue_allocations == 0;
+
+		}
+
+		// Binary tree of jobs, each splitting until the leaves: every level is a spawn the other threads can steal
+		void spawnTree(jobs::JobSystem& job_system, uint32_t depth, std::atomic<uint32_t>& leaves) {
+
+			if (depth == 0) {
+
+				leaves.fetch_add(1, std::memory_order_relaxed);
+				return;
+
+			}
+
+			jobs::Counter children;
+			job_system.run([&job_system, depth, &leaves]() { spawnTree(job_system, depth - 1, leaves); }, children);
+			spawnTree(job_system, depth - 1, leaves);
+			job_system.wait(children);
+
+		}
+
+		void benchmarkJobSystem(jobs::JobSystem& job_system) {
+
+			const uint32_t job_count = 1000000;
+			const uint32_t jobs_per_wait = 1024;
+
+			std::thread::id spawning_thread = std::this_thread::get_id();
+			std::atomic<uint32_t> stolen_jobs = 0;
+
+			// Empty jobs, so the time is all spawn, steal and completion overhead
+			auto start = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < job_count; i += jobs_per_wait) {
+
+				jobs::Counter counter;
+
+				for (uint32_t j = 0; j < jobs_per_wait; ++j) {
+
+					job_system.run([&stolen_jobs, spawning_thread]() {
+
+						if (std::this_thread::get_id() != spawning_thread) {
+
+							stolen_jobs.fetch_add(1, std::memory_order_relaxed);
+
+						}
+
+					}, counter);
+
+				}
+
+				job_system.wait(counter);
+
+			}
+
+			double spawn_time = millisecondsSince(start);
+
+			const uint32_t tree_depth = 18;
+			std::atomic<uint32_t> leaves = 0;
+
+			start = std::chrono::steady_clock::now();
+			spawnTree(job_system, tree_depth, leaves);
+			double tree_time = millisecondsSince(start);
+
+			// The same empty work through std::async, which starts a thread per task
+			const uint32_t async_count = 1000;
+
+			start = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < async_count; ++i) {
+
+				std::async(std::launch::async, []() {}).get();
+
+			}
+
+			double async_time = millisecondsSince(start);
+
+			std::vector<float> values(16 * 1024 * 1024, 1.0f);
+			std::vector<double> partial_sums;
+
+			start = std::chrono::steady_clock::now();
+			double serial_sum = 0.0;
+
+			for (float value : values) {
+
+				serial_sum += value;
+
+			}
+
+			double serial_time = millisecondsSince(start);
+
+			size_t batch_size = job_system.batchSizeFor(values.size());
+			partial_sums.assign((values.size() + batch_size - 1) / batch_size, 0.0);
+
+			start = std::chrono::steady_clock::now();
+
+			job_system.parallelFor(values.size(), batch_size, [&](size_t first, size_t last) {
+
+				double sum = 0.0;
+
+				for (size_t i = first; i < last; ++i) {
+
+					sum += values[i];
+
+				}
+
+				partial_sums[first / batch_size] = sum;
+
+			});
+
+			double parallel_sum = 0.0;
+
+			for (double sum : partial_sums) {
+
+				parallel_sum += sum;
+
+			}
+
+			double parallel_time = millisecondsSince(start);
+
+			std::cout << "Job system, " << job_system.getThreadCount() << " threads\n"
+				<< "  spawn and complete: " << spawn_time * 1000000.0 / job_count << " ns per empty job, "
+				<< stolen_jobs << " of " << job_count << " stolen\n"
+				<< "  nested spawn tree: " << tree_time * 1000000.0 / ((1u << tree_depth) - 1) << " ns per job, " << leaves << " leaves\n"
+				<< "  std::async: " << async_time * 1000000.0 / async_count << " ns per empty task\n"
+				<< "  parallel for sum of " << values.size() << " floats: " << parallel_time << " ms, serial "
+				<< serial_time << " ms" << (parallel_sum == serial_sum ? "" : " (sums differ)") << "\n";
+
+		}
+
+	}
+
+	bool runCpuBenchmarks(jobs::JobSystem& job_system) {
+
+		benchmarkJobSystem(job_system);
+		benchmarkBvh(1000000, job_system);
+		benchmarkDynamicObjects(50000, 120, job_system);
+		benchmarkEntityStore(1000000);
+		benchmarkTransformHierarchy(1000000, job_system);
+
+		bool allocation_free = benchmarkSnapshotExtraction(100000, 60, job_system);
+		allocation_free &= benchmarkRenderQueue(100000, 60);
+
+		return allocation_free;
+
+	}
+
+}
\ No newline at end of file
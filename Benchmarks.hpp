@@ -0,0 +1,11 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+namespace benchmark {
+
+	// CPU-side benchmarks, run from --benchmark ahead of the GPU modes.
+	// Returns false if a loop that should have reached a steady state still allocated
+	bool runCpuBenchmarks(jobs::JobSystem& job_system);
+
+}
\ No newline at end of file
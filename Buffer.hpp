@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+
+namespace vkUtil {
+
+	struct Buffer {
+
+		vk::Buffer buffer;
+		vk::DeviceMemory buffer_memory;
+		vk::DeviceSize size;
+
+	};
+
+	struct BufferInput {
+
+		vk::Device logical_device;
+		vk::PhysicalDevice physical_device;
+		vk::DeviceSize size;
+		vk::BufferUsageFlags usage;
+		vk::MemoryPropertyFlags memory_properties;
+
+	};
+
+}
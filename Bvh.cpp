@@ -0,0 +1,518 @@
+#include "Bvh.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace vkUtil {
+
+	namespace {
+
+		const uint32_t bin_count = 16;
+		const uint32_t max_leaf_size = 8;
+		const uint32_t invalid_node = std::numeric_limits<uint32_t>::max();
+
+		// Past this depth splits fall back to the median, which bounds the tree depth by
+		// max_sah_depth + log2(object count / max_leaf_size) and so the traversal stacks
+		const uint32_t max_sah_depth = 40;
+		const uint32_t max_stack_depth = 80;
+
+		// Ranges smaller than this are not worth a thread
+		const uint32_t parallel_build_threshold = 16384;
+		const uint32_t parallel_build_depth = 4;
+
+		struct BuildInput {
+
+			const std::vector<AABB>& bounds;
+			const std::vector<glm::vec3>& centroids;
+			std::vector<uint32_t>& object_indices;
+			jobs::JobSystem* job_system;
+
+		};
+
+		struct Bin {
+
+			AABB bounds;
+			uint32_t count;
+
+		};
+
+		AABB emptyBounds() {
+
+			return { glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()) };
+
+		}
+
+		void grow(AABB& box, const AABB& other) {
+
+			box.min = glm::min(box.min, other.min);
+			box.max = glm::max(box.max, other.max);
+
+		}
+
+		float surfaceArea(const AABB& box) {
+
+			glm::vec3 extent = glm::max(box.max - box.min, glm::vec3(0.0f));
+			return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+
+		}
+
+		uint32_t binIndex(float centroid, float axis_min, float scale) {
+
+			return std::min(bin_count - 1, static_cast<uint32_t>((centroid - axis_min) * scale));
+
+		}
+
+		void buildRange(const BuildInput& input, uint32_t begin, uint32_t end, uint32_t depth,
+						std::vector<BvhNode>& nodes, uint32_t parallel_depth) {
+
+			AABB box = emptyBounds();
+			AABB centroid_box = emptyBounds();
+
+			for (uint32_t i = begin; i < end; ++i) {
+
+				uint32_t object = input.object_indices[i];
+				grow(box, input.bounds[object]);
+				grow(centroid_box, { input.centroids[object], input.centroids[object] });
+
+			}
+
+			uint32_t count = end - begin;
+			uint32_t node_index = static_cast<uint32_t>(nodes.size());
+			nodes.push_back({ box.min, begin, box.max, count });
+
+			if (count <= 2) {
+
+				return;
+
+			}
+
+			// Split cost relative to a leaf: one traversal step plus each side's objects weighted by area
+			float parent_area = surfaceArea(box);
+			float best_cost = count * parent_area;
+			int best_axis = -1;
+			uint32_t best_split = 0;
+
+			glm::vec3 extent = centroid_box.max - centroid_box.min;
+
+			if (depth < max_sah_depth) {
+
+				// All three axes are binned in a single pass over the range
+				Bin bins[3][bin_count];
+				glm::vec3 scale = glm::vec3(0.0f);
+
+				for (int axis = 0; axis < 3; ++axis) {
+
+					for (Bin& bin : bins[axis]) {
+
+						bin = { emptyBounds(), 0 };
+
+					}
+
+					scale[axis] = extent[axis] > 0.0f ? bin_count / extent[axis] : 0.0f;
+
+				}
+
+				for (uint32_t i = begin; i < end; ++i) {
+
+					uint32_t object = input.object_indices[i];
+					const AABB& object_bounds = input.bounds[object];
+
+					for (int axis = 0; axis < 3; ++axis) {
+
+						Bin& bin = bins[axis][binIndex(input.centroids[object][axis], centroid_box.min[axis], scale[axis])];
+						grow(bin.bounds, object_bounds);
+						++bin.count;
+
+					}
+
+				}
+
+				for (int axis = 0; axis < 3; ++axis) {
+
+					if (extent[axis] <= 0.0f) {
+
+						continue;
+
+					}
+
+					float right_areas[bin_count];
+					uint32_t right_counts[bin_count];
+					AABB right_box = emptyBounds();
+					uint32_t right_count = 0;
+
+					for (uint32_t bin = bin_count - 1; bin > 0; --bin) {
+
+						grow(right_box, bins[axis][bin].bounds);
+						right_count += bins[axis][bin].count;
+						right_areas[bin] = surfaceArea(right_box);
+						right_counts[bin] = right_count;
+
+					}
+
+					AABB left_box = emptyBounds();
+					uint32_t left_count = 0;
+
+					for (uint32_t split = 1; split < bin_count; ++split) {
+
+						grow(left_box, bins[axis][split - 1].bounds);
+						left_count += bins[axis][split - 1].count;
+
+						if (left_count == 0 || right_counts[split] == 0) {
+
+							continue;
+
+						}
+
+						float cost = parent_area + surfaceArea(left_box) * left_count + right_areas[split] * right_counts[split];
+
+						if (cost < best_cost) {
+
+							best_cost = cost;
+							best_axis = axis;
+							best_split = split;
+
+						}
+
+					}
+
+				}
+
+			}
+
+			uint32_t* first = input.object_indices.data() + begin;
+			uint32_t* last = input.object_indices.data() + end;
+			uint32_t middle = begin + count / 2;
+
+			if (best_axis >= 0) {
+
+				float scale = bin_count / extent[best_axis];
+				float axis_min = centroid_box.min[best_axis];
+
+				uint32_t* partition = std::partition(first, last, [&](uint32_t object) {
+
+					return binIndex(input.centroids[object][best_axis], axis_min, scale) < best_split;
+
+				});
+
+				middle = static_cast<uint32_t>(partition - input.object_indices.data());
+
+			}
+			else if (count <= max_leaf_size) {
+
+				return;
+
+			}
+			else {
+
+				// SAH prefers a leaf that is too large, or every centroid coincides: halve along the widest axis
+				int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+				std::nth_element(first, input.object_indices.data() + middle, last, [&](uint32_t a, uint32_t b) {
+
+					return input.centroids[a][axis] < input.centroids[b][axis];
+
+				});
+
+			}
+
+			nodes[node_index].count = 0;
+
+			if (input.job_system && parallel_depth > 0 && count >= parallel_build_threshold) {
+
+				// The second child is built into its own array and spliced in behind the first
+				std::vector<BvhNode> second_nodes;
+				jobs::Counter second;
+
+				input.job_system->run([&input, &second_nodes, middle, end, depth, parallel_depth]() {
+
+					buildRange(input, middle, end, depth + 1, second_nodes, parallel_depth - 1);
+
+				}, second);
+
+				buildRange(input, begin, middle, depth + 1, nodes, parallel_depth - 1);
+				input.job_system->wait(second);
+
+				uint32_t second_offset = static_cast<uint32_t>(nodes.size());
+
+				for (BvhNode& node : second_nodes) {
+
+					if (node.count == 0) {
+
+						node.offset += second_offset;
+
+					}
+
+				}
+
+				nodes[node_index].offset = second_offset;
+				nodes.insert(nodes.end(), second_nodes.begin(), second_nodes.end());
+
+			}
+			else {
+
+				buildRange(input, begin, middle, depth + 1, nodes, 0);
+				nodes[node_index].offset = static_cast<uint32_t>(nodes.size());
+				buildRange(input, middle, end, depth + 1, nodes, 0);
+
+			}
+
+		}
+
+	}
+
+	void Bvh::build(const std::vector<AABB>& bounds, jobs::JobSystem* job_system) {
+
+		uint32_t object_count = static_cast<uint32_t>(bounds.size());
+
+		nodes.clear();
+		nodes.reserve(2 * static_cast<size_t>(object_count));
+		object_indices.resize(object_count);
+
+		std::vector<glm::vec3> centroids(object_count);
+
+		for (uint32_t i = 0; i < object_count; ++i) {
+
+			object_indices[i] = i;
+			centroids[i] = 0.5f * (bounds[i].min + bounds[i].max);
+
+		}
+
+		if (object_count > 0) {
+
+			BuildInput input = { bounds, centroids, object_indices, job_system };
+			buildRange(input, 0, object_count, 0, nodes, parallel_build_depth);
+
+		}
+
+		parents.assign(nodes.size(), invalid_node);
+		object_leaves.resize(object_count);
+
+		for (uint32_t i = 0; i < nodes.size(); ++i) {
+
+			const BvhNode& node = nodes[i];
+
+			if (node.count == 0) {
+
+				parents[i + 1] = i;
+				parents[node.offset] = i;
+
+			}
+			else {
+
+				for (uint32_t j = node.offset; j < node.offset + node.count; ++j) {
+
+					object_leaves[object_indices[j]] = i;
+
+				}
+
+			}
+
+		}
+
+	}
+
+	void Bvh::refitNode(const std::vector<AABB>& bounds, uint32_t node_index) {
+
+		BvhNode& node = nodes[node_index];
+		AABB box = emptyBounds();
+
+		if (node.count > 0) {
+
+			for (uint32_t j = node.offset; j < node.offset + node.count; ++j) {
+
+				grow(box, bounds[object_indices[j]]);
+
+			}
+
+		}
+		else {
+
+			const BvhNode& first_child = nodes[node_index + 1];
+			const BvhNode& second_child = nodes[node.offset];
+			box.min = glm::min(first_child.bounds_min, second_child.bounds_min);
+			box.max = glm::max(first_child.bounds_max, second_child.bounds_max);
+
+		}
+
+		node.bounds_min = box.min;
+		node.bounds_max = box.max;
+
+	}
+
+	void Bvh::refit(const std::vector<AABB>& bounds) {
+
+		// Children always come after their parent, so a reverse sweep is bottom-up
+		for (size_t i = nodes.size(); i-- > 0;) {
+
+			refitNode(bounds, static_cast<uint32_t>(i));
+
+		}
+
+	}
+
+	void Bvh::refit(const std::vector<AABB>& bounds, const std::vector<uint32_t>& moved_objects) {
+
+		for (uint32_t object : moved_objects) {
+
+			for (uint32_t node = object_leaves[object]; node != invalid_node; node = parents[node]) {
+
+				refitNode(bounds, node);
+
+			}
+
+		}
+
+	}
+
+	void Bvh::cullFrustum(const std::vector<AABB>& bounds, const Frustum& frustum, std::vector<uint32_t>& visible_objects) const {
+
+		visible_objects.clear();
+
+		if (nodes.empty()) {
+
+			return;
+
+		}
+
+		// Planes a node lies fully inside are dropped for its whole subtree
+		uint32_t node_stack[max_stack_depth];
+		uint32_t mask_stack[max_stack_depth];
+		uint32_t stack_size = 0;
+
+		node_stack[stack_size] = 0;
+		mask_stack[stack_size++] = 0x3F;
+
+		while (stack_size > 0) {
+
+			uint32_t node_index = node_stack[--stack_size];
+			uint32_t plane_mask = mask_stack[stack_size];
+			const BvhNode& node = nodes[node_index];
+
+			if (plane_mask != 0 && !boxInFrustum(frustum, node.bounds_min, node.bounds_max, plane_mask)) {
+
+				continue;
+
+			}
+
+			if (node.count == 0) {
+
+				node_stack[stack_size] = node.offset;
+				mask_stack[stack_size++] = plane_mask;
+				node_stack[stack_size] = node_index + 1;
+				mask_stack[stack_size++] = plane_mask;
+				continue;
+
+			}
+
+			for (uint32_t j = node.offset; j < node.offset + node.count; ++j) {
+
+				uint32_t object = object_indices[j];
+				uint32_t object_mask = plane_mask;
+
+				if (object_mask == 0 || boxInFrustum(frustum, bounds[object].min, bounds[object].max, object_mask)) {
+
+					visible_objects.push_back(object);
+
+				}
+
+			}
+
+		}
+
+	}
+
+	RayHit Bvh::raycast(const std::vector<AABB>& bounds, const glm::vec3& origin, const glm::vec3& direction, float max_distance) const {
+
+		RayHit closest = { false, 0, max_distance };
+
+		if (nodes.empty()) {
+
+			return closest;
+
+		}
+
+		glm::vec3 inverse_direction = 1.0f / direction;
+
+		uint32_t node_stack[max_stack_depth];
+		float distance_stack[max_stack_depth];
+		uint32_t stack_size = 0;
+
+		float root_distance = intersectRayBox(origin, inverse_direction, nodes[0].bounds_min, nodes[0].bounds_max);
+
+		if (root_distance <= closest.distance) {
+
+			node_stack[stack_size] = 0;
+			distance_stack[stack_size++] = root_distance;
+
+		}
+
+		while (stack_size > 0) {
+
+			uint32_t node_index = node_stack[--stack_size];
+
+			if (distance_stack[stack_size] > closest.distance) {
+
+				continue;
+
+			}
+
+			const BvhNode& node = nodes[node_index];
+
+			if (node.count > 0) {
+
+				for (uint32_t j = node.offset; j < node.offset + node.count; ++j) {
+
+					uint32_t object = object_indices[j];
+					float distance = intersectRayBox(origin, inverse_direction, bounds[object].min, bounds[object].max);
+
+					if (distance <= closest.distance) {
+
+						closest = { true, object, distance };
+
+					}
+
+				}
+
+				continue;
+
+			}
+
+			uint32_t near_child = node_index + 1;
+			uint32_t far_child = node.offset;
+			float near_distance = intersectRayBox(origin, inverse_direction, nodes[near_child].bounds_min, nodes[near_child].bounds_max);
+			float far_distance = intersectRayBox(origin, inverse_direction, nodes[far_child].bounds_min, nodes[far_child].bounds_max);
+
+			if (far_distance < near_distance) {
+
+				std::swap(near_child, far_child);
+				std::swap(near_distance, far_distance);
+
+			}
+
+			// Nearer child on top so it is visited first and can shorten the ray for the other
+			if (far_distance <= closest.distance) {
+
+				node_stack[stack_size] = far_child;
+				distance_stack[stack_size++] = far_distance;
+
+			}
+
+			if (near_distance <= closest.distance) {
+
+				node_stack[stack_size] = near_child;
+				distance_stack[stack_size++] = near_distance;
+
+			}
+
+		}
+
+		return closest;
+
+	}
+
+	const std::vector<BvhNode>& Bvh::getNodes() const {
+
+		return nodes;
+
+	}
+
+}
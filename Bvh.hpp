@@ -0,0 +1,53 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "Culling.hpp"
+#include "JobSystem.hpp"
+
+namespace vkUtil {
+
+	// 32 bytes, two to a cache line. Nodes are stored depth first, so an interior
+	// node's first child directly follows it and every subtree is one contiguous run
+	struct BvhNode {
+
+		glm::vec3 bounds_min;
+		uint32_t offset;	// interior: index of the second child, leaf: first entry in the object list
+		glm::vec3 bounds_max;
+		uint32_t count;		// objects in a leaf, 0 for interior nodes
+
+	};
+
+	class Bvh {
+
+	public:
+
+		// Binned SAH build, the top levels are split into jobs when a job system is given
+		void build(const std::vector<AABB>& bounds, jobs::JobSystem* job_system = nullptr);
+
+		// Recomputes every node for moved objects while keeping the topology, quality degrades with large motion
+		void refit(const std::vector<AABB>& bounds);
+
+		// Recomputes only the paths from the moved objects' leaves to the root
+		void refit(const std::vector<AABB>& bounds, const std::vector<uint32_t>& moved_objects);
+
+		void cullFrustum(const std::vector<AABB>& bounds, const Frustum& frustum, std::vector<uint32_t>& visible_objects) const;
+
+		// Closest object whose bounds the ray enters within max_distance, direction need not be normalized
+		RayHit raycast(const std::vector<AABB>& bounds, const glm::vec3& origin, const glm::vec3& direction, float max_distance) const;
+
+		const std::vector<BvhNode>& getNodes() const;
+
+	private:
+
+		std::vector<BvhNode> nodes;
+		std::vector<uint32_t> object_indices;
+		std::vector<uint32_t> parents;
+		std::vector<uint32_t> object_leaves;
+
+		void refitNode(const std::vector<AABB>& bounds, uint32_t node_index);
+
+	};
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 #include "QueueFamilies.hpp"
 
 
@@ -14,17 +15,16 @@ namespace vkInit {
 
 	};
 
-	vk::CommandPool makeCommandPool(const bool& debug, vk::Device logical_device, vk::PhysicalDevice physical_device, vk::SurfaceKHR surface) {
+	// Command buffers from the pool can only be submitted to queues of its family
+	vk::CommandPool makeCommandPool(const bool& debug, vk::Device logical_device, uint32_t queue_family_index) {
 
-		vkUtil::QueueFamilyIndices queue_family_indices = vkUtil::findQueueFamilies(debug, physical_device, surface);
-		
 		vk::CommandPoolCreateInfo command_pool_info = {};
 		command_pool_info.flags = vk::CommandPoolCreateFlags() | vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
-		command_pool_info.queueFamilyIndex = queue_family_indices.graphics_family.value();
+		command_pool_info.queueFamilyIndex = queue_family_index;
 
 		try {
 
-			return logical_device.createCommandPool(command_pool_info);
+			return logical_device.createCommandPool(command_pool_info, vkUtil::hostAllocator());
 
 		}
 		catch(vk::SystemError err){
@@ -42,6 +42,14 @@ namespace vkInit {
 
 	}
 
+	vk::CommandPool makeCommandPool(const bool& debug, vk::Device logical_device, vk::PhysicalDevice physical_device, vk::SurfaceKHR surface) {
+
+		vkUtil::QueueFamilyIndices queue_family_indices = vkUtil::findQueueFamilies(debug, physical_device, surface);
+
+		return makeCommandPool(debug, logical_device, queue_family_indices.graphics_family.value());
+
+	}
+
 	vk::CommandBuffer makeCommandBuffer(const bool& debug, CommandBufferInputChunk command_buffer_input_chunk) {
 
 		vk::CommandBufferAllocateInfo command_buffer_allocate_info = {};
@@ -111,5 +119,39 @@ namespace vkInit {
 
 	}
 
+	// The pool has to belong to the async compute family
+	void makeFrameComputeCommandBuffers(const bool& debug, CommandBufferInputChunk command_buffer_input_chunk) {
+
+		vk::CommandBufferAllocateInfo command_buffer_allocate_info = {};
+		command_buffer_allocate_info.commandPool = command_buffer_input_chunk.command_pool;
+		command_buffer_allocate_info.level = vk::CommandBufferLevel::ePrimary;
+		command_buffer_allocate_info.commandBufferCount = 1;
+
+		for (int i = 0; i < command_buffer_input_chunk.frames.size(); ++i) {
+
+			try {
+
+				command_buffer_input_chunk.frames[i].compute_commandbuffer = command_buffer_input_chunk.logical_device.allocateCommandBuffers(command_buffer_allocate_info)[0];
+
+				if (debug) {
+
+					std::cout << "Allocated compute command buffer for frame " << i << std::endl;
+
+				}
+			}
+			catch (vk::SystemError err) {
+
+				if (debug) {
+
+					std::cout << "Failed to create compute command buffer for frame " << i << std::endl;
+
+				}
+
+			}
+
+		}
+
+	}
+
 
 }
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "ComputeDispatch.hpp"
+
+namespace vkUtil {
+
+	namespace {
+
+		vk::ImageMemoryBarrier makeTransferBarrier(const OwnershipTransfer& transfer) {
+
+			vk::ImageMemoryBarrier barrier = {};
+			barrier.oldLayout = transfer.old_layout;
+			barrier.newLayout = transfer.new_layout;
+			barrier.srcQueueFamilyIndex = transfer.src_family;
+			barrier.dstQueueFamilyIndex = transfer.dst_family;
+			barrier.image = transfer.image;
+			barrier.subresourceRange = transfer.range;
+			return barrier;
+
+		}
+
+	}
+
+	uint32_t groupCount(uint32_t item_count, uint32_t group_size) {
+
+		return (item_count + group_size - 1) / group_size;
+
+	}
+
+	void recordBarrier(vk::CommandBuffer command_buffer, const MemoryDependency& dependency) {
+
+		vk::MemoryBarrier barrier = {};
+		barrier.srcAccessMask = dependency.src_access;
+		barrier.dstAccessMask = dependency.dst_access;
+		command_buffer.pipelineBarrier(dependency.src_stages, dependency.dst_stages, vk::DependencyFlags(), barrier, nullptr, nullptr);
+
+	}
+
+	void recordDispatch(vk::CommandBuffer command_buffer, const ComputeDispatch& dispatch, const MemoryDependency& results) {
+
+		if (dispatch.pipeline) {
+
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, dispatch.pipeline);
+
+			if (dispatch.descriptor_set) {
+
+				command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, dispatch.layout, 0, dispatch.descriptor_set, nullptr);
+
+			}
+
+			if (dispatch.push_constant_size > 0) {
+
+				command_buffer.pushConstants(dispatch.layout, vk::ShaderStageFlagBits::eCompute, 0, dispatch.push_constant_size, dispatch.push_constants);
+
+			}
+
+			command_buffer.dispatch(dispatch.group_count_x, dispatch.group_count_y, dispatch.group_count_z);
+
+		}
+
+		recordBarrier(command_buffer, results);
+
+	}
+
+
+	void recordRelease(vk::CommandBuffer command_buffer, const OwnershipTransfer& transfer, vk::PipelineStageFlags src_stages, vk::AccessFlags src_access) {
+
+		// Nothing on this queue touches the image afterwards, the acquire carries the destination side
+		vk::ImageMemoryBarrier barrier = makeTransferBarrier(transfer);
+		barrier.srcAccessMask = src_access;
+		command_buffer.pipelineBarrier(src_stages, vk::PipelineStageFlagBits::eBottomOfPipe, vk::DependencyFlags(), nullptr, nullptr, barrier);
+
+	}
+
+	void recordAcquire(vk::CommandBuffer command_buffer, const OwnershipTransfer& transfer, vk::PipelineStageFlags dst_stages, vk::AccessFlags dst_access) {
+
+		// Starting from the stages the semaphore wait blocks chains the acquire after the release, from the top of
+		// the pipe it could run before the wait
+		vk::ImageMemoryBarrier barrier = makeTransferBarrier(transfer);
+		barrier.dstAccessMask = dst_access;
+		command_buffer.pipelineBarrier(dst_stages, dst_stages, vk::DependencyFlags(), nullptr, nullptr, barrier);
+
+	}
+
+}
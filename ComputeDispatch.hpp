@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <cstdint>
+
+namespace vkUtil {
+
+	// Work in the source stages, writing through the source accesses, finishes before the destination stages
+	// read or write through theirs. Recorded as one global memory barrier
+	struct MemoryDependency {
+
+		vk::PipelineStageFlags src_stages;
+		vk::AccessFlags src_access;
+		vk::PipelineStageFlags dst_stages;
+		vk::AccessFlags dst_access;
+
+	};
+
+	// One dispatch of a pipeline from the pipeline manager. The descriptor set is bound as set 0, the push
+	// constants at offset 0, either is skipped when left empty
+	struct ComputeDispatch {
+
+		vk::Pipeline pipeline;
+		vk::PipelineLayout layout;
+		vk::DescriptorSet descriptor_set;
+		const void* push_constants;
+		uint32_t push_constant_size;
+		uint32_t group_count_x;
+		uint32_t group_count_y;
+		uint32_t group_count_z;
+
+	};
+
+	// An image moving to another queue family, changing layout on the way. The queue giving it up records the
+	// release, the queue taking it over records the same transfer as the acquire after waiting on a semaphore
+	// the release's submission signals
+	struct OwnershipTransfer {
+
+		vk::Image image;
+		vk::ImageSubresourceRange range;
+		vk::ImageLayout old_layout;
+		vk::ImageLayout new_layout;
+		uint32_t src_family;
+		uint32_t dst_family;
+
+	};
+
+	// Workgroups of group_size covering item_count items, the last one partly filled
+	uint32_t groupCount(uint32_t item_count, uint32_t group_size);
+
+	void recordBarrier(vk::CommandBuffer command_buffer, const MemoryDependency& dependency);
+
+	// Binds and dispatches, then records the barrier that lets the results' readers in. A null pipeline, one
+	// still building, only records the barrier, so the readers see whatever the outputs held before
+	void recordDispatch(vk::CommandBuffer command_buffer, const ComputeDispatch& dispatch, const MemoryDependency& results);
+
+	// The stages and accesses of the image's last use on the releasing queue
+	void recordRelease(vk::CommandBuffer command_buffer, const OwnershipTransfer& transfer, vk::PipelineStageFlags src_stages, vk::AccessFlags src_access);
+
+	// The stages and accesses of its first use on the acquiring queue, which the semaphore wait has to block
+	void recordAcquire(vk::CommandBuffer command_buffer, const OwnershipTransfer& transfer, vk::PipelineStageFlags dst_stages, vk::AccessFlags dst_access);
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Shaders/Shaders.h"
+#include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
+#include <iostream>
+#include "GraphicsPipeline.hpp"
+
+namespace vkInit {
+
+	struct ComputePipelineInBundle {
+
+		vk::Device logical_device;
+		vkUtil::ShaderCompiler* shader_compiler;
+		vkUtil::DescriptorSetLayoutCache* layout_cache;
+		vkUtil::PipelineManager* pipeline_manager;
+		vk::PipelineCache pipeline_cache;
+		ComputePipelineState state;
+
+	};
+
+	ComputePipelineOutBundle makeComputePipeline(bool debug, ComputePipelineInBundle specification) {
+
+		vk::ComputePipelineCreateInfo compute_pipeline_info = {};
+
+		compute_pipeline_info.flags = vk::PipelineCreateFlags();
+
+		/// ONLY STAGE: | COMPUTE SHADER |
+
+		vkUtil::ShaderReflection reflection = {};
+		std::vector<uint32_t> compute_code = compileReflected(*specification.shader_compiler, specification.state.compute_file_path, specification.state.permutation,
+															  vk::ShaderStageFlagBits::eCompute, reflection);
+
+		// Failed shaders, or shaders that don't fit the engine's layouts, leave the pipeline null
+		bool shader_valid = !compute_code.empty() &&
+			resolveSetLayouts(specification.state.compute_file_path, *specification.layout_cache, reflection, specification.state.descriptor_set_layouts);
+
+		vk::ShaderModule compute_shader_module = nullptr;
+
+		if (shader_valid) {
+
+			compute_shader_module = vkUtil::createShaderModule(debug, compute_code, specification.state.compute_file_path, specification.logical_device);
+
+		}
+
+		SpecializationData compute_specialization;
+		makeSpecializationInfo(specification.state.permutation, compute_specialization);
+
+		vk::PipelineShaderStageCreateInfo compute_shader_info = {};
+		compute_shader_info.flags = vk::PipelineShaderStageCreateFlags();
+		compute_shader_info.stage = vk::ShaderStageFlagBits::eCompute;
+		compute_shader_info.module = compute_shader_module;
+		compute_shader_info.pName = "main";
+		compute_shader_info.pSpecializationInfo = &compute_specialization.info;
+		compute_pipeline_info.stage = compute_shader_info;
+
+		/// PIPELINE LAYOUT
+
+		vk::PipelineLayout pipeline_layout = nullptr;
+
+		if (shader_valid) {
+
+			pipeline_layout = specification.pipeline_manager->getPipelineLayout(specification.state.descriptor_set_layouts, reflection.push_constants);
+
+		}
+
+		compute_pipeline_info.layout = pipeline_layout;
+
+		compute_pipeline_info.basePipelineHandle = nullptr;
+
+		vk::Pipeline compute_pipeline = nullptr;
+
+		if (pipeline_layout && compute_shader_module) {
+
+			try {
+
+				compute_pipeline = (specification.logical_device.createComputePipeline(specification.pipeline_cache, compute_pipeline_info, vkUtil::hostAllocator())).value;
+
+			}
+			catch (vk::SystemError err) {
+
+				std::cerr << "Failed to create compute pipeline!" << std::endl;
+
+			}
+
+		}
+
+		ComputePipelineOutBundle output = {};
+		output.layout = pipeline_layout;
+		output.pipeline = compute_pipeline;
+
+		specification.logical_device.destroyShaderModule(compute_shader_module, vkUtil::hostAllocator());
+		return output;
+
+	}
+
+}
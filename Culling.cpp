@@ -0,0 +1,125 @@
+#include "Culling.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace vkUtil {
+
+	namespace {
+
+		// -1: box entirely outside the plane, 1: entirely inside, 0: straddles it
+		int classifyBox(const glm::vec4& plane, const glm::vec3& box_min, const glm::vec3& box_max) {
+
+			glm::vec3 normal = glm::vec3(plane);
+			glm::vec3 farthest = glm::vec3(normal.x >= 0.0f ? box_max.x : box_min.x,
+										   normal.y >= 0.0f ? box_max.y : box_min.y,
+										   normal.z >= 0.0f ? box_max.z : box_min.z);
+			glm::vec3 nearest = glm::vec3(normal.x >= 0.0f ? box_min.x : box_max.x,
+										  normal.y >= 0.0f ? box_min.y : box_max.y,
+										  normal.z >= 0.0f ? box_min.z : box_max.z);
+
+			if (glm::dot(normal, farthest) + plane.w < 0.0f) {
+
+				return -1;
+
+			}
+
+			return glm::dot(normal, nearest) + plane.w >= 0.0f ? 1 : 0;
+
+		}
+
+	}
+
+	Frustum extractFrustum(const glm::mat4& view_projection) {
+
+		glm::vec4 row_x = glm::vec4(view_projection[0][0], view_projection[1][0], view_projection[2][0], view_projection[3][0]);
+		glm::vec4 row_y = glm::vec4(view_projection[0][1], view_projection[1][1], view_projection[2][1], view_projection[3][1]);
+		glm::vec4 row_z = glm::vec4(view_projection[0][2], view_projection[1][2], view_projection[2][2], view_projection[3][2]);
+		glm::vec4 row_w = glm::vec4(view_projection[0][3], view_projection[1][3], view_projection[2][3], view_projection[3][3]);
+
+		Frustum frustum;
+		frustum.planes[0] = row_w + row_x;
+		frustum.planes[1] = row_w - row_x;
+		frustum.planes[2] = row_w + row_y;
+		frustum.planes[3] = row_w - row_y;
+		// Vulkan clip space depth is [0, w]
+		frustum.planes[4] = row_z;
+		frustum.planes[5] = row_w - row_z;
+
+		for (glm::vec4& plane : frustum.planes) {
+
+			plane /= glm::length(glm::vec3(plane));
+
+		}
+
+		return frustum;
+
+	}
+
+	bool sphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius) {
+
+		for (const glm::vec4& plane : frustum.planes) {
+
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+
+				return false;
+
+			}
+
+		}
+
+		return true;
+
+	}
+
+	bool boxInFrustum(const Frustum& frustum, const glm::vec3& box_min, const glm::vec3& box_max, uint32_t& plane_mask) {
+
+		for (uint32_t plane = 0; plane < 6; ++plane) {
+
+			if (!(plane_mask & (1u << plane))) {
+
+				continue;
+
+			}
+
+			int side = classifyBox(frustum.planes[plane], box_min, box_max);
+
+			if (side < 0) {
+
+				return false;
+
+			}
+
+			if (side > 0) {
+
+				plane_mask &= ~(1u << plane);
+
+			}
+
+		}
+
+		return true;
+
+	}
+
+	bool boxInFrustum(const Frustum& frustum, const AABB& box) {
+
+		uint32_t plane_mask = 0x3F;
+		return boxInFrustum(frustum, box.min, box.max, plane_mask);
+
+	}
+
+	float intersectRayBox(const glm::vec3& origin, const glm::vec3& inverse_direction, const glm::vec3& box_min, const glm::vec3& box_max) {
+
+		glm::vec3 t0 = (box_min - origin) * inverse_direction;
+		glm::vec3 t1 = (box_max - origin) * inverse_direction;
+		glm::vec3 near_t = glm::min(t0, t1);
+		glm::vec3 far_t = glm::max(t0, t1);
+
+		float entry = std::max(std::max(near_t.x, near_t.y), std::max(near_t.z, 0.0f));
+		float exit = std::min(std::min(far_t.x, far_t.y), far_t.z);
+
+		return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+
+	}
+
+}
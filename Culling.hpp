@@ -0,0 +1,42 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <cstdint>
+
+namespace vkUtil {
+
+	struct AABB {
+
+		glm::vec3 min;
+		glm::vec3 max;
+
+	};
+
+	struct RayHit {
+
+		bool hit;
+		uint32_t object;
+		float distance;
+
+	};
+
+	struct Frustum {
+
+		// Normalized planes (xyz: inward normal, w: distance), order: left, right, bottom, top, near, far
+		glm::vec4 planes[6];
+
+	};
+
+	Frustum extractFrustum(const glm::mat4& view_projection);
+
+	bool sphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius);
+
+	// False when the box is outside. Bits of planes the box lies fully inside are cleared
+	// from plane_mask, so a hierarchy can skip those planes for everything the box contains
+	bool boxInFrustum(const Frustum& frustum, const glm::vec3& box_min, const glm::vec3& box_max, uint32_t& plane_mask);
+	bool boxInFrustum(const Frustum& frustum, const AABB& box);
+
+	// Distance at which the ray enters the box, infinity on a miss
+	float intersectRayBox(const glm::vec3& origin, const glm::vec3& inverse_direction, const glm::vec3& box_min, const glm::vec3& box_max);
+
+}
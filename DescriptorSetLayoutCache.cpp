@@ -0,0 +1,119 @@
+#include "DescriptorSetLayoutCache.hpp"
+#include "Allocator.hpp"
+#include "Hash.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace vkUtil {
+
+	namespace {
+
+		uint64_t hashBindings(const std::vector<vk::DescriptorSetLayoutBinding>& bindings) {
+
+			// The fields that make layouts compatible, immutable samplers aren't used
+			uint64_t hash = hash_seed;
+
+			for (const vk::DescriptorSetLayoutBinding& binding : bindings) {
+
+				hash = hashValue(binding.binding, hash);
+				hash = hashValue(binding.descriptorType, hash);
+				hash = hashValue(binding.descriptorCount, hash);
+				hash = hashValue(static_cast<VkShaderStageFlags>(binding.stageFlags), hash);
+
+			}
+
+			return hash;
+
+		}
+
+	}
+
+	DescriptorSetLayoutCache::DescriptorSetLayoutCache(bool debug, vk::Device logical_device) {
+
+		this->debug = debug;
+		this->logical_device = logical_device;
+
+	}
+
+	DescriptorSetLayoutCache::~DescriptorSetLayoutCache() {
+
+		for (const Entry& entry : entries) {
+
+			logical_device.destroyDescriptorSetLayout(entry.layout, hostAllocator());
+
+		}
+
+	}
+
+	vk::DescriptorSetLayout DescriptorSetLayoutCache::get(std::vector<vk::DescriptorSetLayoutBinding> bindings) {
+
+		std::sort(bindings.begin(), bindings.end(), [](const vk::DescriptorSetLayoutBinding& a, const vk::DescriptorSetLayoutBinding& b) {
+
+			return a.binding < b.binding;
+
+		});
+
+		uint64_t hash = hashBindings(bindings);
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (const Entry& entry : entries) {
+
+			if (entry.hash == hash && entry.bindings == bindings) {
+
+				return entry.layout;
+
+			}
+
+		}
+
+		vk::DescriptorSetLayoutCreateInfo layout_info = {};
+		layout_info.flags = vk::DescriptorSetLayoutCreateFlags();
+		layout_info.bindingCount = static_cast<uint32_t>(bindings.size());
+		layout_info.pBindings = bindings.data();
+
+		try {
+
+			Entry entry = {};
+			entry.hash = hash;
+			entry.layout = logical_device.createDescriptorSetLayout(layout_info, hostAllocator());
+			entry.bindings = std::move(bindings);
+			entries.push_back(entry);
+
+			return entry.layout;
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to create descriptor set layout" << std::endl;
+
+			}
+
+			return nullptr;
+
+		}
+
+	}
+
+	bool DescriptorSetLayoutCache::getBindings(vk::DescriptorSetLayout layout, std::vector<vk::DescriptorSetLayoutBinding>& bindings) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (const Entry& entry : entries) {
+
+			if (entry.layout == layout) {
+
+				bindings = entry.bindings;
+				return true;
+
+			}
+
+		}
+
+		return false;
+
+	}
+
+}
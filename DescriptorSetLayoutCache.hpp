@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+namespace vkUtil {
+
+	// Owns every descriptor set layout, one per distinct set of bindings. Layouts live until the cache is
+	// destroyed, so pipelines and descriptor sets never need to destroy theirs. Safe to use from several threads
+	class DescriptorSetLayoutCache {
+
+	public:
+
+		DescriptorSetLayoutCache(bool debug, vk::Device logical_device);
+		~DescriptorSetLayoutCache();
+
+		DescriptorSetLayoutCache(const DescriptorSetLayoutCache&) = delete;
+		DescriptorSetLayoutCache& operator=(const DescriptorSetLayoutCache&) = delete;
+
+		// Binding order doesn't matter. Null if the layout can't be created
+		vk::DescriptorSetLayout get(std::vector<vk::DescriptorSetLayoutBinding> bindings);
+
+		// The bindings a layout from get was made with, sorted by binding number. False for other layouts
+		bool getBindings(vk::DescriptorSetLayout layout, std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+	private:
+
+		struct Entry {
+
+			uint64_t hash;
+			std::vector<vk::DescriptorSetLayoutBinding> bindings;
+			vk::DescriptorSetLayout layout;
+
+		};
+
+		bool debug;
+		vk::Device logical_device;
+		std::mutex mutex;
+		std::vector<Entry> entries;
+
+	};
+
+}
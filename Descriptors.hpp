@@ -0,0 +1,170 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
+#include "DescriptorSetLayoutCache.hpp"
+#include <iostream>
+#include <vector>
+
+namespace vkInit {
+
+	struct DescriptorSetLayoutData {
+
+		uint32_t count;
+		std::vector<uint32_t> indices;
+		std::vector<vk::DescriptorType> types;
+		std::vector<uint32_t> counts;
+		std::vector<vk::ShaderStageFlags> stages;
+
+	};
+
+	// Layouts come from the cache, which owns them
+	vk::DescriptorSetLayout makeDescriptorSetLayout(vkUtil::DescriptorSetLayoutCache& layout_cache, const DescriptorSetLayoutData& bindings) {
+
+		std::vector<vk::DescriptorSetLayoutBinding> layout_bindings;
+		layout_bindings.reserve(bindings.count);
+
+		for (uint32_t i = 0; i < bindings.count; ++i) {
+
+			vk::DescriptorSetLayoutBinding layout_binding = {};
+			layout_binding.binding = bindings.indices[i];
+			layout_binding.descriptorType = bindings.types[i];
+			layout_binding.descriptorCount = bindings.counts[i];
+			layout_binding.stageFlags = bindings.stages[i];
+			layout_bindings.push_back(layout_binding);
+
+		}
+
+		return layout_cache.get(layout_bindings);
+
+	}
+
+	vk::DescriptorPool makeDescriptorPool(const bool& debug, vk::Device logical_device, uint32_t size, const DescriptorSetLayoutData& bindings) {
+
+		std::vector<vk::DescriptorPoolSize> pool_sizes;
+
+		for (uint32_t i = 0; i < bindings.count; ++i) {
+
+			vk::DescriptorPoolSize pool_size = {};
+			pool_size.type = bindings.types[i];
+			pool_size.descriptorCount = bindings.counts[i] * size;
+			pool_sizes.push_back(pool_size);
+
+		}
+
+		vk::DescriptorPoolCreateInfo pool_info = {};
+		pool_info.flags = vk::DescriptorPoolCreateFlags();
+		pool_info.maxSets = size;
+		pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+		pool_info.pPoolSizes = pool_sizes.data();
+
+		try {
+
+			return logical_device.createDescriptorPool(pool_info, vkUtil::hostAllocator());
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to create descriptor pool" << std::endl;
+
+			}
+
+			return nullptr;
+
+		}
+
+	}
+
+	vk::DescriptorSet allocateDescriptorSet(const bool& debug, vk::Device logical_device, vk::DescriptorPool descriptor_pool, vk::DescriptorSetLayout layout) {
+
+		vk::DescriptorSetAllocateInfo allocate_info = {};
+		allocate_info.descriptorPool = descriptor_pool;
+		allocate_info.descriptorSetCount = 1;
+		allocate_info.pSetLayouts = &layout;
+
+		try {
+
+			return logical_device.allocateDescriptorSets(allocate_info)[0];
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to allocate descriptor set" << std::endl;
+
+			}
+
+			return nullptr;
+
+		}
+
+	}
+
+	void writeStorageBufferDescriptors(vk::Device logical_device, vk::DescriptorSet descriptor_set, const std::vector<vk::Buffer>& buffers) {
+
+		std::vector<vk::DescriptorBufferInfo> buffer_infos(buffers.size());
+		std::vector<vk::WriteDescriptorSet> writes(buffers.size());
+
+		for (uint32_t i = 0; i < buffers.size(); ++i) {
+
+			buffer_infos[i].buffer = buffers[i];
+			buffer_infos[i].offset = 0;
+			buffer_infos[i].range = VK_WHOLE_SIZE;
+
+			writes[i].dstSet = descriptor_set;
+			writes[i].dstBinding = i;
+			writes[i].dstArrayElement = 0;
+			writes[i].descriptorType = vk::DescriptorType::eStorageBuffer;
+			writes[i].descriptorCount = 1;
+			writes[i].pBufferInfo = &buffer_infos[i];
+
+		}
+
+		logical_device.updateDescriptorSets(writes, nullptr);
+
+	}
+
+	void writeBufferDescriptor(vk::Device logical_device, vk::DescriptorSet descriptor_set, uint32_t binding, vk::DescriptorType type,
+							   vk::Buffer buffer, vk::DeviceSize offset, vk::DeviceSize range) {
+
+		vk::DescriptorBufferInfo buffer_info = {};
+		buffer_info.buffer = buffer;
+		buffer_info.offset = offset;
+		buffer_info.range = range;
+
+		vk::WriteDescriptorSet write = {};
+		write.dstSet = descriptor_set;
+		write.dstBinding = binding;
+		write.dstArrayElement = 0;
+		write.descriptorType = type;
+		write.descriptorCount = 1;
+		write.pBufferInfo = &buffer_info;
+
+		logical_device.updateDescriptorSets(write, nullptr);
+
+	}
+
+	void writeImageDescriptor(vk::Device logical_device, vk::DescriptorSet descriptor_set, uint32_t binding, vk::DescriptorType type,
+							  vk::Sampler sampler, vk::ImageView image_view, vk::ImageLayout layout) {
+
+		vk::DescriptorImageInfo image_info = {};
+		image_info.sampler = sampler;
+		image_info.imageView = image_view;
+		image_info.imageLayout = layout;
+
+		vk::WriteDescriptorSet write = {};
+		write.dstSet = descriptor_set;
+		write.dstBinding = binding;
+		write.dstArrayElement = 0;
+		write.descriptorType = type;
+		write.descriptorCount = 1;
+		write.pImageInfo = &image_info;
+
+		logical_device.updateDescriptorSets(write, nullptr);
+
+	}
+
+}
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 #include <iostream>
 #include <set>
+#include <algorithm>
 #include <optional>
 #include "QueueFamilies.hpp"
 
@@ -122,15 +124,54 @@ namespace vkInit {
 
 
 
-	vk::Device createLogicalDevice(const bool& debug, vk::PhysicalDevice& physical_device, vk::SurfaceKHR surface) {
+	// VK_EXT_graphics_pipeline_library with fast linking, otherwise linking libraries would gain nothing over whole
+	// pipelines. Its feature is queried through Vulkan 1.1
+	bool supportsPipelineLibraries(const bool& debug, vk::PhysicalDevice physical_device) {
+
+		if (physical_device.getProperties().apiVersion < VK_MAKE_API_VERSION(0, 1, 1, 0) ||
+			!checkDeviceExtensionSupport(false, physical_device, { VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME })) {
+
+			return false;
+
+		}
+
+		auto features = physical_device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+		auto properties = physical_device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT>();
+
+		bool supported = features.get<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>().graphicsPipelineLibrary &&
+			properties.get<vk::PhysicalDeviceGraphicsPipelineLibraryPropertiesEXT>().graphicsPipelineLibraryFastLinking;
+
+		if (debug) {
+
+			std::cout << "Device " << (supported ? "can" : "can NOT") << " fast-link graphics pipeline libraries\n";
+
+		}
+
+		return supported;
+
+	}
+
+	vk::Device createLogicalDevice(const bool& debug, vk::PhysicalDevice& physical_device, vk::SurfaceKHR surface, bool pipeline_libraries) {
 
 		vkUtil::QueueFamilyIndices indices = vkUtil::findQueueFamilies(debug, physical_device, surface);
+		std::vector<uint32_t> families = { indices.graphics_family.value(), indices.present_family.value() };
+
+		if (indices.compute_family.has_value()) {
+
+			families.push_back(indices.compute_family.value());
+
+		}
+
+		// A family may only be requested once, and the compute-only family can also be the one that presents
 		std::vector<uint32_t> unique_indices;
-		unique_indices.push_back(indices.graphics_family.value());
 
-		if (indices.graphics_family.value() != indices.present_family.value()) {
+		for (uint32_t family : families) {
+
+			if (std::find(unique_indices.begin(), unique_indices.end(), family) == unique_indices.end()) {
 
-			unique_indices.push_back(indices.present_family.value());
+				unique_indices.push_back(family);
+
+			}
 
 		}
 
@@ -152,6 +193,16 @@ namespace vkInit {
 		std::vector<const char*> device_extension = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
 
 		vk::PhysicalDeviceFeatures physical_device_features = vk::PhysicalDeviceFeatures();
+
+		vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT library_features = {};
+		library_features.graphicsPipelineLibrary = VK_TRUE;
+
+		if (pipeline_libraries) {
+
+			device_extension.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+			device_extension.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+
+		}
 		
 
 		std::vector<const char*> enabled_layers;
@@ -171,9 +222,15 @@ namespace vkInit {
 		
 		);
 
+		if (pipeline_libraries) {
+
+			device_info.pNext = &library_features;
+
+		}
+
 		try {
 
-			vk::Device device = physical_device.createDevice(device_info);
+			vk::Device device = physical_device.createDevice(device_info, vkUtil::hostAllocator());
 			if (debug) {
 
 				std::cout << "GPU has been succesfully abstracted!\n";
@@ -194,15 +251,17 @@ namespace vkInit {
 
 	}
 
-	std::array<vk::Queue, 2> getQueue(const bool& debug, vk::PhysicalDevice physical_device, vk::Device device, vk::SurfaceKHR surface) {
+	// Graphics, present and compute. Without an async compute family the compute queue is the graphics queue
+	std::array<vk::Queue, 3> getQueue(const bool& debug, vk::PhysicalDevice physical_device, vk::Device device, vk::SurfaceKHR surface) {
 		 
 		vkUtil::QueueFamilyIndices indices = vkUtil::findQueueFamilies(debug, physical_device, surface);
-		
+		uint32_t compute_family = indices.compute_family.value_or(indices.graphics_family.value());
 
 		return { {
 				
 				device.getQueue(indices.graphics_family.value(), 0),
-				device.getQueue(indices.present_family.value(), 0)
+				device.getQueue(indices.present_family.value(), 0),
+				device.getQueue(compute_family, 0)
 			
 			   } };
 	}
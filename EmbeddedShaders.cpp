@@ -0,0 +1,41 @@
+#include "EmbeddedShaders.hpp"
+
+namespace vkUtil {
+
+	// Written by the pre-build step. A build without it embeds nothing and reads every shader from disk
+#if __has_include("Shaders/EmbeddedShaderData.inl")
+#include "Shaders/EmbeddedShaderData.inl"
+#else
+	const EmbeddedShader embedded_shaders[] = {
+
+		{ nullptr, nullptr, nullptr, nullptr, 0, false, false }
+
+	};
+#endif
+
+	const EmbeddedShader* findEmbeddedShader(const std::string& file_name, const std::vector<ShaderDefine>& defines, bool optimized, bool debug_info) {
+
+		std::string define_text;
+
+		for (const ShaderDefine& define : defines) {
+
+			define_text += (define_text.empty() ? "" : ";") + define.name + "=" + define.value;
+
+		}
+
+		for (const EmbeddedShader* shader = embedded_shaders; shader->file_name; ++shader) {
+
+			if (file_name == shader->file_name && define_text == shader->defines && shader->optimized == optimized &&
+				shader->debug_info == debug_info) {
+
+				return shader;
+
+			}
+
+		}
+
+		return nullptr;
+
+	}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "ShaderCompiler.hpp"
+
+namespace vkUtil {
+
+	// SPIR-V compiled into the executable by the pre-build step, Shaders/embed_shaders.py. The code arrays are
+	// uint32_t, so unlike bytes read into a char buffer they are always aligned for the words they hold
+	struct EmbeddedShader {
+
+		// As passed to ShaderCompiler::compile, defines written "NAME=VALUE" and separated by ';'
+		const char* file_name;
+		const char* defines;
+		// Files the module was compiled from, relative to the shader directory, null terminated
+		const char* const* sources;
+		const uint32_t* code;
+		size_t word_count;
+		bool optimized;
+		bool debug_info;
+
+	};
+
+	// Null if the module wasn't embedded with these defines and settings
+	const EmbeddedShader* findEmbeddedShader(const std::string& file_name, const std::vector<ShaderDefine>& defines, bool optimized, bool debug_info);
+
+}
@@ -3,165 +3,1980 @@
 #include "Logging.hpp"
 #include "Device.hpp"
 #include "Swapchain.hpp"
-#include "GraphicsPipeline.hpp"
 #include "FrameBuffer.hpp"
 #include "Commands.hpp"
 #include "Synchronization.hpp"
+#include "Memory.hpp"
+#include "Image.hpp"
+#include "Descriptors.hpp"
+#include "VertexFormats.hpp"
+#include "Culling.hpp"
+#include "Queries.hpp"
+#include <algorithm>
+#include <chrono>
 
 
-Engine::Engine(const bool& debug, int width, int height, GLFWwindow* window) {
+Engine::Engine(const bool& debug, int width, int height, GLFWwindow* window, const EngineSettings& settings, jobs::JobSystem* job_system) {
 
 	this->width = width;
 	this->height = height;
 	this->window = window;
+	swapchain_outdated = false;
 	this->debug_mode = debug;
+	this->settings = settings;
+	this->job_system = job_system;
+
+	// The early occlusion pass already lays down depth for the late one, a pre-pass would repeat it
+	if (settings.occlusion_culling) {
+
+		this->settings.depth_prepass = false;
+
+	}
 
 	makeInstance();
 
 	makeDebugMessenger();
 
-	makeDevice();
+	makeDevice();
+
+	// GLSL is compiled on first use, later runs load the SPIR-V cached beside the sources. Modules embedded
+	// into the executable skip both
+	shader_compiler = new vkUtil::ShaderCompiler(debug, "Shaders", "Shaders/cache", true, settings.embedded_shaders);
+	layout_cache = new vkUtil::DescriptorSetLayoutCache(debug, device);
+	pipeline_manager = new vkUtil::PipelineManager(debug, device, shader_compiler, layout_cache, job_system,
+												   settings.pipeline_libraries && pipeline_libraries_supported);
+
+	makeTransformResources();
+
+	if (settings.occlusion_culling) {
+
+		makeOcclusionResources();
+
+	}
+
+	makePipeline();
+
+	if (settings.meshlet_culling) {
+
+		makeMeshletResources();
+
+	}
+
+	finalizeSetup();
+
+	// Everything requested above has been building on the workers meanwhile, the first frame waits for none of it
+	pipeline_manager->waitForBuilds();
+	resolvePendingPipelines();
+
+	shader_watcher = nullptr;
+
+	if (settings.shader_hot_reload) {
+
+		shader_watcher = new vkUtil::FileWatcher(shader_compiler->getShaderDirectory(), [this](const std::vector<std::string>& changed_files) {
+
+			reloadShaders(changed_files);
+
+		});
+
+	}
+
+}
+
+
+Engine::~Engine() {
+
+	// Stopped first, a rebuild on its thread still uses the device
+	delete shader_watcher;
+
+	device.waitIdle();
+
+	destroyRetiredPipelines(true);
+
+	device.destroyCommandPool(command_pool, vkUtil::hostAllocator());
+	device.destroyCommandPool(compute_command_pool, vkUtil::hostAllocator());
+
+	if (settings.meshlet_culling) {
+
+		destroyMeshletResources();
+
+	}
+
+	destroyPipelines();
+
+	if (settings.occlusion_culling) {
+
+		destroyOcclusionResources();
+
+	}
+
+	cleanupSwapchain();
+
+	delete pipeline_manager;
+	delete shader_compiler;
+	delete layout_cache;
+
+	device.destroy(vkUtil::hostAllocator());
+
+	instance.destroySurfaceKHR(surface, vkUtil::hostAllocator());
+
+	instance.destroyDebugUtilsMessengerEXT(debug_messenger, vkUtil::hostAllocator(), dispatch_loader);
+
+	instance.destroy(vkUtil::hostAllocator());
+
+	glfwTerminate();
+
+}
+
+
+
+void Engine::makeInstance() {
+
+	instance = vkInit::makeInstance(debug_mode, "Cyan Crate: A Vulkan Engine");
+	dispatch_loader = vk::DispatchLoaderDynamic(instance, vkGetInstanceProcAddr);
+
+
+	VkSurfaceKHR c_style_surface;
+	
+	if (glfwCreateWindowSurface(instance, window, reinterpret_cast<const VkAllocationCallbacks*>(vkUtil::hostAllocator()), &c_style_surface) != VK_SUCCESS) {
+
+		if (debug_mode) {
+
+			std::cout << "Failed to abstract the glfw surface for Vulkan!\n";
+
+		}
+
+		return;
+
+	}
+
+	if (debug_mode) {
+
+		std::cout << "Succeded to abstract the glfw surface for Vulkan!\n";
+
+	}
+
+	surface = c_style_surface;
+
+}
+
+void Engine::makeDebugMessenger() {
+
+	debug_messenger = vkInit::makeDebugMessenger(instance, dispatch_loader);
+
+}
+
+void Engine::makeDevice()
+{
+
+	physical_device = vkInit::choosePhysicalDevice(debug_mode, instance);
+	// Enabled whenever supported, the setting only decides whether the engine's own pipelines use it
+	pipeline_libraries_supported = vkInit::supportsPipelineLibraries(debug_mode, physical_device);
+	device = vkInit::createLogicalDevice(debug_mode, physical_device, surface, pipeline_libraries_supported);
+	std::array<vk::Queue, 3>queue = vkInit::getQueue(debug_mode, physical_device, device, surface);
+	graphics_queue = queue[0];
+	present_queue = queue[1];
+	compute_queue = queue[2];
+
+	vkUtil::QueueFamilyIndices indices = vkUtil::findQueueFamilies(debug_mode, physical_device, surface);
+	graphics_family = indices.graphics_family.value();
+	compute_family = indices.compute_family.value_or(graphics_family);
+	// The depth pyramid is the only work that moves, without occlusion culling there is nothing to overlap
+	async_compute = settings.async_compute && settings.occlusion_culling && indices.compute_family.has_value();
+
+	if (debug_mode && async_compute) {
+
+		std::cout << "Reducing the depth pyramid on queue family " << compute_family << "\n";
+
+	}
+
+	depth_format = vkUtil::findSupportedFormat(
+		physical_device,
+		{ vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint },
+		vk::ImageTiling::eOptimal,
+		vk::FormatFeatureFlagBits::eDepthStencilAttachment | vk::FormatFeatureFlagBits::eSampledImage
+	);
+
+	// vkInit::querySwapChainSupport(debug_mode, physical_device, surface); 
+	makeSwapchain();
+	frame_number = 0;
+
+}
+
+void Engine::makePipeline() {
+
+	vkInit::GraphicsPipelineState state = {};
+
+	state.vertex_file_path = "shader.vert";
+	state.fragment_file_path = "shader.frag";
+	state.swapchain_image_format = swapchain_format;
+	state.swapchain_extent = swapchain_extent;
+	state.depth_format = depth_format;
+	state.cull_mode = vk::CullModeFlagBits::eBack;
+	state.blend = false;
+	state.depth_test = true;
+	state.depth_prepass = settings.depth_prepass;
+
+	// With a pre-pass the shading subpass only accepts the exact depth the pre-pass wrote
+	state.depth_write = !settings.depth_prepass;
+	state.depth_compare_op = settings.depth_prepass ? vk::CompareOp::eEqual : vk::CompareOp::eLess;
+	state.subpass = settings.depth_prepass ? 1 : 0;
+
+	// Occlusion culling splits the frame around the depth pyramid build
+	state.render_pass_stage = settings.occlusion_culling ? vkInit::RenderPassStage::eFirst : vkInit::RenderPassStage::eOnly;
+
+	// Scene draws read their world matrix from the frame's transform buffer
+	state.descriptor_set_layouts = { transform_set_layout };
+
+	// Framebuffers are made for the render pass right away, whether or not the pipelines are built yet
+	graphics_pipeline_render_pass = pipeline_manager->getRenderPass(swapchain_format, depth_format, settings.depth_prepass, state.render_pass_stage);
+	requestPipeline(&graphics_pipeline, &graphics_pipeline_layout, state);
+
+	if (settings.meshlet_culling) {
+
+		state.vertex_file_path = "meshlet.vert";
+		state.vertex_bindings = vkMesh::getVertexBindingDescriptions();
+		state.descriptor_set_layouts.clear();
+
+		requestPipeline(&meshlet_pipeline, &meshlet_pipeline_layout, state);
+
+	}
+
+	if (settings.occlusion_culling) {
+
+		// Objects come from the culling pass's visible list instead of per-draw push constants
+		state.vertex_file_path = "shader_occlusion.vert";
+		state.vertex_bindings.clear();
+		state.descriptor_set_layouts = { occlusion_draw_set_layout };
+
+		requestPipeline(&occlusion_pipeline, &occlusion_pipeline_layout, state);
+
+		occlusion_late_render_pass = pipeline_manager->getRenderPass(swapchain_format, depth_format, false, vkInit::RenderPassStage::eLast);
+
+	}
+
+	if (!settings.depth_prepass) {
+
+		return;
+
+	}
+
+	state.fragment_file_path = "";
+	state.depth_write = true;
+	state.depth_compare_op = vk::CompareOp::eLess;
+	state.subpass = 0;
+
+	// The shading vertex shader with its color output compiled out
+	state.vertex_file_path = "shader.vert";
+	state.vertex_permutation.define("DEPTH_ONLY");
+	state.vertex_bindings.clear();
+	state.descriptor_set_layouts = { transform_set_layout };
+
+	requestPipeline(&depth_prepass_pipeline, &depth_prepass_pipeline_layout, state);
+
+	if (settings.meshlet_culling) {
+
+		// Position-only stream: same binding stride, the depth-only variant has no normal input
+		state.vertex_file_path = "meshlet.vert";
+		state.vertex_bindings = vkMesh::getVertexBindingDescriptions();
+		state.descriptor_set_layouts.clear();
+
+		requestPipeline(&meshlet_depth_prepass_pipeline, &meshlet_depth_prepass_pipeline_layout, state);
+
+	}
+
+}
+
+void Engine::destroyPipelines() {
+
+	// The pipeline manager keeps the pipelines themselves, for the next makePipeline with the same settings
+	forgetHotPipelines({ &graphics_pipeline, &depth_prepass_pipeline, &meshlet_pipeline, &meshlet_depth_prepass_pipeline, &occlusion_pipeline });
+
+}
+
+void Engine::requestPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::GraphicsPipelineState& state) {
+
+	vkInit::GraphicsPipelineOutBundle output = pipeline_manager->requestGraphicsPipeline(state);
+	*pipeline = output.pipeline;
+	*layout = output.layout;
+	registerHotPipeline(pipeline, layout, state);
+
+	if (*pipeline) {
+
+		return;
+
+	}
+
+	PendingPipeline pending;
+	pending.pipeline = pipeline;
+	pending.layout = layout;
+
+	vkUtil::PipelineManager* manager = pipeline_manager;
+	pending.resolve = [manager, state](vk::Pipeline& pipeline, vk::PipelineLayout& layout) {
+
+		vkInit::GraphicsPipelineOutBundle output = manager->requestGraphicsPipeline(state);
+		pipeline = output.pipeline;
+		layout = output.layout;
+
+		return static_cast<bool>(pipeline);
+
+	};
+
+	pending_pipelines.push_back(pending);
+
+}
+
+void Engine::requestPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::ComputePipelineState& state) {
+
+	vkInit::ComputePipelineOutBundle output = pipeline_manager->requestComputePipeline(state);
+	*pipeline = output.pipeline;
+	*layout = output.layout;
+	registerHotPipeline(pipeline, layout, state);
+
+	if (*pipeline) {
+
+		return;
+
+	}
+
+	PendingPipeline pending;
+	pending.pipeline = pipeline;
+	pending.layout = layout;
+
+	vkUtil::PipelineManager* manager = pipeline_manager;
+	pending.resolve = [manager, state](vk::Pipeline& pipeline, vk::PipelineLayout& layout) {
+
+		vkInit::ComputePipelineOutBundle output = manager->requestComputePipeline(state);
+		pipeline = output.pipeline;
+		layout = output.layout;
+
+		return static_cast<bool>(pipeline);
+
+	};
+
+	pending_pipelines.push_back(pending);
+
+}
+
+void Engine::resolvePendingPipelines() {
+
+	for (size_t i = 0; i < pending_pipelines.size();) {
+
+		PendingPipeline& pending = pending_pipelines[i];
+
+		// A hot reload may have filled the pipeline in first, a failed build stays pending until one does
+		if (*pending.pipeline || pending.resolve(*pending.pipeline, *pending.layout)) {
+
+			pending_pipelines[i] = pending_pipelines.back();
+			pending_pipelines.pop_back();
+
+		}
+		else {
+
+			++i;
+
+		}
+
+	}
+
+}
+
+void Engine::registerHotPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::GraphicsPipelineState& state) {
+
+	if (!settings.shader_hot_reload) {
+
+		return;
+
+	}
+
+	HotPipeline hot_pipeline;
+	hot_pipeline.pipeline = pipeline;
+	hot_pipeline.layout = layout;
+	hot_pipeline.shaders = { state.vertex_file_path };
+
+	if (!state.fragment_file_path.empty()) {
+
+		hot_pipeline.shaders.push_back(state.fragment_file_path);
+
+	}
+
+	// The render pass comes from the manager's cache, a rebuild never makes a new one
+	vkUtil::PipelineManager* manager = pipeline_manager;
+	hot_pipeline.rebuild = [manager, state](vk::Pipeline& pipeline, vk::PipelineLayout& layout) {
+
+		vkInit::GraphicsPipelineOutBundle output = manager->rebuildGraphicsPipeline(state);
+		pipeline = output.pipeline;
+		layout = output.layout;
+
+		return static_cast<bool>(pipeline);
+
+	};
+
+	std::lock_guard<std::mutex> lock(hot_reload_mutex);
+	hot_pipelines.push_back(hot_pipeline);
+
+}
+
+void Engine::registerHotPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::ComputePipelineState& state) {
+
+	if (!settings.shader_hot_reload) {
+
+		return;
+
+	}
+
+	HotPipeline hot_pipeline;
+	hot_pipeline.pipeline = pipeline;
+	hot_pipeline.layout = layout;
+	hot_pipeline.shaders = { state.compute_file_path };
+
+	vkUtil::PipelineManager* manager = pipeline_manager;
+	hot_pipeline.rebuild = [manager, state](vk::Pipeline& pipeline, vk::PipelineLayout& layout) {
+
+		vkInit::ComputePipelineOutBundle output = manager->rebuildComputePipeline(state);
+		pipeline = output.pipeline;
+		layout = output.layout;
+
+		return static_cast<bool>(pipeline);
+
+	};
+
+	std::lock_guard<std::mutex> lock(hot_reload_mutex);
+	hot_pipelines.push_back(hot_pipeline);
+
+}
+
+void Engine::forgetHotPipelines(std::initializer_list<vk::Pipeline*> pipelines) {
+
+	std::lock_guard<std::mutex> rebuild_lock(rebuild_mutex);
+	std::lock_guard<std::mutex> lock(hot_reload_mutex);
+
+	for (vk::Pipeline* pipeline : pipelines) {
+
+		pending_pipelines.erase(std::remove_if(pending_pipelines.begin(), pending_pipelines.end(),
+			[pipeline](const PendingPipeline& pending) { return pending.pipeline == pipeline; }), pending_pipelines.end());
+
+		hot_pipelines.erase(std::remove_if(hot_pipelines.begin(), hot_pipelines.end(),
+			[pipeline](const HotPipeline& hot_pipeline) { return hot_pipeline.pipeline == pipeline; }), hot_pipelines.end());
+
+		// Rebuilt but never swapped in, so never used
+		for (size_t i = 0; i < reloaded_pipelines.size();) {
+
+			if (reloaded_pipelines[i].target == pipeline) {
+
+				pipeline_manager->discardPipeline(reloaded_pipelines[i].pipeline);
+				reloaded_pipelines.erase(reloaded_pipelines.begin() + i);
+
+			}
+			else {
+
+				++i;
+
+			}
+
+		}
+
+	}
+
+}
+
+void Engine::reloadShaders(const std::vector<std::string>& changed_files) {
+
+	std::lock_guard<std::mutex> rebuild_lock(rebuild_mutex);
+	// Rebuilds compile the edited GLSL rather than what the executable embeds
+	shader_compiler->markChanged(changed_files);
+	std::vector<HotPipeline> affected;
+
+	{
+
+		std::lock_guard<std::mutex> lock(hot_reload_mutex);
+
+		for (const HotPipeline& hot_pipeline : hot_pipelines) {
+
+			bool reads_changed_file = false;
+
+			for (const std::string& shader : hot_pipeline.shaders) {
+
+				for (const std::string& file : changed_files) {
+
+					reads_changed_file |= shader_compiler->readsFile(shader, file);
+
+				}
+
+			}
+
+			if (reads_changed_file) {
+
+				affected.push_back(hot_pipeline);
+
+			}
+
+		}
+
+	}
+
+	// Compiling happens here without any lock the render loop takes, it keeps drawing with the old pipelines
+	for (HotPipeline& hot_pipeline : affected) {
+
+		ReloadedPipeline reloaded = {};
+		reloaded.target = hot_pipeline.pipeline;
+		reloaded.target_layout = hot_pipeline.layout;
+
+		if (!hot_pipeline.rebuild(reloaded.pipeline, reloaded.layout)) {
+
+			if (debug_mode) {
+
+				std::cout << "Keeping the previous pipeline for \"" << hot_pipeline.shaders[0] << "\"" << std::endl;
+
+			}
+
+			continue;
+
+		}
+
+		if (debug_mode) {
+
+			std::cout << "Reloaded the pipeline for \"" << hot_pipeline.shaders[0] << "\"" << std::endl;
+
+		}
+
+		std::lock_guard<std::mutex> lock(hot_reload_mutex);
+		reloaded_pipelines.push_back(reloaded);
+
+	}
+
+}
+
+void Engine::swapReloadedPipelines() {
+
+	// The watcher's thread only holds the lock briefly, but the frame still doesn't wait for it
+	std::unique_lock<std::mutex> lock(hot_reload_mutex, std::try_to_lock);
+
+	if (!lock.owns_lock()) {
+
+		return;
+
+	}
+
+	for (const ReloadedPipeline& reloaded : reloaded_pipelines) {
+
+		// What the cache held, which may be newer than the target if an optimized build just finished
+		vk::Pipeline replaced = pipeline_manager->replacePipeline(reloaded.pipeline);
+
+		if (replaced) {
+
+			retired_pipelines.push_back({ replaced, max_frames_in_flight });
+
+		}
+
+		*reloaded.target = reloaded.pipeline;
+		*reloaded.target_layout = reloaded.layout;
+
+	}
+
+	reloaded_pipelines.clear();
+
+}
+
+void Engine::upgradeLinkedPipelines() {
+
+	vkUtil::PipelineUpgrade upgrade;
+
+	while (pipeline_manager->takeUpgrade(upgrade)) {
+
+		// Same state, so the layout stays. A linked pipeline no field uses any more is only retired
+		for (vk::Pipeline* pipeline : { &graphics_pipeline, &depth_prepass_pipeline, &meshlet_pipeline, &meshlet_depth_prepass_pipeline, &occlusion_pipeline }) {
+
+			if (*pipeline == upgrade.linked) {
+
+				*pipeline = upgrade.optimized;
+
+			}
+
+		}
+
+		retired_pipelines.push_back({ upgrade.linked, max_frames_in_flight });
+
+	}
+
+}
+
+void Engine::destroyRetiredPipelines(bool all) {
+
+	// Each frame boundary waited on one more frame in flight, after all of them none can use the pipeline
+	for (size_t i = 0; i < retired_pipelines.size();) {
+
+		if (all || --retired_pipelines[i].frames_left <= 0) {
+
+			device.destroyPipeline(retired_pipelines[i].pipeline, vkUtil::hostAllocator());
+			retired_pipelines[i] = retired_pipelines.back();
+			retired_pipelines.pop_back();
+
+		}
+		else {
+
+			++i;
+
+		}
+
+	}
+
+}
+
+void Engine::setDepthPrepass(bool enabled) {
+
+	if (settings.depth_prepass == enabled || settings.occlusion_culling) {
+
+		return;
+
+	}
+
+	device.waitIdle();
+
+	for (vkUtil::SwapChainFrame& frame : swapchain_frames) {
+
+		device.destroyFramebuffer(frame.framebuffer, vkUtil::hostAllocator());
+
+	}
+
+	destroyPipelines();
+	settings.depth_prepass = enabled;
+	makePipeline();
+	makeFramebuffers();
+
+}
+
+void Engine::setDrawBatching(bool enabled) {
+
+	settings.batch_draws = enabled;
+
+}
+
+vkUtil::FrameStatistics Engine::getStatistics() {
+
+	return statistics;
+
+}
+
+vkUtil::PipelineCacheStatistics Engine::getPipelineCacheStatistics() {
+
+	return pipeline_manager->getStatistics();
+
+}
+
+std::vector<vkInit::GraphicsPipelineState> Engine::makePipelineVariants() {
+
+	const vk::CullModeFlags cull_modes[] = { vk::CullModeFlagBits::eNone, vk::CullModeFlagBits::eFront, vk::CullModeFlagBits::eBack };
+	const vk::CompareOp compare_ops[] = { vk::CompareOp::eLess, vk::CompareOp::eLessOrEqual, vk::CompareOp::eGreater,
+										  vk::CompareOp::eGreaterOrEqual, vk::CompareOp::eAlways };
+
+	vkInit::GraphicsPipelineState state = {};
+	state.swapchain_image_format = swapchain_format;
+	state.swapchain_extent = swapchain_extent;
+	state.depth_format = depth_format;
+	state.depth_test = true;
+	state.render_pass_stage = vkInit::RenderPassStage::eOnly;
+	state.subpass = 0;
+	state.descriptor_set_layouts = { transform_set_layout };
+
+	// Shaded and depth-only, each under every combination of fixed function state: 120 variants
+	std::vector<vkInit::GraphicsPipelineState> states;
+
+	for (int shaded = 0; shaded < 2; ++shaded) {
+
+		state.vertex_file_path = "shader.vert";
+		state.vertex_permutation = shaded ? vkUtil::ShaderPermutation() : vkUtil::ShaderPermutation().define("DEPTH_ONLY");
+		state.fragment_file_path = shaded ? "shader.frag" : "";
+		// Depth-only variants go in the pre-pass subpass, the one without a color attachment to blend into
+		state.depth_prepass = !shaded;
+
+		for (vk::CullModeFlags cull_mode : cull_modes) {
+
+			for (vk::CompareOp compare_op : compare_ops) {
+
+				for (int flags = 0; flags < 4; ++flags) {
+
+					state.cull_mode = cull_mode;
+					state.depth_compare_op = compare_op;
+					state.blend = (flags & 1) != 0;
+					state.depth_write = (flags & 2) != 0;
+					states.push_back(state);
+
+				}
+
+			}
+
+		}
+
+	}
+
+	return states;
+
+}
+
+void Engine::benchmarkPipelineWarmUp() {
+
+	std::vector<vkInit::GraphicsPipelineState> states = makePipelineVariants();
+
+	// Each run gets a manager of its own, so its VkPipelineCache starts empty and every variant really compiles.
+	// A driver's own shader cache favours whichever run goes second, so the parallel one goes first
+	double times[2];
+
+	for (int run = 0; run < 2; ++run) {
+
+		vkUtil::PipelineManager manager(debug_mode, device, shader_compiler, layout_cache, run == 0 ? job_system : nullptr, false);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		manager.warmUp(states, {});
+		times[run] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	}
+
+	std::cout << "Pipeline warm-up, " << states.size() << " variants: " << times[0] << " ms on " << job_system->getThreadCount()
+		<< " threads, " << times[1] << " ms on one (" << times[1] / std::max(times[0], 0.001) << "x)\n";
+
+}
+
+void Engine::benchmarkShaderOptimization() {
+
+	std::vector<vkInit::GraphicsPipelineState> states = makePipelineVariants();
+
+	// Every module the engine builds
+	const std::vector<vkUtil::ShaderDefine> depth_only = { { "DEPTH_ONLY", "1" } };
+	const std::vector<std::pair<std::string, std::vector<vkUtil::ShaderDefine>>> shaders = {
+		{ "shader.vert", {} }, { "shader.vert", depth_only }, { "shader.frag", {} }, { "shader_occlusion.vert", {} },
+		{ "meshlet.vert", {} }, { "meshlet.vert", depth_only }, { "meshlet_cull.comp", {} }, { "occlusion_cull.comp", {} },
+		{ "depth_reduce.comp", {} }
+	};
+
+	size_t sizes[2] = {};
+	double times[2];
+
+	for (int optimized = 0; optimized < 2; ++optimized) {
+
+		// Optimized and plain modules are cached under different keys, neither run replaces the other's
+		vkUtil::ShaderCompiler compiler(debug_mode, "Shaders", "Shaders/cache", optimized != 0, false);
+
+		for (const std::pair<std::string, std::vector<vkUtil::ShaderDefine>>& shader : shaders) {
+
+			sizes[optimized] += sizeof(uint32_t) * compiler.compile(shader.first, shader.second).size();
+
+		}
+
+		// The modules are all compiled by now, what is timed is the driver. On one thread, so pipelines don't overlap
+		vkUtil::PipelineManager manager(debug_mode, device, &compiler, layout_cache, nullptr, false);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		manager.warmUp(states, {});
+		times[optimized] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	}
+
+	std::cout << "SPIR-V optimization: " << sizes[0] << " -> " << sizes[1] << " bytes over " << shaders.size() << " modules, "
+		<< states.size() << " pipelines built in " << times[0] << " -> " << times[1] << " ms\n";
+
+}
+
+void Engine::benchmarkPipelineLibraries() {
+
+	if (!pipeline_libraries_supported) {
+
+		std::cout << "Pipeline libraries: not supported by the device\n";
+		return;
+
+	}
+
+	std::vector<vkInit::GraphicsPipelineState> states = makePipelineVariants();
+
+	// Each variant is built as if it were first needed mid-frame, and the time until all of them are usable is what
+	// a hitch would be made of. Whole pipelines go first, so the driver's own cache doesn't favour them
+	double whole_time, linked_time, optimized_time;
+	uint32_t library_count;
+
+	{
+
+		vkUtil::PipelineManager manager(debug_mode, device, shader_compiler, layout_cache, job_system, false);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (const vkInit::GraphicsPipelineState& state : states) {
+
+			manager.getGraphicsPipeline(state);
+
+		}
+
+		whole_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	}
+
+	{
+
+		vkUtil::PipelineManager manager(debug_mode, device, shader_compiler, layout_cache, job_system, true);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (const vkInit::GraphicsPipelineState& state : states) {
+
+			manager.getGraphicsPipeline(state);
+
+		}
+
+		linked_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// Optimized builds started on the workers as each linked pipeline went into the cache
+		manager.waitForOptimizedBuilds();
+		optimized_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		library_count = manager.getStatistics().library_misses;
+
+	}
+
+	std::cout << "Pipeline libraries, " << states.size() << " variants: " << whole_time << " ms built whole, " << linked_time
+		<< " ms linked from " << library_count << " libraries (" << whole_time / std::max(linked_time, 0.001) << "x), all optimized after "
+		<< optimized_time << " ms\n";
+
+}
+
+void Engine::makeTransformResources() {
+
+	vkInit::DescriptorSetLayoutData bindings = {};
+	bindings.count = 1;
+	bindings.indices = { 0 };
+	bindings.types = { vk::DescriptorType::eStorageBuffer };
+	bindings.counts = { 1 };
+	bindings.stages = { vk::ShaderStageFlagBits::eVertex };
+
+	transform_set_layout = vkInit::makeDescriptorSetLayout(*layout_cache, bindings);
+
+	transform_capacity = 1024;
+
+}
+
+void Engine::makeTransformBuffers() {
+
+	uint32_t frame_count = static_cast<uint32_t>(swapchain_frames.size());
+
+	vkUtil::BufferInput buffer_input = {};
+	buffer_input.logical_device = device;
+	buffer_input.physical_device = physical_device;
+	buffer_input.memory_properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	buffer_input.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+	buffer_input.size = sizeof(glm::mat4) * transform_capacity;
+
+	vkInit::DescriptorSetLayoutData pool_bindings = {};
+	pool_bindings.count = 1;
+	pool_bindings.types = { vk::DescriptorType::eStorageBuffer };
+	pool_bindings.counts = { 1 };
+
+	transform_descriptor_pool = vkInit::makeDescriptorPool(debug_mode, device, frame_count, pool_bindings);
+
+	for (uint32_t i = 0; i < frame_count; ++i) {
+
+		vkUtil::Buffer buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+
+		// Mapped for the buffer's lifetime, the transform update writes straight into it
+		transform_mappings.push_back(static_cast<glm::mat4*>(device.mapMemory(buffer.buffer_memory, 0, buffer_input.size)));
+		transform_buffers.push_back(buffer);
+
+		vk::DescriptorSet transform_set = vkInit::allocateDescriptorSet(debug_mode, device, transform_descriptor_pool, transform_set_layout);
+		vkInit::writeBufferDescriptor(device, transform_set, 0, vk::DescriptorType::eStorageBuffer, buffer.buffer, 0, VK_WHOLE_SIZE);
+		transform_sets.push_back(transform_set);
+
+	}
+
+}
+
+void Engine::destroyTransformBuffers() {
+
+	device.destroyDescriptorPool(transform_descriptor_pool, vkUtil::hostAllocator());
+	transform_sets.clear();
+
+	for (vkUtil::Buffer& buffer : transform_buffers) {
+
+		device.unmapMemory(buffer.buffer_memory);
+		vkUtil::destroyBuffer(device, buffer);
+
+	}
+
+	transform_buffers.clear();
+	transform_mappings.clear();
+
+}
+
+void Engine::makeMeshletResources() {
+
+	vkMesh::Mesh mesh = vkMesh::makeSphere(glm::vec3(0.0f, 0.0f, 0.5f), 0.4f, 256, 256);
+	vkMesh::MeshletMesh meshlet_mesh = vkMesh::buildMeshlets(mesh);
+	meshlet_count = static_cast<uint32_t>(meshlet_mesh.meshlets.size());
+
+	if (debug_mode) {
+
+		std::cout << "Built " << meshlet_count << " meshlets for " << meshlet_mesh.triangle_count << " triangles\n";
+
+	}
+
+	vkUtil::BufferInput buffer_input = {};
+	buffer_input.logical_device = device;
+	buffer_input.physical_device = physical_device;
+	buffer_input.memory_properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+	buffer_input.size = sizeof(vkMesh::Vertex) * mesh.vertices.size();
+	buffer_input.usage = vk::BufferUsageFlagBits::eVertexBuffer;
+	meshlet_vertex_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+	vkUtil::uploadToBuffer(device, meshlet_vertex_buffer, mesh.vertices.data(), buffer_input.size);
+
+	buffer_input.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+
+	buffer_input.size = sizeof(vkMesh::Meshlet) * meshlet_mesh.meshlets.size();
+	meshlet_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+	vkUtil::uploadToBuffer(device, meshlet_buffer, meshlet_mesh.meshlets.data(), buffer_input.size);
+
+	buffer_input.size = sizeof(uint32_t) * meshlet_mesh.meshlet_vertices.size();
+	meshlet_vertex_index_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+	vkUtil::uploadToBuffer(device, meshlet_vertex_index_buffer, meshlet_mesh.meshlet_vertices.data(), buffer_input.size);
+
+	buffer_input.size = sizeof(uint32_t) * meshlet_mesh.meshlet_triangles.size();
+	meshlet_triangle_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+	vkUtil::uploadToBuffer(device, meshlet_triangle_buffer, meshlet_mesh.meshlet_triangles.data(), buffer_input.size);
+
+	buffer_input.memory_properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+	buffer_input.size = sizeof(uint32_t) * 3 * meshlet_mesh.triangle_count;
+	buffer_input.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndexBuffer;
+	meshlet_index_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+
+	buffer_input.size = sizeof(vk::DrawIndexedIndirectCommand);
+	buffer_input.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst;
+	meshlet_draw_command_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+
+	vkInit::DescriptorSetLayoutData bindings = {};
+	bindings.count = 5;
+
+	for (uint32_t i = 0; i < bindings.count; ++i) {
+
+		bindings.indices.push_back(i);
+		bindings.types.push_back(vk::DescriptorType::eStorageBuffer);
+		bindings.counts.push_back(1);
+		bindings.stages.push_back(vk::ShaderStageFlagBits::eCompute);
+
+	}
+
+	meshlet_cull_set_layout = vkInit::makeDescriptorSetLayout(*layout_cache, bindings);
+	meshlet_descriptor_pool = vkInit::makeDescriptorPool(debug_mode, device, 1, bindings);
+	meshlet_cull_descriptor_set = vkInit::allocateDescriptorSet(debug_mode, device, meshlet_descriptor_pool, meshlet_cull_set_layout);
+
+	vkInit::writeStorageBufferDescriptors(device, meshlet_cull_descriptor_set, {
+		meshlet_buffer.buffer,
+		meshlet_vertex_index_buffer.buffer,
+		meshlet_triangle_buffer.buffer,
+		meshlet_index_buffer.buffer,
+		meshlet_draw_command_buffer.buffer
+	});
+
+	vkInit::ComputePipelineState compute_state = {};
+	compute_state.compute_file_path = "meshlet_cull.comp";
+	compute_state.descriptor_set_layouts = { meshlet_cull_set_layout };
+
+	requestPipeline(&meshlet_cull_pipeline, &meshlet_cull_pipeline_layout, compute_state);
+
+}
+
+void Engine::destroyMeshletResources() {
+
+	forgetHotPipelines({ &meshlet_cull_pipeline });
+
+	device.destroyDescriptorPool(meshlet_descriptor_pool, vkUtil::hostAllocator());
+
+	vkUtil::destroyBuffer(device, meshlet_vertex_buffer);
+	vkUtil::destroyBuffer(device, meshlet_buffer);
+	vkUtil::destroyBuffer(device, meshlet_vertex_index_buffer);
+	vkUtil::destroyBuffer(device, meshlet_triangle_buffer);
+	vkUtil::destroyBuffer(device, meshlet_index_buffer);
+	vkUtil::destroyBuffer(device, meshlet_draw_command_buffer);
+
+}
+
+void Engine::makeOcclusionResources() {
+
+	vkInit::DescriptorSetLayoutData bindings = {};
+	bindings.count = 5;
+	bindings.indices = { 0, 1, 2, 3, 4 };
+	bindings.types = {
+		vk::DescriptorType::eStorageBuffer,
+		vk::DescriptorType::eStorageBuffer,
+		vk::DescriptorType::eStorageBuffer,
+		vk::DescriptorType::eStorageBuffer,
+		vk::DescriptorType::eCombinedImageSampler
+	};
+	bindings.counts = { 1, 1, 1, 1, 1 };
+	bindings.stages.assign(bindings.count, vk::ShaderStageFlagBits::eCompute);
+
+	occlusion_cull_set_layout = vkInit::makeDescriptorSetLayout(*layout_cache, bindings);
+
+	bindings.count = 2;
+	bindings.indices = { 0, 1 };
+	bindings.types = { vk::DescriptorType::eStorageBuffer, vk::DescriptorType::eStorageBuffer };
+	bindings.counts = { 1, 1 };
+	bindings.stages.assign(bindings.count, vk::ShaderStageFlagBits::eVertex);
+
+	occlusion_draw_set_layout = vkInit::makeDescriptorSetLayout(*layout_cache, bindings);
+
+	bindings.types = { vk::DescriptorType::eCombinedImageSampler, vk::DescriptorType::eStorageImage };
+	bindings.stages.assign(bindings.count, vk::ShaderStageFlagBits::eCompute);
+
+	depth_reduce_set_layout = vkInit::makeDescriptorSetLayout(*layout_cache, bindings);
+
+	depth_sampler = vkUtil::makeSampler(debug_mode, device, vk::Filter::eNearest, vk::SamplerMipmapMode::eNearest, vk::SamplerAddressMode::eClampToEdge);
+
+	vkInit::ComputePipelineState compute_state = {};
+	compute_state.compute_file_path = "occlusion_cull.comp";
+	compute_state.descriptor_set_layouts = { occlusion_cull_set_layout };
+
+	for (uint32_t phase = 0; phase < 2; ++phase) {
+
+		compute_state.permutation.specialize(0, phase);
+		requestPipeline(&occlusion_cull_pipelines[phase], &occlusion_cull_pipeline_layouts[phase], compute_state);
+
+	}
+
+	compute_state.compute_file_path = "depth_reduce.comp";
+	compute_state.permutation = {};
+	compute_state.descriptor_set_layouts = { depth_reduce_set_layout };
+
+	requestPipeline(&depth_reduce_pipeline, &depth_reduce_pipeline_layout, compute_state);
+
+	object_capacity = 1024;
+	object_count = 0;
+
+}
+
+void Engine::destroyOcclusionResources() {
+
+	forgetHotPipelines({ &occlusion_cull_pipelines[0], &occlusion_cull_pipelines[1], &depth_reduce_pipeline });
+
+	device.destroySampler(depth_sampler, vkUtil::hostAllocator());
+
+}
+
+void Engine::makeDepthPyramid() {
+
+	// Level 0 is the largest power of two that fits, so every further level halves the previous one exactly
+	depth_pyramid_width = 1;
+	depth_pyramid_height = 1;
+
+	while (depth_pyramid_width * 2 <= swapchain_extent.width) {
+
+		depth_pyramid_width *= 2;
+
+	}
+
+	while (depth_pyramid_height * 2 <= swapchain_extent.height) {
+
+		depth_pyramid_height *= 2;
+
+	}
+
+	depth_pyramid_levels = 1;
+
+	while ((std::max(depth_pyramid_width, depth_pyramid_height) >> depth_pyramid_levels) > 0) {
+
+		++depth_pyramid_levels;
+
+	}
+
+	vkUtil::ImageInput image_input = {};
+	image_input.logical_device = device;
+	image_input.physical_device = physical_device;
+	image_input.width = depth_pyramid_width;
+	image_input.height = depth_pyramid_height;
+	image_input.mip_levels = depth_pyramid_levels;
+	image_input.format = vk::Format::eR32Sfloat;
+	image_input.tiling = vk::ImageTiling::eOptimal;
+	image_input.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst;
+	image_input.memory_properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+	depth_pyramid = vkUtil::makeImage(debug_mode, image_input);
+	depth_pyramid_memory = vkUtil::makeImageMemory(debug_mode, image_input, depth_pyramid);
+	depth_pyramid_view = vkUtil::makeImageView(device, depth_pyramid, image_input.format, vk::ImageAspectFlagBits::eColor, 0, depth_pyramid_levels);
+
+	for (uint32_t level = 0; level < depth_pyramid_levels; ++level) {
+
+		depth_pyramid_mip_views.push_back(vkUtil::makeImageView(device, depth_pyramid, image_input.format, vk::ImageAspectFlagBits::eColor, level, 1));
+
+	}
+
+	depth_pyramid_ready = false;
+	depth_pyramid_on_compute = false;
+
+}
+
+void Engine::destroyDepthPyramid() {
+
+	for (vk::ImageView mip_view : depth_pyramid_mip_views) {
+
+		device.destroyImageView(mip_view, vkUtil::hostAllocator());
+
+	}
+
+	depth_pyramid_mip_views.clear();
+
+	device.destroyImageView(depth_pyramid_view, vkUtil::hostAllocator());
+	device.destroyImage(depth_pyramid, vkUtil::hostAllocator());
+	device.freeMemory(depth_pyramid_memory, vkUtil::hostAllocator());
+
+}
+
+void Engine::makeOcclusionBuffers() {
+
+	uint32_t frame_count = static_cast<uint32_t>(swapchain_frames.size());
+
+	vkUtil::BufferInput buffer_input = {};
+	buffer_input.logical_device = device;
+	buffer_input.physical_device = physical_device;
+	buffer_input.memory_properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+	buffer_input.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+	buffer_input.size = sizeof(glm::vec4) * object_capacity;
+
+	for (uint32_t i = 0; i < frame_count; ++i) {
+
+		object_buffers.push_back(vkUtil::createBuffer(debug_mode, buffer_input));
+
+	}
+
+	buffer_input.memory_properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+	buffer_input.size = sizeof(uint32_t) * object_capacity;
+	object_visibility_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+
+	buffer_input.size = sizeof(uint32_t) * 2 * object_capacity;
+	visible_object_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+
+	buffer_input.size = sizeof(vk::DrawIndirectCommand) * 2;
+	buffer_input.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst;
+	occlusion_draw_command_buffer = vkUtil::createBuffer(debug_mode, buffer_input);
+
+	// Sized as if every set were the cull set, the largest of the three layouts
+	uint32_t set_count = 3 * frame_count + frame_count + depth_pyramid_levels - 1;
+
+	vkInit::DescriptorSetLayoutData pool_bindings = {};
+	pool_bindings.count = 3;
+	pool_bindings.types = { vk::DescriptorType::eStorageBuffer, vk::DescriptorType::eCombinedImageSampler, vk::DescriptorType::eStorageImage };
+	pool_bindings.counts = { 4, 1, 1 };
+
+	occlusion_descriptor_pool = vkInit::makeDescriptorPool(debug_mode, device, set_count, pool_bindings);
+
+	vk::DeviceSize list_size = sizeof(uint32_t) * object_capacity;
+
+	for (uint32_t i = 0; i < frame_count; ++i) {
+
+		vk::DescriptorSet cull_set = vkInit::allocateDescriptorSet(debug_mode, device, occlusion_descriptor_pool, occlusion_cull_set_layout);
+
+		vkInit::writeStorageBufferDescriptors(device, cull_set, {
+			object_buffers[i].buffer,
+			object_visibility_buffer.buffer,
+			visible_object_buffer.buffer,
+			occlusion_draw_command_buffer.buffer
+		});
+		vkInit::writeImageDescriptor(device, cull_set, 4, vk::DescriptorType::eCombinedImageSampler, depth_sampler, depth_pyramid_view, vk::ImageLayout::eGeneral);
+
+		occlusion_cull_sets.push_back(cull_set);
+
+		// The late list starts object_capacity entries in, the draws themselves never need a first instance
+		for (uint32_t phase = 0; phase < 2; ++phase) {
+
+			vk::DescriptorSet draw_set = vkInit::allocateDescriptorSet(debug_mode, device, occlusion_descriptor_pool, occlusion_draw_set_layout);
+
+			vkInit::writeBufferDescriptor(device, draw_set, 0, vk::DescriptorType::eStorageBuffer, object_buffers[i].buffer, 0, VK_WHOLE_SIZE);
+			vkInit::writeBufferDescriptor(device, draw_set, 1, vk::DescriptorType::eStorageBuffer, visible_object_buffer.buffer, phase * list_size, list_size);
+
+			occlusion_draw_sets.push_back(draw_set);
+
+		}
+
+	}
+
+	for (vkUtil::SwapChainFrame& frame : swapchain_frames) {
+
+		vk::DescriptorSet reduce_set = vkInit::allocateDescriptorSet(debug_mode, device, occlusion_descriptor_pool, depth_reduce_set_layout);
+
+		vkInit::writeImageDescriptor(device, reduce_set, 0, vk::DescriptorType::eCombinedImageSampler, depth_sampler, frame.depth_buffer_view,
+									 vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+		vkInit::writeImageDescriptor(device, reduce_set, 1, vk::DescriptorType::eStorageImage, nullptr, depth_pyramid_mip_views[0], vk::ImageLayout::eGeneral);
+
+		depth_reduce_sets.push_back(reduce_set);
+
+	}
+
+	for (uint32_t level = 1; level < depth_pyramid_levels; ++level) {
+
+		vk::DescriptorSet reduce_set = vkInit::allocateDescriptorSet(debug_mode, device, occlusion_descriptor_pool, depth_reduce_set_layout);
+
+		vkInit::writeImageDescriptor(device, reduce_set, 0, vk::DescriptorType::eCombinedImageSampler, depth_sampler, depth_pyramid_mip_views[level - 1],
+									 vk::ImageLayout::eGeneral);
+		vkInit::writeImageDescriptor(device, reduce_set, 1, vk::DescriptorType::eStorageImage, nullptr, depth_pyramid_mip_views[level], vk::ImageLayout::eGeneral);
+
+		depth_reduce_sets.push_back(reduce_set);
+
+	}
+
+}
+
+void Engine::destroyOcclusionBuffers() {
+
+	device.destroyDescriptorPool(occlusion_descriptor_pool, vkUtil::hostAllocator());
+	occlusion_cull_sets.clear();
+	occlusion_draw_sets.clear();
+	depth_reduce_sets.clear();
+
+	for (vkUtil::Buffer& buffer : object_buffers) {
+
+		vkUtil::destroyBuffer(device, buffer);
+
+	}
+
+	object_buffers.clear();
+
+	vkUtil::destroyBuffer(device, object_visibility_buffer);
+	vkUtil::destroyBuffer(device, visible_object_buffer);
+	vkUtil::destroyBuffer(device, occlusion_draw_command_buffer);
+
+}
+
+void Engine::finalizeSetup() {
+
+	makeDepthResources();
+	makeFramebuffers();
+	makeTransformBuffers();
+
+	if (settings.occlusion_culling) {
+
+		makeDepthPyramid();
+		makeOcclusionBuffers();
+
+	}
+
+	command_pool = vkInit::makeCommandPool(debug_mode, device, physical_device, surface);
+
+	vkInit::CommandBufferInputChunk command_buffer_input_chunk = { device, command_pool, swapchain_frames };
+	main_command_buffer = vkInit::makeCommandBuffer(debug_mode, command_buffer_input_chunk);
+
+	vkInit::makeFrameCommandBuffers(debug_mode, command_buffer_input_chunk);
+
+	if (async_compute) {
+
+		compute_command_pool = vkInit::makeCommandPool(debug_mode, device, compute_family);
+		vkInit::CommandBufferInputChunk compute_input_chunk = { device, compute_command_pool, swapchain_frames };
+		vkInit::makeFrameComputeCommandBuffers(debug_mode, compute_input_chunk);
+
+	}
+
+	makeFrameSynchronizationObjects();
+	makeTimestampQueries();
+
+}
+
+void Engine::makeTimestampQueries() {
+
+	vk::PhysicalDeviceProperties properties = physical_device.getProperties();
+	timestamps_supported = properties.limits.timestampComputeAndGraphics;
+	timestamp_period = properties.limits.timestampPeriod;
+	statistics = {};
+
+	if (!timestamps_supported) {
+
+		return;
+
+	}
+
+	// Per frame: render pass start, end of the depth pre-pass, render pass end
+	timestamp_query_pool = vkInit::makeQueryPool(debug_mode, device, vk::QueryType::eTimestamp, 3 * static_cast<uint32_t>(swapchain_frames.size()));
+	timestamps_written.assign(swapchain_frames.size(), false);
+
+}
+
+void Engine::readTimestamps() {
+
+	if (!timestamps_supported || !timestamps_written[frame_number]) {
+
+		return;
+
+	}
+
+	uint64_t timestamps[3];
+	vk::Result result = device.getQueryPoolResults(timestamp_query_pool, 3 * frame_number, 3, sizeof(timestamps), timestamps,
+												   sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+
+	if (result != vk::Result::eSuccess) {
+
+		return;
+
+	}
+
+	float milliseconds_per_tick = timestamp_period / 1000000.0f;
+	statistics.depth_prepass_time = (timestamps[1] - timestamps[0]) * milliseconds_per_tick;
+	statistics.shading_time = (timestamps[2] - timestamps[1]) * milliseconds_per_tick;
+	statistics.gpu_frame_time = (timestamps[2] - timestamps[0]) * milliseconds_per_tick;
+
+}
+
+void Engine::makeFrameSynchronizationObjects() {
+
+	for (vkUtil::SwapChainFrame& frame : swapchain_frames) {
+
+		frame.in_flight = vkInit::makeFence(debug_mode, device);
+		frame.image_available = vkInit::makeSemaphore(debug_mode, device);
+		frame.render_finished = vkInit::makeSemaphore(debug_mode, device);
+
+		if (async_compute) {
+
+			frame.compute_in_flight = vkInit::makeFence(debug_mode, device);
+			frame.depth_released = vkInit::makeSemaphore(debug_mode, device);
+			frame.pyramid_ready = vkInit::makeSemaphore(debug_mode, device);
+
+		}
+
+	}
+
+}
+
+void Engine::makeDepthResources() {
+
+	vkUtil::ImageInput image_input = {};
+	image_input.logical_device = device;
+	image_input.physical_device = physical_device;
+	image_input.width = swapchain_extent.width;
+	image_input.height = swapchain_extent.height;
+	image_input.mip_levels = 1;
+	image_input.format = depth_format;
+	image_input.tiling = vk::ImageTiling::eOptimal;
+	image_input.usage = vk::ImageUsageFlagBits::eDepthStencilAttachment;
+	image_input.memory_properties = vk::MemoryPropertyFlagBits::eDeviceLocal;
+
+	if (settings.occlusion_culling) {
+
+		// Reduced into the depth pyramid
+		image_input.usage |= vk::ImageUsageFlagBits::eSampled;
+
+	}
+
+	for (vkUtil::SwapChainFrame& frame : swapchain_frames) {
+
+		frame.depth_buffer = vkUtil::makeImage(debug_mode, image_input);
+		frame.depth_buffer_memory = vkUtil::makeImageMemory(debug_mode, image_input, frame.depth_buffer);
+		frame.depth_buffer_view = vkUtil::makeImageView(device, frame.depth_buffer, depth_format, vk::ImageAspectFlagBits::eDepth, 0, 1);
+
+	}
+
+}
+
+void Engine::makeFramebuffers() {
+
+
+	vkInit::FrameBufferInput framebuffer_input;
+	framebuffer_input.logical_device = device;
+	framebuffer_input.render_pass = graphics_pipeline_render_pass;
+	framebuffer_input.swapchain_extent = swapchain_extent;
+	vkInit::makeFramebuffers(framebuffer_input, swapchain_frames);
+
+}
+
+void Engine::queueDraws(const SceneSnapshot& snapshot) {
+
+	render_queue.begin(frame_arenas[frame_number], snapshot.item_count);
+
+	for (uint32_t i = 0; i < snapshot.item_count; ++i) {
+
+		const RenderItem& item = snapshot.items[i];
+
+		// Every material uses the scene pipeline so far, which is pipeline 0
+		float depth = settings.sort_front_to_back ? item.depth : 0.0f;
+		render_queue.add(vkUtil::RenderQueue::makeKey(0, item.material, item.mesh, depth), i);
+
+	}
+
+	render_queue.sort();
+
+}
+
+void Engine::updateObjectTransforms(const SceneSnapshot& snapshot) {
+
+	if (snapshot.item_count > transform_capacity) {
+
+		device.waitIdle();
+		destroyTransformBuffers();
+		transform_capacity = (snapshot.item_count + 1023) / 1024 * 1024;
+		makeTransformBuffers();
+
+	}
+
+	// This frame's buffer is free once its fence has signalled, matrices are written in draw order
+	glm::mat4* output = transform_mappings[frame_number];
+	const vkUtil::QueuedDraw* draws = render_queue.getDraws();
+
+	for (uint32_t i = 0; i < render_queue.getDrawCount(); ++i) {
+
+		output[i] = snapshot.items[draws[i].item].world;
+
+	}
+
+}
+
+void Engine::recordMeshletCulling(vk::CommandBuffer command_buffer) {
+
+	// Frames in flight share the index stream, wait for earlier draws to stop reading it
+	command_buffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput,
+		vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+		vk::DependencyFlags(), nullptr, nullptr, nullptr
+	);
+
+	vk::DrawIndexedIndirectCommand draw_command = {};
+	draw_command.indexCount = 0;
+	draw_command.instanceCount = 1;
+	draw_command.firstIndex = 0;
+	draw_command.vertexOffset = 0;
+	draw_command.firstInstance = 0;
+	command_buffer.updateBuffer(meshlet_draw_command_buffer.buffer, 0, sizeof(draw_command), &draw_command);
+
+	vkUtil::MemoryDependency reset_dependency = {};
+	reset_dependency.src_stages = vk::PipelineStageFlagBits::eTransfer;
+	reset_dependency.src_access = vk::AccessFlagBits::eTransferWrite;
+	reset_dependency.dst_stages = vk::PipelineStageFlagBits::eComputeShader;
+	reset_dependency.dst_access = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+	vkUtil::recordBarrier(command_buffer, reset_dependency);
+
+	vkUtil::Frustum frustum = vkUtil::extractFrustum(view_projection);
+	vkUtil::MeshletCullData cull_data;
+
+	for (int i = 0; i < 6; ++i) {
+
+		cull_data.frustum[i] = frustum.planes[i];
+
+	}
+
+	cull_data.camera_position = glm::vec4(camera_position, 1.0f);
+
+	// Until the culling pipeline is built the reset command above draws no triangles
+	vkUtil::ComputeDispatch dispatch = {};
+	dispatch.pipeline = meshlet_cull_pipeline;
+	dispatch.layout = meshlet_cull_pipeline_layout;
+	dispatch.descriptor_set = meshlet_cull_descriptor_set;
+	dispatch.push_constants = &cull_data;
+	dispatch.push_constant_size = sizeof(cull_data);
+	dispatch.group_count_x = meshlet_count;
+	dispatch.group_count_y = 1;
+	dispatch.group_count_z = 1;
+
+	vkUtil::MemoryDependency cull_dependency = {};
+	cull_dependency.src_stages = vk::PipelineStageFlagBits::eComputeShader;
+	cull_dependency.src_access = vk::AccessFlagBits::eShaderWrite;
+	cull_dependency.dst_stages = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexInput;
+	cull_dependency.dst_access = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eIndexRead;
+	vkUtil::recordDispatch(command_buffer, dispatch, cull_dependency);
+
+}
+
+void Engine::recordMeshletDraw(vk::CommandBuffer command_buffer, vk::Pipeline pipeline, vk::PipelineLayout pipeline_layout) {
+
+	// Still building
+	if (!pipeline) {
+
+		return;
+
+	}
+
+	command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+
+	vk::DeviceSize vertex_offset = 0;
+	command_buffer.bindVertexBuffers(0, 1, &meshlet_vertex_buffer.buffer, &vertex_offset);
+	command_buffer.bindIndexBuffer(meshlet_index_buffer.buffer, 0, vk::IndexType::eUint32);
+
+	vkUtil::ObjectData object_data;
+	object_data.model = glm::mat4(1.0f);
+	object_data.view_projection = view_projection;
+	command_buffer.pushConstants(pipeline_layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(object_data), &object_data);
+
+	command_buffer.drawIndexedIndirect(meshlet_draw_command_buffer.buffer, 0, 1, sizeof(vk::DrawIndexedIndirectCommand));
+
+}
+
+void Engine::uploadObjects(const SceneSnapshot& snapshot) {
+
+	object_count = snapshot.object_count;
+
+	if (object_count > object_capacity) {
+
+		device.waitIdle();
+		destroyOcclusionBuffers();
+		object_capacity = (object_count + 1023) / 1024 * 1024;
+		makeOcclusionBuffers();
+
+	}
+
+	if (object_count > 0) {
+
+		vkUtil::uploadToBuffer(device, object_buffers[frame_number], snapshot.object_spheres, sizeof(glm::vec4) * object_count);
+
+	}
+
+}
+
+void Engine::recordOcclusionCulling(vk::CommandBuffer command_buffer, uint32_t phase) {
+
+	// Side planes of the frustum, symmetric around the view axis so one of each pair is enough
+	glm::mat4 projection_transpose = glm::transpose(projection);
+	glm::vec4 frustum_x = projection_transpose[3] + projection_transpose[0];
+	glm::vec4 frustum_y = projection_transpose[3] + projection_transpose[1];
+	frustum_x /= glm::length(glm::vec3(frustum_x));
+	frustum_y /= glm::length(glm::vec3(frustum_y));
+
+	float near_plane = -projection[3][2] / projection[2][2];
+
+	vkUtil::OcclusionCullData cull_data = {};
+	cull_data.view = view;
+	cull_data.frustum = glm::vec4(frustum_x.x, frustum_x.z, frustum_y.y, frustum_y.z);
+	cull_data.projection = glm::vec4(projection[0][0], projection[1][1], projection[2][2], projection[3][2]);
+	cull_data.pyramid = glm::vec4(depth_pyramid_width, depth_pyramid_height, depth_pyramid_levels, near_plane);
+	cull_data.object_count = object_count;
+	cull_data.late_offset = object_capacity;
+
+	// Without the culling pipeline the draw commands keep their zero instance counts
+	vkUtil::ComputeDispatch dispatch = {};
+	dispatch.pipeline = occlusion_cull_pipelines[phase];
+	dispatch.layout = occlusion_cull_pipeline_layouts[phase];
+	dispatch.descriptor_set = occlusion_cull_sets[frame_number];
+	dispatch.push_constants = &cull_data;
+	dispatch.push_constant_size = sizeof(cull_data);
+	dispatch.group_count_x = vkUtil::groupCount(cull_data.object_count, 64);
+	dispatch.group_count_y = 1;
+	dispatch.group_count_z = 1;
+
+	vkUtil::MemoryDependency cull_dependency = {};
+	cull_dependency.src_stages = vk::PipelineStageFlagBits::eComputeShader;
+	cull_dependency.src_access = vk::AccessFlagBits::eShaderWrite;
+	cull_dependency.dst_stages = vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader;
+	cull_dependency.dst_access = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead;
+	vkUtil::recordDispatch(command_buffer, dispatch, cull_dependency);
+
+}
+
+void Engine::recordOcclusionDraw(vk::CommandBuffer command_buffer, uint32_t phase) {
+
+	if (!occlusion_pipeline) {
+
+		return;
+
+	}
+
+	command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, occlusion_pipeline);
+	command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, occlusion_pipeline_layout, 0, occlusion_draw_sets[2 * frame_number + phase], nullptr);
+
+	vkUtil::ObjectData object_data;
+	object_data.model = glm::mat4(1.0f);
+	object_data.view_projection = view_projection;
+	command_buffer.pushConstants(occlusion_pipeline_layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(object_data), &object_data);
+
+	command_buffer.drawIndirect(occlusion_draw_command_buffer.buffer, phase * sizeof(vk::DrawIndirectCommand), 1, sizeof(vk::DrawIndirectCommand));
+
+}
+
+vk::ImageAspectFlags Engine::depthAspect() {
+
+	vk::ImageAspectFlags depth_aspect = vk::ImageAspectFlagBits::eDepth;
+
+	if (depth_format != vk::Format::eD32Sfloat) {
+
+		depth_aspect |= vk::ImageAspectFlagBits::eStencil;
+
+	}
+
+	return depth_aspect;
+
+}
+
+// Expects the depth buffer in DepthStencilReadOnlyOptimal and the pyramid in General, visible to compute
+void Engine::recordDepthReduction(vk::CommandBuffer command_buffer, uint32_t image_index) {
+
+	// Until the reduction pipeline is built the pyramid stays cleared to the far plane and occludes nothing
+	if (depth_reduce_pipeline) {
+
+		// Each level reads the one written before it
+		vkUtil::MemoryDependency level_dependency = {};
+		level_dependency.src_stages = vk::PipelineStageFlagBits::eComputeShader;
+		level_dependency.src_access = vk::AccessFlagBits::eShaderWrite;
+		level_dependency.dst_stages = vk::PipelineStageFlagBits::eComputeShader;
+		level_dependency.dst_access = vk::AccessFlagBits::eShaderRead;
+
+		for (uint32_t level = 0; level < depth_pyramid_levels; ++level) {
+
+			glm::vec2 source_size = glm::vec2(swapchain_extent.width, swapchain_extent.height);
+
+			if (level > 0) {
+
+				source_size = glm::vec2(std::max(1u, depth_pyramid_width >> (level - 1)), std::max(1u, depth_pyramid_height >> (level - 1)));
+
+			}
+
+			uint32_t destination_width = std::max(1u, depth_pyramid_width >> level);
+			uint32_t destination_height = std::max(1u, depth_pyramid_height >> level);
+
+			glm::vec4 reduce_data = glm::vec4(source_size, destination_width, destination_height);
+
+			vkUtil::ComputeDispatch dispatch = {};
+			dispatch.pipeline = depth_reduce_pipeline;
+			dispatch.layout = depth_reduce_pipeline_layout;
+			dispatch.descriptor_set = level == 0 ? depth_reduce_sets[image_index] : depth_reduce_sets[swapchain_frames.size() + level - 1];
+			dispatch.push_constants = &reduce_data;
+			dispatch.push_constant_size = sizeof(reduce_data);
+			dispatch.group_count_x = vkUtil::groupCount(destination_width, 8);
+			dispatch.group_count_y = vkUtil::groupCount(destination_height, 8);
+			dispatch.group_count_z = 1;
+			vkUtil::recordDispatch(command_buffer, dispatch, level_dependency);
+
+		}
+
+	}
+
+}
+
+void Engine::recordDepthPyramid(vk::CommandBuffer command_buffer, uint32_t image_index) {
+
+	vk::ImageMemoryBarrier depth_barrier = {};
+	depth_barrier.srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+	depth_barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+	depth_barrier.oldLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+	depth_barrier.newLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+	depth_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	depth_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	depth_barrier.image = swapchain_frames[image_index].depth_buffer;
+	depth_barrier.subresourceRange = vk::ImageSubresourceRange(depthAspect(), 0, 1, 0, 1);
+
+	// The culling pass must be done reading the levels about to be overwritten
+	vk::ImageMemoryBarrier pyramid_barrier = {};
+	pyramid_barrier.srcAccessMask = vk::AccessFlagBits::eShaderRead;
+	pyramid_barrier.dstAccessMask = vk::AccessFlagBits::eShaderWrite;
+	pyramid_barrier.oldLayout = vk::ImageLayout::eGeneral;
+	pyramid_barrier.newLayout = vk::ImageLayout::eGeneral;
+	pyramid_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	pyramid_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	pyramid_barrier.image = depth_pyramid;
+	pyramid_barrier.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, depth_pyramid_levels, 0, 1);
+
+	std::array<vk::ImageMemoryBarrier, 2> barriers = { depth_barrier, pyramid_barrier };
+	command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eLateFragmentTests | vk::PipelineStageFlagBits::eComputeShader,
+								   vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), nullptr, nullptr, barriers);
+
+	recordDepthReduction(command_buffer, image_index);
+
+	depth_barrier.srcAccessMask = vk::AccessFlagBits::eShaderRead;
+	depth_barrier.dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+	depth_barrier.oldLayout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+	depth_barrier.newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+	command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+								   vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+								   vk::DependencyFlags(), nullptr, nullptr, depth_barrier);
+
+}
+
+vkUtil::OwnershipTransfer Engine::makeDepthTransfer(uint32_t image_index) {
+
+	// Only ever handed to the compute queue. The next render pass into it clears it from an undefined layout,
+	// which discards the contents instead of needing them back
+	vkUtil::OwnershipTransfer transfer = {};
+	transfer.image = swapchain_frames[image_index].depth_buffer;
+	transfer.range = vk::ImageSubresourceRange(depthAspect(), 0, 1, 0, 1);
+	transfer.old_layout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+	transfer.new_layout = vk::ImageLayout::eDepthStencilReadOnlyOptimal;
+	transfer.src_family = graphics_family;
+	transfer.dst_family = compute_family;
+	return transfer;
+
+}
+
+vkUtil::OwnershipTransfer Engine::makePyramidTransfer(uint32_t src_family, uint32_t dst_family) {
 
-	makePipeline();
+	vkUtil::OwnershipTransfer transfer = {};
+	transfer.image = depth_pyramid;
+	transfer.range = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, depth_pyramid_levels, 0, 1);
+	transfer.old_layout = vk::ImageLayout::eGeneral;
+	transfer.new_layout = vk::ImageLayout::eGeneral;
+	transfer.src_family = src_family;
+	transfer.dst_family = dst_family;
+	return transfer;
 
-	finalizeSetup();
 }
 
+void Engine::recordAsyncDepthPyramid(vk::CommandBuffer command_buffer, uint32_t image_index) {
 
-Engine::~Engine() {
+	vk::CommandBufferBeginInfo command_buffer_begin_info = {};
 
-	device.waitIdle();
+	try {
+
+		command_buffer.begin(command_buffer_begin_info);
 
-	device.destroyCommandPool(command_pool);
+	}
+	catch (vk::SystemError err) {
 
-	device.destroyPipeline(graphics_pipeline);
-	device.destroyPipelineLayout(graphics_pipeline_layout);
-	device.destroyRenderPass(graphics_pipeline_render_pass);
+		if (debug_mode) {
 
-	cleanupSwapchain();
+			std::cout << "Failed to begin recording compute command buffer" << std::endl;
 
-	device.destroy();
+		}
 
-	instance.destroySurfaceKHR(surface);
+	}
 
-	instance.destroyDebugUtilsMessengerEXT(debug_messenger, nullptr, dispatch_loader);
+	// Released by the graphics queue at the end of the frame that drew the depth
+	vkUtil::recordAcquire(command_buffer, makeDepthTransfer(image_index), vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead);
+	vkUtil::recordAcquire(command_buffer, makePyramidTransfer(graphics_family, compute_family), vk::PipelineStageFlagBits::eComputeShader,
+						  vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
 
-	instance.destroy();
+	recordDepthReduction(command_buffer, image_index);
 
-	glfwTerminate();
+	// Acquired back by the next frame's culling
+	vkUtil::recordRelease(command_buffer, makePyramidTransfer(compute_family, graphics_family), vk::PipelineStageFlagBits::eComputeShader,
+						  vk::AccessFlagBits::eShaderWrite);
+
+	try {
+
+		command_buffer.end();
+
+	}
+	catch (vk::SystemError err) {
+
+		if (debug_mode) {
+
+			std::cout << "Failed to finish recording compute command buffer" << std::endl;
+
+		}
+	}
 
 }
 
+void Engine::submitDepthPyramid(uint32_t image_index) {
 
+	vkUtil::SwapChainFrame& frame = swapchain_frames[frame_number];
 
-void Engine::makeInstance() {
+	device.waitForFences(1, &frame.compute_in_flight, VK_TRUE, UINT64_MAX);
+	recordAsyncDepthPyramid(frame.compute_commandbuffer, image_index);
 
-	instance = vkInit::makeInstance(debug_mode, "Cyan Crate: A Vulkan Engine");
-	dispatch_loader = vk::DispatchLoaderDynamic(instance, vkGetInstanceProcAddr);
+	// The graphics submission signals depth_released once it has released the depth and the pyramid
+	vk::SubmitInfo submit_info = {};
+	vk::PipelineStageFlags wait_stages[] = { vk::PipelineStageFlagBits::eComputeShader };
+	submit_info.waitSemaphoreCount = 1;
+	submit_info.pWaitSemaphores = &frame.depth_released;
+	submit_info.pWaitDstStageMask = wait_stages;
+	submit_info.commandBufferCount = 1;
+	submit_info.pCommandBuffers = &frame.compute_commandbuffer;
+	submit_info.signalSemaphoreCount = 1;
+	submit_info.pSignalSemaphores = &frame.pyramid_ready;
 
+	device.resetFences(1, &frame.compute_in_flight);
 
-	VkSurfaceKHR c_style_surface;
-	
-	if (glfwCreateWindowSurface(instance, window, nullptr, &c_style_surface) != VK_SUCCESS) {
+	try {
+
+		compute_queue.submit(submit_info, frame.compute_in_flight);
+
+	}
+	catch (vk::SystemError err) {
 
 		if (debug_mode) {
 
-			std::cout << "Failed to abstract the glfw surface for Vulkan!\n";
+			std::cout << "Failed to submit compute command buffer" << std::endl;
 
 		}
 
-		return;
+	}
+
+	depth_pyramid_on_compute = true;
+	depth_pyramid_slot = frame_number;
+
+}
+
+void Engine::recordOcclusionCulledPasses(vk::CommandBuffer command_buffer, uint32_t image_index) {
+
+	// Frames in flight share the culling buffers and the pyramid, wait for earlier frames to stop using them
+	vk::MemoryBarrier reuse_barrier = {};
+	reuse_barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+	reuse_barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+	command_buffer.pipelineBarrier(
+		vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eComputeShader,
+		vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+		vk::DependencyFlags(), reuse_barrier, nullptr, nullptr
+	);
+
+	if (!depth_pyramid_ready) {
+
+		// Until a frame has been drawn nothing counts as an occluder
+		vk::ImageSubresourceRange pyramid_range = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, depth_pyramid_levels, 0, 1);
+
+		vk::ImageMemoryBarrier clear_barrier = {};
+		clear_barrier.srcAccessMask = vk::AccessFlags();
+		clear_barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+		clear_barrier.oldLayout = vk::ImageLayout::eUndefined;
+		clear_barrier.newLayout = vk::ImageLayout::eGeneral;
+		clear_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		clear_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		clear_barrier.image = depth_pyramid;
+		clear_barrier.subresourceRange = pyramid_range;
+		command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+									   vk::DependencyFlags(), nullptr, nullptr, clear_barrier);
+
+		command_buffer.clearColorImage(depth_pyramid, vk::ImageLayout::eGeneral,
+									   vk::ClearColorValue(std::array<float, 4>{1.0f, 1.0f, 1.0f, 1.0f}), pyramid_range);
+
+		depth_pyramid_ready = true;
 
 	}
+	else if (depth_pyramid_on_compute) {
 
-	if (debug_mode) {
+		// submitDepthPyramid reduced it from the previous frame's depth, the submission waits on its semaphore
+		vkUtil::recordAcquire(command_buffer, makePyramidTransfer(compute_family, graphics_family), vk::PipelineStageFlagBits::eComputeShader,
+							  vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
 
-		std::cout << "Succeded to abstract the glfw surface for Vulkan!\n";
+	}
+
+	std::array<vk::DrawIndirectCommand, 2> draw_commands = {};
+
+	for (vk::DrawIndirectCommand& draw_command : draw_commands) {
+
+		draw_command.vertexCount = 3;
+		draw_command.instanceCount = 0;
+		draw_command.firstVertex = 0;
+		draw_command.firstInstance = 0;
 
 	}
 
-	surface = c_style_surface;
+	command_buffer.updateBuffer(occlusion_draw_command_buffer.buffer, 0, sizeof(draw_commands), draw_commands.data());
 
-}
+	vk::MemoryBarrier reset_barrier = {};
+	reset_barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+	reset_barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+	command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+								   vk::DependencyFlags(), reset_barrier, nullptr, nullptr);
 
-void Engine::makeDebugMessenger() {
+	// Early phase: whatever survives the previous frame's pyramid
+	recordOcclusionCulling(command_buffer, 0);
 
-	debug_messenger = vkInit::makeDebugMessenger(instance, dispatch_loader);
+	vk::RenderPassBeginInfo render_pass_begin_info = {};
 
-}
+	render_pass_begin_info.renderPass = graphics_pipeline_render_pass;
+	render_pass_begin_info.framebuffer = swapchain_frames[image_index].framebuffer;
+	render_pass_begin_info.renderArea.offset.x = 0;
+	render_pass_begin_info.renderArea.offset.y = 0;
+	render_pass_begin_info.renderArea.extent = swapchain_extent;
+	std::array<vk::ClearValue, 2> clear_values = {};
+	clear_values[0].color = vk::ClearColorValue(std::array<float, 4>{1.0f, 0.5f, 0.25f, 1.0f});
+	clear_values[1].depthStencil = vk::ClearDepthStencilValue(1.0f, 0);
+	render_pass_begin_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
+	render_pass_begin_info.pClearValues = clear_values.data();
 
-void Engine::makeDevice()
-{
+	command_buffer.beginRenderPass(&render_pass_begin_info, vk::SubpassContents::eInline);
 
-	physical_device = vkInit::choosePhysicalDevice(debug_mode, instance);
-	device = vkInit::createLogicalDevice(debug_mode, physical_device, surface);
-	std::array<vk::Queue, 2>queue = vkInit::getQueue(debug_mode, physical_device, device, surface);
-	graphics_queue = queue[0];
-	present_queue = queue[1];
+	recordOcclusionDraw(command_buffer, 0);
 
-	// vkInit::querySwapChainSupport(debug_mode, physical_device, surface); 
-	makeSwapchain();
-	frame_number = 0;
+	if (settings.meshlet_culling) {
 
-}
+		recordMeshletDraw(command_buffer, meshlet_pipeline, meshlet_pipeline_layout);
 
-void Engine::makePipeline() {
+	}
 
-	vkInit::GraphicsPipelineInBundle specification = {};
+	command_buffer.endRenderPass();
 
-	specification.logical_device = device;
-	specification.vertex_file_path = "Shaders/vertex.spv";
-	specification.fragment_file_path = "Shaders/fragment.spv";
-	specification.swapchain_image_format = swapchain_format;
-	specification.swapchain_extent = swapchain_extent;
+	if (timestamps_supported) {
 
-	vkInit::GraphicsPipelineOutBundle output = vkInit::makeGraphicsPipeline(debug_mode, specification);
+		command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, timestamp_query_pool, 3 * frame_number + 1);
 
-	graphics_pipeline_layout = output.layout;
-	graphics_pipeline_render_pass = output.render_pass;
-	graphics_pipeline = output.pipeline;
+	}
 
-}
+	// Late phase: objects the early phase rejected, tested against what was actually drawn this frame
+	recordDepthPyramid(command_buffer, image_index);
+	recordOcclusionCulling(command_buffer, 1);
 
-void Engine::finalizeSetup() {
+	render_pass_begin_info.renderPass = occlusion_late_render_pass;
 
-	makeFramebuffers();
+	command_buffer.beginRenderPass(&render_pass_begin_info, vk::SubpassContents::eInline);
 
-	command_pool = vkInit::makeCommandPool(debug_mode, device, physical_device, surface);
+	recordOcclusionDraw(command_buffer, 1);
 
-	vkInit::CommandBufferInputChunk command_buffer_input_chunk = { device, command_pool, swapchain_frames };
-	main_command_buffer = vkInit::makeCommandBuffer(debug_mode, command_buffer_input_chunk);
+	command_buffer.endRenderPass();
 
-	vkInit::makeFrameCommandBuffers(debug_mode, command_buffer_input_chunk);
+	// The finished depth becomes next frame's occluders
+	if (async_compute) {
 
-	makeFrameSynchronizationObjects();
+		// Reduced on the compute queue instead, which overlaps presenting this frame and recording the next
+		vkUtil::recordRelease(command_buffer, makeDepthTransfer(image_index),
+							  vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+							  vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+		vkUtil::recordRelease(command_buffer, makePyramidTransfer(graphics_family, compute_family), vk::PipelineStageFlagBits::eComputeShader,
+							  vk::AccessFlagBits::eShaderWrite);
+
+	}
+	else {
+
+		recordDepthPyramid(command_buffer, image_index);
+
+	}
 
 }
 
-void Engine::makeFrameSynchronizationObjects() {
+void Engine::recordSceneDraws(vk::CommandBuffer command_buffer, vk::Pipeline pipeline, vk::PipelineLayout pipeline_layout) {
 
-	for (vkUtil::SwapChainFrame& frame : swapchain_frames) {
+	// Still building, the pass goes ahead without these draws
+	if (!pipeline) {
 
-		frame.in_flight = vkInit::makeFence(debug_mode, device);
-		frame.image_available = vkInit::makeSemaphore(debug_mode, device);
-		frame.render_finished = vkInit::makeSemaphore(debug_mode, device);
+		return;
 
 	}
 
-}
+	vkUtil::SceneDrawData draw_data = {};
+	draw_data.view_projection = view_projection;
 
-void Engine::makeFramebuffers() {
+	// Sorted draws share state with their neighbours, binds are only recorded where the key changes.
+	// Materials and meshes have nothing to bind yet, their key bits only group the draws
+	const uint32_t unbound = 0xFFFFFFFF;
+	uint32_t bound_pipeline = unbound;
+	const vkUtil::QueuedDraw* draws = render_queue.getDraws();
+	uint32_t draw_count = render_queue.getDrawCount();
 
+	for (uint32_t first = 0; first < draw_count;) {
 
-	vkInit::FrameBufferInput framebuffer_input;
-	framebuffer_input.logical_device = device;
-	framebuffer_input.render_pass = graphics_pipeline_render_pass;
-	framebuffer_input.swapchain_extent = swapchain_extent;
-	vkInit::makeFramebuffers(framebuffer_input, swapchain_frames);
+		uint64_t state = vkUtil::RenderQueue::getState(draws[first].key);
+		uint32_t last = first + 1;
+
+		// A run sharing all state is one instanced draw over its consecutive transforms
+		if (settings.batch_draws) {
+
+			while (last < draw_count && vkUtil::RenderQueue::getState(draws[last].key) == state) {
+
+				++last;
+
+			}
+
+		}
+
+		uint32_t key_pipeline = vkUtil::RenderQueue::getPipeline(draws[first].key);
+
+		// Pipeline 0 is the pass's own, the only one so far
+		if (key_pipeline != bound_pipeline) {
+
+			command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+			command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline_layout, 0, transform_sets[frame_number], nullptr);
+			bound_pipeline = key_pipeline;
+			++statistics.pipeline_binds;
+			++statistics.descriptor_set_binds;
+			command_buffer.pushConstants(pipeline_layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(draw_data), &draw_data);
+
+		}
+
+		command_buffer.draw(3, last - first, 0, first);
+		statistics.draw_count += last - first;
+		++statistics.batch_count;
+
+		first = last;
+
+	}
 
 }
 
-void Engine::recordDrawCommands(vk::CommandBuffer command_buffer, uint32_t image_index, Scene* scene) {
+void Engine::recordDrawCommands(vk::CommandBuffer command_buffer, uint32_t image_index) {
 
 	vk::CommandBufferBeginInfo command_buffer_begin_info = {};
 
@@ -180,32 +1995,45 @@ void Engine::recordDrawCommands(vk::CommandBuffer command_buffer, uint32_t image
 
 	}
 
-	vk::RenderPassBeginInfo render_pass_begin_info = {};
+	if (settings.meshlet_culling) {
 
-	render_pass_begin_info.renderPass = graphics_pipeline_render_pass;
-	render_pass_begin_info.framebuffer = swapchain_frames[image_index].framebuffer;
-	render_pass_begin_info.renderArea.offset.x = 0;
-	render_pass_begin_info.renderArea.offset.y = 0;
-	render_pass_begin_info.renderArea.extent = swapchain_extent;
-	vk::ClearValue clear_color = { std::array<float, 4>{1.0f, 0.5f, 0.25f, 1.0f} };
-	render_pass_begin_info.clearValueCount = 1;
-	render_pass_begin_info.pClearValues = &clear_color;
+		recordMeshletCulling(command_buffer);
 
-	command_buffer.beginRenderPass(&render_pass_begin_info, vk::SubpassContents::eInline);
+	}
+
+	statistics.draw_count = 0;
+	statistics.batch_count = 0;
+	statistics.pipeline_binds = 0;
+	statistics.descriptor_set_binds = 0;
 
-	command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, graphics_pipeline);
+	uint32_t first_query = 3 * frame_number;
 
-	for (glm::vec3 position : scene->triangle_positions) {
+	if (timestamps_supported) {
 
-		glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
-		vkUtil::ObjectData object_data;
-		object_data.model = model;
-		command_buffer.pushConstants(graphics_pipeline_layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(object_data), &object_data);
-		command_buffer.draw(3, 1, 0, 0);
+		command_buffer.resetQueryPool(timestamp_query_pool, first_query, 3);
+		command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, timestamp_query_pool, first_query);
 
 	}
 
-	command_buffer.endRenderPass();
+	if (settings.occlusion_culling) {
+
+		recordOcclusionCulledPasses(command_buffer, image_index);
+
+	}
+	else {
+
+		recordScenePass(command_buffer, image_index);
+
+	}
+
+	statistics.average_batch_size = statistics.batch_count > 0 ? static_cast<float>(statistics.draw_count) / statistics.batch_count : 0.0f;
+
+	if (timestamps_supported) {
+
+		command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, timestamp_query_pool, first_query + 2);
+		timestamps_written[frame_number] = true;
+
+	}
 
 	try {
 
@@ -223,11 +2051,82 @@ void Engine::recordDrawCommands(vk::CommandBuffer command_buffer, uint32_t image
 
 }
 
-void Engine::render(Scene* scene) {
+void Engine::recordScenePass(vk::CommandBuffer command_buffer, uint32_t image_index) {
+
+	vk::RenderPassBeginInfo render_pass_begin_info = {};
+
+	render_pass_begin_info.renderPass = graphics_pipeline_render_pass;
+	render_pass_begin_info.framebuffer = swapchain_frames[image_index].framebuffer;
+	render_pass_begin_info.renderArea.offset.x = 0;
+	render_pass_begin_info.renderArea.offset.y = 0;
+	render_pass_begin_info.renderArea.extent = swapchain_extent;
+	std::array<vk::ClearValue, 2> clear_values = {};
+	clear_values[0].color = vk::ClearColorValue(std::array<float, 4>{1.0f, 0.5f, 0.25f, 1.0f});
+	clear_values[1].depthStencil = vk::ClearDepthStencilValue(1.0f, 0);
+	render_pass_begin_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
+	render_pass_begin_info.pClearValues = clear_values.data();
+
+	command_buffer.beginRenderPass(&render_pass_begin_info, vk::SubpassContents::eInline);
+
+	if (settings.depth_prepass) {
+
+		recordSceneDraws(command_buffer, depth_prepass_pipeline, depth_prepass_pipeline_layout);
+
+		if (settings.meshlet_culling) {
+
+			recordMeshletDraw(command_buffer, meshlet_depth_prepass_pipeline, meshlet_depth_prepass_pipeline_layout);
+
+		}
+
+		command_buffer.nextSubpass(vk::SubpassContents::eInline);
+
+	}
+
+	if (timestamps_supported) {
+
+		command_buffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, timestamp_query_pool, 3 * frame_number + 1);
+
+	}
+
+	recordSceneDraws(command_buffer, graphics_pipeline, graphics_pipeline_layout);
+
+	// The dense mesh goes last so the scene's depth can reject as much of it as possible
+	if (settings.meshlet_culling) {
+
+		recordMeshletDraw(command_buffer, meshlet_pipeline, meshlet_pipeline_layout);
+
+	}
+
+	command_buffer.endRenderPass();
+
+}
+
+bool Engine::beginFrame(uint32_t& image_index) {
+
+	// Waits for a visible framebuffer by skipping frames, the thread handling events never blocks here
+	if (swapchain_outdated) {
+
+		if (width == 0 || height == 0) {
+
+			return false;
+
+		}
+
+		recreateSwapchain();
+		swapchain_outdated = false;
+
+	}
 
 	device.waitForFences(1, &swapchain_frames[frame_number].in_flight, VK_TRUE, UINT64_MAX);
-	
-	uint32_t image_index;
+	frame_arenas[frame_number].reset();
+
+	// The fence wait above is what makes this a frame boundary for pipelines
+	destroyRetiredPipelines(false);
+	swapReloadedPipelines();
+	upgradeLinkedPipelines();
+	resolvePendingPipelines();
+
+	readTimestamps();
 
 	try {
 		vk::ResultValue aquire = device.acquireNextImageKHR(swapchain, UINT64_MAX, swapchain_frames[frame_number].image_available, nullptr);
@@ -235,28 +2134,45 @@ void Engine::render(Scene* scene) {
 	}
 	catch (vk::OutOfDateKHRError err) {
 
-		recreateSwapchain();
-		return;
+		swapchain_outdated = true;
+		return false;
 
 	}
 
+	swapchain_frames[frame_number].commandbuffer.reset();
+
+	return true;
+
+}
+
+void Engine::endFrame(uint32_t image_index) {
+
 	vk::CommandBuffer command_buffer = swapchain_frames[frame_number].commandbuffer;
 
-	command_buffer.reset();
+	recordDrawCommands(command_buffer, image_index);
 
-	recordDrawCommands(command_buffer, image_index, scene);
+	// With async compute, culling waits for the pyramid reduced from the previous frame's depth, and depth writes
+	// wait for that reduction to stop reading a depth buffer this frame may draw into again
+	bool wait_for_pyramid = async_compute && depth_pyramid_on_compute;
 
 	vk::SubmitInfo submit_info = {};
-	vk::Semaphore wait_semaphores[] = { swapchain_frames[frame_number].image_available };
-	vk::PipelineStageFlags wait_stages[] = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
-	submit_info.waitSemaphoreCount = 1;
+	vk::Semaphore wait_semaphores[] = {
+		swapchain_frames[frame_number].image_available,
+		wait_for_pyramid ? swapchain_frames[depth_pyramid_slot].pyramid_ready : nullptr
+	};
+	vk::PipelineStageFlags wait_stages[] = {
+		vk::PipelineStageFlagBits::eColorAttachmentOutput,
+		vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests
+	};
+	submit_info.waitSemaphoreCount = wait_for_pyramid ? 2 : 1;
 	submit_info.pWaitSemaphores = wait_semaphores;
 	submit_info.pWaitDstStageMask = wait_stages;
 	submit_info.commandBufferCount = 1;
 	submit_info.pCommandBuffers = &command_buffer;
 
-	vk::Semaphore signal_semaphores[] = { swapchain_frames[frame_number].render_finished };
-	submit_info.signalSemaphoreCount = 1;
+	// Present waits on render_finished alone, depth_released starts this frame's reduction on the compute queue
+	vk::Semaphore signal_semaphores[] = { swapchain_frames[frame_number].render_finished, swapchain_frames[frame_number].depth_released };
+	submit_info.signalSemaphoreCount = async_compute ? 2 : 1;
 	submit_info.pSignalSemaphores = signal_semaphores;
 
 	device.resetFences(1, &swapchain_frames[frame_number].in_flight);
@@ -276,6 +2192,12 @@ void Engine::render(Scene* scene) {
 
 	}
 
+	if (async_compute) {
+
+		submitDepthPyramid(image_index);
+
+	}
+
 	vk::PresentInfoKHR present_info = {};
 	present_info.waitSemaphoreCount = 1;
 	present_info.pWaitSemaphores = signal_semaphores;
@@ -296,7 +2218,7 @@ void Engine::render(Scene* scene) {
 	}
 	if (present == vk::Result::eErrorOutOfDateKHR || present == vk::Result::eSuboptimalKHR) {
 
-		recreateSwapchain();
+		swapchain_outdated = true;
 		return;
 
 	}
@@ -305,6 +2227,42 @@ void Engine::render(Scene* scene) {
 
 }
 
+void Engine::render(const SceneSnapshot& snapshot) {
+
+	allocations::Scope allocation_scope(allocations::Subsystem::eRender);
+
+	width = snapshot.framebuffer_width;
+	height = snapshot.framebuffer_height;
+
+	uint32_t image_index;
+
+	if (!beginFrame(image_index)) {
+
+		return;
+
+	}
+
+	view = snapshot.view;
+	projection = snapshot.projection;
+	view_projection = projection * view;
+	camera_position = snapshot.camera_position;
+
+	if (settings.occlusion_culling) {
+
+		uploadObjects(snapshot);
+
+	}
+	else {
+
+		queueDraws(snapshot);
+		updateObjectTransforms(snapshot);
+
+	}
+
+	endFrame(image_index);
+
+}
+
 void Engine::makeSwapchain() {
 
 
@@ -315,6 +2273,7 @@ void Engine::makeSwapchain() {
 	swapchain_format = bundle.format;
 	swapchain_extent = bundle.extent;
 	max_frames_in_flight = static_cast<int> (swapchain_frames.size());
+	frame_arenas.resize(swapchain_frames.size());
 
 
 
@@ -322,40 +2281,69 @@ void Engine::makeSwapchain() {
 
 void Engine::recreateSwapchain() {
 
-	width = 0;
-	height = 0;
-
-	while (width == 0 || height == 0) {
-
-		glfwGetFramebufferSize(window, &width, &height);
-		glfwWaitEvents();
-
-	}
-
 	device.waitIdle();
 
 	cleanupSwapchain();
 	makeSwapchain();
+	makeDepthResources();
 	makeFramebuffers();
+	makeTransformBuffers();
+
+	if (settings.occlusion_culling) {
+
+		makeDepthPyramid();
+		makeOcclusionBuffers();
+
+	}
+
 	makeFrameSynchronizationObjects();
+	makeTimestampQueries();
 
 	vkInit::CommandBufferInputChunk command_buffer_input_chunk = { device, command_pool, swapchain_frames };
 	vkInit::makeFrameCommandBuffers(debug_mode, command_buffer_input_chunk);
 
+	if (async_compute) {
+
+		vkInit::CommandBufferInputChunk compute_input_chunk = { device, compute_command_pool, swapchain_frames };
+		vkInit::makeFrameComputeCommandBuffers(debug_mode, compute_input_chunk);
+
+	}
+
 }
 
 void Engine::cleanupSwapchain() {
 
 	for (auto& frame : swapchain_frames) {
 
-		device.destroyImageView(frame.image_view);
-		device.destroyFramebuffer(frame.framebuffer);
-		device.destroyFence(frame.in_flight);
-		device.destroySemaphore(frame.image_available);
-		device.destroySemaphore(frame.render_finished);
+		device.destroyImageView(frame.image_view, vkUtil::hostAllocator());
+		device.destroyFramebuffer(frame.framebuffer, vkUtil::hostAllocator());
+		device.destroyImageView(frame.depth_buffer_view, vkUtil::hostAllocator());
+		device.destroyImage(frame.depth_buffer, vkUtil::hostAllocator());
+		device.freeMemory(frame.depth_buffer_memory, vkUtil::hostAllocator());
+		device.destroyFence(frame.in_flight, vkUtil::hostAllocator());
+		device.destroySemaphore(frame.image_available, vkUtil::hostAllocator());
+		device.destroySemaphore(frame.render_finished, vkUtil::hostAllocator());
+		device.destroyFence(frame.compute_in_flight, vkUtil::hostAllocator());
+		device.destroySemaphore(frame.depth_released, vkUtil::hostAllocator());
+		device.destroySemaphore(frame.pyramid_ready, vkUtil::hostAllocator());
+
+	}
+
+	if (timestamps_supported) {
+
+		device.destroyQueryPool(timestamp_query_pool, vkUtil::hostAllocator());
+
+	}
+
+	destroyTransformBuffers();
+
+	if (settings.occlusion_culling) {
+
+		destroyOcclusionBuffers();
+		destroyDepthPyramid();
 
 	}
 
-	device.destroySwapchainKHR(swapchain);
+	device.destroySwapchainKHR(swapchain, vkUtil::hostAllocator());
 
 }
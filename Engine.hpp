@@ -4,26 +4,92 @@
 #include <GLFW/glfw3.h>
 #include <vulkan/vulkan.hpp>
 #include <iostream>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
 #include "Frame.hpp"
-#include "Scene.hpp"
+#include "Buffer.hpp"
+#include "RenderStructs.hpp"
+#include "SceneSnapshot.hpp"
+#include "RenderQueue.hpp"
+#include "ShaderCompiler.hpp"
+#include "DescriptorSetLayoutCache.hpp"
+#include "FileWatcher.hpp"
+#include "PipelineManager.hpp"
+#include "JobSystem.hpp"
+#include "ComputeDispatch.hpp"
 
+struct EngineSettings {
+
+	// Draw a dense mesh as meshlets culled on the GPU by frustum and normal cone
+	bool meshlet_culling;
+
+	// Record opaque draws nearest first so early depth testing rejects hidden fragments
+	bool sort_front_to_back;
+
+	// Lay down depth in a position-only subpass, then shade with an EQUAL depth test
+	bool depth_prepass;
+
+	// Merge sorted draws sharing pipeline, material and mesh into one instanced draw
+	bool batch_draws;
+
+	// Draw objects that pass a two-phase test against a depth pyramid, replaces the pre-pass
+	bool occlusion_culling;
+
+	// With occlusion culling, reduce each frame's depth into the pyramid on a compute-only queue when the device
+	// has one, so presenting doesn't wait for the reduction
+	bool async_compute;
+
+	// Rebuild pipelines whose GLSL changes on disk while running
+	bool shader_hot_reload;
+
+	// Load the SPIR-V the pre-build step embedded into the executable, shaders it lacks and shaders edited
+	// while running come from disk
+	bool embedded_shaders;
+
+	// Link new graphics pipelines from cached parts when the device has VK_EXT_graphics_pipeline_library,
+	// optimized builds replace them in the background
+	bool pipeline_libraries;
+
+};
 
 class Engine {
 
 public:
 
-	Engine(const bool& debug, int width, int height, GLFWwindow* window);
+	// Pipelines build on the job system's threads, it has to outlive the engine
+	Engine(const bool& debug, int width, int height, GLFWwindow* window, const EngineSettings& settings, jobs::JobSystem* job_system);
 	~Engine();
 
-	void render(Scene* scene);
+	// Uses only the snapshot and never calls GLFW, so it can run on a thread of its own. The snapshot
+	// must stay untouched until this returns
+	void render(const SceneSnapshot& snapshot);
+
+	void setDepthPrepass(bool enabled);
+	void setDrawBatching(bool enabled);
+
+	vkUtil::FrameStatistics getStatistics();
+	vkUtil::PipelineCacheStatistics getPipelineCacheStatistics();
+
+	// Builds over a hundred variants of the scene pipelines from scratch, in parallel and then on one thread,
+	// and prints both times
+	void benchmarkPipelineWarmUp();
+	// SPIR-V size and pipeline build time of the same shaders with and without spirv-opt's passes
+	void benchmarkShaderOptimization();
+	// The same variants built whole and linked from pipeline libraries, one after another on the calling thread
+	void benchmarkPipelineLibraries();
 
 private:
 
 	bool debug_mode;
+	EngineSettings settings;
 
+	// Framebuffer size the swapchain is made for, zero while the window is minimized
 	int width;
 	int height;
 	GLFWwindow* window;
+	// Set when presenting reports a stale swapchain, it is remade once the framebuffer has a size
+	bool swapchain_outdated;
 
 	vk::Instance instance = nullptr;
 	vk::DispatchLoaderDynamic dispatch_loader;
@@ -32,22 +98,168 @@ private:
 
 	vk::PhysicalDevice physical_device = nullptr;
 	vk::Device device = nullptr;
+	// VK_EXT_graphics_pipeline_library is enabled, with fast linking
+	bool pipeline_libraries_supported;
 	vk::Queue graphics_queue = nullptr;
 	vk::Queue present_queue = nullptr;
+	// The graphics queue when the device has no compute-only family
+	vk::Queue compute_queue = nullptr;
+	uint32_t graphics_family, compute_family;
+	// The depth pyramid is reduced on compute_queue, see submitDepthPyramid
+	bool async_compute;
 	vk::SwapchainKHR swapchain = nullptr;
 	std::vector<vkUtil::SwapChainFrame> swapchain_frames;
 	vk::Format swapchain_format;
 	vk::Extent2D swapchain_extent;
+	vk::Format depth_format;
+
+	vkUtil::ShaderCompiler* shader_compiler;
+	// Every descriptor set layout, including the ones pipelines reflect from their shaders
+	vkUtil::DescriptorSetLayoutCache* layout_cache;
+	// Owns every pipeline, pipeline layout and render pass. Destroying pipelines only forgets them here,
+	// making them again with the same state gets the cached ones back
+	vkUtil::PipelineManager* pipeline_manager;
+	jobs::JobSystem* job_system;
+
+	// Pipelines requested but still building. Draws needing one are skipped until beginFrame finds it ready
+	struct PendingPipeline {
+
+		vk::Pipeline* pipeline;
+		vk::PipelineLayout* layout;
+		// Asks the pipeline manager again, true once the pipeline is built
+		std::function<bool(vk::Pipeline&, vk::PipelineLayout&)> resolve;
+
+	};
+
+	std::vector<PendingPipeline> pending_pipelines;
+
+	// Shader hot reload. Pipelines built from GLSL register how to rebuild themselves, the watcher's thread
+	// recompiles edited shaders and rebuilds the pipelines using them, and beginFrame swaps the results in.
+	// Replaced pipelines are destroyed once no frame in flight can still be using them, their layouts stay with
+	// the pipeline manager
+	struct HotPipeline {
+
+		vk::Pipeline* pipeline;
+		vk::PipelineLayout* layout;
+		std::vector<std::string> shaders;
+		// Runs on the watcher's thread, false if a shader failed to compile
+		std::function<bool(vk::Pipeline&, vk::PipelineLayout&)> rebuild;
+
+	};
+
+	struct ReloadedPipeline {
+
+		vk::Pipeline* target;
+		vk::PipelineLayout* target_layout;
+		vk::Pipeline pipeline;
+		vk::PipelineLayout layout;
+
+	};
+
+	struct RetiredPipeline {
+
+		vk::Pipeline pipeline;
+		int frames_left;
+
+	};
+
+	vkUtil::FileWatcher* shader_watcher;
+	// Held for a whole rebuild, so forgetting a pipeline can wait out its rebuild
+	std::mutex rebuild_mutex;
+	// Guards hot_pipelines and reloaded_pipelines, never held while compiling
+	std::mutex hot_reload_mutex;
+	std::vector<HotPipeline> hot_pipelines;
+	std::vector<ReloadedPipeline> reloaded_pipelines;
+	std::vector<RetiredPipeline> retired_pipelines;
 
 	vk::PipelineLayout graphics_pipeline_layout;
 	vk::RenderPass graphics_pipeline_render_pass;
 	vk::Pipeline graphics_pipeline;
+	vk::PipelineLayout depth_prepass_pipeline_layout;
+	vk::Pipeline depth_prepass_pipeline;
+
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 view_projection;
+	glm::vec3 camera_position;
+
+	// World matrices in draw order, one persistently mapped buffer per frame in flight
+	vk::DescriptorSetLayout transform_set_layout;
+	vk::DescriptorPool transform_descriptor_pool;
+	std::vector<vk::DescriptorSet> transform_sets;
+	std::vector<vkUtil::Buffer> transform_buffers;
+	std::vector<glm::mat4*> transform_mappings;
+	uint32_t transform_capacity;
+
+	// The snapshot's items sorted by state, then depth when sorting front to back
+	vkUtil::RenderQueue render_queue;
+
+	// Transient CPU data of each frame in flight, reset once the frame's fence has signalled
+	std::vector<vkUtil::FrameArena> frame_arenas;
+
+	vk::PipelineLayout meshlet_pipeline_layout;
+	vk::Pipeline meshlet_pipeline;
+	vk::PipelineLayout meshlet_depth_prepass_pipeline_layout;
+	vk::Pipeline meshlet_depth_prepass_pipeline;
+	vk::PipelineLayout meshlet_cull_pipeline_layout;
+	vk::Pipeline meshlet_cull_pipeline;
+	vk::DescriptorSetLayout meshlet_cull_set_layout;
+	vk::DescriptorPool meshlet_descriptor_pool;
+	vk::DescriptorSet meshlet_cull_descriptor_set;
+	vkUtil::Buffer meshlet_vertex_buffer;
+	vkUtil::Buffer meshlet_buffer;
+	vkUtil::Buffer meshlet_vertex_index_buffer;
+	vkUtil::Buffer meshlet_triangle_buffer;
+	vkUtil::Buffer meshlet_index_buffer;
+	vkUtil::Buffer meshlet_draw_command_buffer;
+	uint32_t meshlet_count;
+
+	vk::PipelineLayout occlusion_pipeline_layout;
+	vk::Pipeline occlusion_pipeline;
+	vk::RenderPass occlusion_late_render_pass;
+	// One per phase, specialized from the same shader
+	vk::PipelineLayout occlusion_cull_pipeline_layouts[2];
+	vk::Pipeline occlusion_cull_pipelines[2];
+	vk::PipelineLayout depth_reduce_pipeline_layout;
+	vk::Pipeline depth_reduce_pipeline;
+	vk::DescriptorSetLayout occlusion_cull_set_layout;
+	vk::DescriptorSetLayout occlusion_draw_set_layout;
+	vk::DescriptorSetLayout depth_reduce_set_layout;
+	vk::Sampler depth_sampler;
+	vk::DescriptorPool occlusion_descriptor_pool;
+	// One per frame in flight, draw sets alternate early and late lists
+	std::vector<vk::DescriptorSet> occlusion_cull_sets;
+	std::vector<vk::DescriptorSet> occlusion_draw_sets;
+	// One per swapchain image reducing its depth buffer, then one per further pyramid level
+	std::vector<vk::DescriptorSet> depth_reduce_sets;
+	std::vector<vkUtil::Buffer> object_buffers;
+	vkUtil::Buffer object_visibility_buffer;
+	vkUtil::Buffer visible_object_buffer;
+	vkUtil::Buffer occlusion_draw_command_buffer;
+	uint32_t object_capacity;
+	uint32_t object_count;
+	vk::Image depth_pyramid;
+	vk::DeviceMemory depth_pyramid_memory;
+	vk::ImageView depth_pyramid_view;
+	std::vector<vk::ImageView> depth_pyramid_mip_views;
+	uint32_t depth_pyramid_width, depth_pyramid_height, depth_pyramid_levels;
+	bool depth_pyramid_ready;
+	// The pyramid was last reduced on the compute queue, signalling pyramid_ready of that frame slot
+	bool depth_pyramid_on_compute = false;
+	int depth_pyramid_slot;
 
 	vk::CommandPool command_pool;
 	vk::CommandBuffer main_command_buffer;
+	vk::CommandPool compute_command_pool = nullptr;
 
 	int max_frames_in_flight, frame_number;
 
+	bool timestamps_supported;
+	float timestamp_period;
+	vk::QueryPool timestamp_query_pool;
+	std::vector<bool> timestamps_written;
+	vkUtil::FrameStatistics statistics;
+
 	void makeInstance();
 
 	void makeDebugMessenger();
@@ -59,13 +271,70 @@ private:
 	void recreateSwapchain();
 
 	void makePipeline();
+	void destroyPipelines();
+	// Shaded and depth-only scene pipelines under every combination of fixed function state, for the benchmarks
+	std::vector<vkInit::GraphicsPipelineState> makePipelineVariants();
+
+	// Fill pipeline and layout if the pipeline is built, otherwise leave them null until resolvePendingPipelines
+	void requestPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::GraphicsPipelineState& state);
+	void requestPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::ComputePipelineState& state);
+	void resolvePendingPipelines();
+
+	void registerHotPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::GraphicsPipelineState& state);
+	void registerHotPipeline(vk::Pipeline* pipeline, vk::PipelineLayout* layout, const vkInit::ComputePipelineState& state);
+	// Before letting go of registered pipelines, waits for a rebuild in progress and drops pending requests
+	void forgetHotPipelines(std::initializer_list<vk::Pipeline*> pipelines);
+	void reloadShaders(const std::vector<std::string>& changed_files);
+	void swapReloadedPipelines();
+	// Swaps optimized pipelines in for the fast-linked ones they replace in the pipeline manager
+	void upgradeLinkedPipelines();
+	void destroyRetiredPipelines(bool all);
+
+	void makeTransformResources();
+	void makeTransformBuffers();
+	void destroyTransformBuffers();
+
+	void makeMeshletResources();
+	void destroyMeshletResources();
+
+	void makeOcclusionResources();
+	void destroyOcclusionResources();
+	void makeDepthPyramid();
+	void destroyDepthPyramid();
+	void makeOcclusionBuffers();
+	void destroyOcclusionBuffers();
 
 	void finalizeSetup();
 
+	void makeDepthResources();
 	void makeFramebuffers();
 	void makeFrameSynchronizationObjects();
+	void makeTimestampQueries();
+
+	void readTimestamps();
+
+	bool beginFrame(uint32_t& image_index);
+	void endFrame(uint32_t image_index);
+
+	void queueDraws(const SceneSnapshot& snapshot);
+	void updateObjectTransforms(const SceneSnapshot& snapshot);
 
-	void recordDrawCommands(vk::CommandBuffer command_buffer, uint32_t image_index, Scene* scene);
+	void recordMeshletCulling(vk::CommandBuffer command_buffer);
+	void recordMeshletDraw(vk::CommandBuffer command_buffer, vk::Pipeline pipeline, vk::PipelineLayout pipeline_layout);
+	void uploadObjects(const SceneSnapshot& snapshot);
+	void recordOcclusionCulling(vk::CommandBuffer command_buffer, uint32_t phase);
+	void recordOcclusionDraw(vk::CommandBuffer command_buffer, uint32_t phase);
+	vk::ImageAspectFlags depthAspect();
+	void recordDepthReduction(vk::CommandBuffer command_buffer, uint32_t image_index);
+	void recordDepthPyramid(vk::CommandBuffer command_buffer, uint32_t image_index);
+	vkUtil::OwnershipTransfer makeDepthTransfer(uint32_t image_index);
+	vkUtil::OwnershipTransfer makePyramidTransfer(uint32_t src_family, uint32_t dst_family);
+	void recordAsyncDepthPyramid(vk::CommandBuffer command_buffer, uint32_t image_index);
+	void submitDepthPyramid(uint32_t image_index);
+	void recordOcclusionCulledPasses(vk::CommandBuffer command_buffer, uint32_t image_index);
+	void recordSceneDraws(vk::CommandBuffer command_buffer, vk::Pipeline pipeline, vk::PipelineLayout pipeline_layout);
+	void recordScenePass(vk::CommandBuffer command_buffer, uint32_t image_index);
+	void recordDrawCommands(vk::CommandBuffer command_buffer, uint32_t image_index);
 
 	void cleanupSwapchain();
 
@@ -0,0 +1,289 @@
+#include "EntityStore.hpp"
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace ecs {
+
+	namespace {
+
+		// Fixed size, so sizes can be read while another thread registers a new type
+		std::array<size_t, max_component_types> component_sizes = {};
+		std::atomic<uint32_t> component_type_count = 0;
+
+		size_t alignOffset(size_t offset) {
+
+			return (offset + component_alignment - 1) / component_alignment * component_alignment;
+
+		}
+
+	}
+
+	ComponentId registerComponent(size_t size) {
+
+		ComponentId component = component_type_count++;
+
+		if (component >= max_component_types) {
+
+			throw std::runtime_error("Too many component types!");
+
+		}
+
+		component_sizes[component] = size;
+		return component;
+
+	}
+
+	size_t getComponentSize(ComponentId component) {
+
+		return component_sizes[component];
+
+	}
+
+	uint32_t EntityStore::findOrAddArchetype(ComponentMask mask) {
+
+		auto found = archetype_lookup.find(mask);
+
+		if (found != archetype_lookup.end()) {
+
+			return found->second;
+
+		}
+
+		Archetype archetype = {};
+		archetype.mask = mask;
+
+		size_t bytes_per_entity = sizeof(Entity);
+		size_t array_count = 1;
+
+		for (ComponentId component = 0; component < max_component_types; ++component) {
+
+			if (mask & (1u << component)) {
+
+				bytes_per_entity += component_sizes[component];
+				++array_count;
+
+			}
+
+		}
+
+		// Leave room for aligning the start of every array
+		archetype.capacity = static_cast<uint32_t>((chunk_size - array_count * component_alignment) / bytes_per_entity);
+
+		size_t offset = alignOffset(archetype.capacity * sizeof(Entity));
+
+		for (ComponentId component = 0; component < max_component_types; ++component) {
+
+			if (mask & (1u << component)) {
+
+				archetype.offsets[component] = static_cast<uint32_t>(offset);
+				offset = alignOffset(offset + archetype.capacity * component_sizes[component]);
+
+			}
+
+		}
+
+		uint32_t archetype_index = static_cast<uint32_t>(archetypes.size());
+		archetypes.push_back(std::move(archetype));
+		archetype_lookup.emplace(mask, archetype_index);
+
+		return archetype_index;
+
+	}
+
+	void EntityStore::allocateRow(uint32_t archetype_index, uint32_t entity_index) {
+
+		Archetype& archetype = archetypes[archetype_index];
+
+		if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity) {
+
+			archetype.chunks.push_back({ std::make_unique<ChunkMemory>(), 0 });
+
+		}
+
+		Chunk& chunk = archetype.chunks.back();
+		uint32_t row = chunk.count++;
+
+		EntityRecord& record = records[entity_index];
+		record.archetype = archetype_index;
+		record.chunk = static_cast<uint32_t>(archetype.chunks.size() - 1);
+		record.row = row;
+
+		archetype.entities(chunk)[row] = { entity_index, record.generation };
+
+		for (ComponentId component = 0; component < max_component_types; ++component) {
+
+			if (archetype.mask & (1u << component)) {
+
+				memset(archetype.component(chunk, component, row), 0, component_sizes[component]);
+
+			}
+
+		}
+
+	}
+
+	void EntityStore::releaseRow(const EntityRecord& record) {
+
+		Archetype& archetype = archetypes[record.archetype];
+		Chunk& chunk = archetype.chunks[record.chunk];
+		Chunk& last_chunk = archetype.chunks.back();
+		uint32_t last_row = last_chunk.count - 1;
+
+		if (&chunk != &last_chunk || record.row != last_row) {
+
+			Entity moved = archetype.entities(last_chunk)[last_row];
+			archetype.entities(chunk)[record.row] = moved;
+
+			for (ComponentId component = 0; component < max_component_types; ++component) {
+
+				if (archetype.mask & (1u << component)) {
+
+					memcpy(archetype.component(chunk, component, record.row), archetype.component(last_chunk, component, last_row),
+						component_sizes[component]);
+
+				}
+
+			}
+
+			records[moved.index].chunk = record.chunk;
+			records[moved.index].row = record.row;
+
+		}
+
+		if (--last_chunk.count == 0) {
+
+			archetype.chunks.pop_back();
+
+		}
+
+	}
+
+	Entity EntityStore::create(ComponentMask mask) {
+
+		uint32_t index;
+
+		if (!free_indices.empty()) {
+
+			index = free_indices.back();
+			free_indices.pop_back();
+
+		}
+		else {
+
+			index = static_cast<uint32_t>(records.size());
+			records.push_back({ 0, 0, 0, 0, false });
+
+		}
+
+		records[index].alive = true;
+		allocateRow(findOrAddArchetype(mask), index);
+		++entity_count;
+
+		return { index, records[index].generation };
+
+	}
+
+	void EntityStore::destroy(Entity entity) {
+
+		if (!isAlive(entity)) {
+
+			return;
+
+		}
+
+		EntityRecord& record = records[entity.index];
+		releaseRow(record);
+		record.alive = false;
+		++record.generation;
+		free_indices.push_back(entity.index);
+		--entity_count;
+
+	}
+
+	void EntityStore::changeArchetype(Entity entity, ComponentMask mask) {
+
+		if (!isAlive(entity)) {
+
+			return;
+
+		}
+
+		// Looked up first, adding an archetype may move the others
+		uint32_t archetype_index = findOrAddArchetype(mask);
+		EntityRecord previous = records[entity.index];
+
+		if (archetype_index == previous.archetype) {
+
+			return;
+
+		}
+
+		allocateRow(archetype_index, entity.index);
+
+		const Archetype& source = archetypes[previous.archetype];
+		const Archetype& destination = archetypes[archetype_index];
+		const EntityRecord& record = records[entity.index];
+		ComponentMask shared = source.mask & destination.mask;
+
+		for (ComponentId component = 0; component < max_component_types; ++component) {
+
+			if (shared & (1u << component)) {
+
+				memcpy(destination.component(destination.chunks[record.chunk], component, record.row),
+					source.component(source.chunks[previous.chunk], component, previous.row), component_sizes[component]);
+
+			}
+
+		}
+
+		releaseRow(previous);
+
+	}
+
+	bool EntityStore::isAlive(Entity entity) const {
+
+		return entity.index < records.size() && records[entity.index].alive && records[entity.index].generation == entity.generation;
+
+	}
+
+	Entity EntityStore::getEntity(uint32_t index) const {
+
+		return { index, records[index].generation };
+
+	}
+
+	uint32_t EntityStore::getEntitySlotCount() const {
+
+		return static_cast<uint32_t>(records.size());
+
+	}
+
+	size_t EntityStore::getEntityCount() const {
+
+		return entity_count;
+
+	}
+
+	void* EntityStore::getComponent(Entity entity, ComponentId component) const {
+
+		if (!isAlive(entity)) {
+
+			return nullptr;
+
+		}
+
+		const EntityRecord& record = records[entity.index];
+		const Archetype& archetype = archetypes[record.archetype];
+
+		if (!(archetype.mask & (1u << component))) {
+
+			return nullptr;
+
+		}
+
+		return archetype.component(archetype.chunks[record.chunk], component, record.row);
+
+	}
+
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+namespace ecs {
+
+	// Handles stay valid until destroyed, a recycled index gets a new generation so stale handles are detected
+	struct Entity {
+
+		uint32_t index;
+		uint32_t generation;
+
+		bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+		bool operator!=(const Entity& other) const { return !(*this == other); }
+
+	};
+
+	// Never alive, stands for "no entity" in handles such as a parent
+	const Entity null_entity = { 0xFFFFFFFF, 0 };
+
+	using ComponentId = uint32_t;
+	using ComponentMask = uint32_t;
+
+	const uint32_t max_component_types = 32;
+	const size_t chunk_size = 16384;
+	const size_t component_alignment = 16;
+
+	ComponentId registerComponent(size_t size);
+	size_t getComponentSize(ComponentId component);
+
+	// Ids are handed out on first use, components are moved between chunks with memcpy
+	template<typename Component>
+	ComponentId componentId() {
+
+		static_assert(std::is_trivially_copyable<Component>::value, "Components must be trivially copyable");
+		static_assert(alignof(Component) <= component_alignment, "Component alignment exceeds the chunk array alignment");
+
+		static const ComponentId id = registerComponent(sizeof(Component));
+		return id;
+
+	}
+
+	template<typename... Components>
+	ComponentMask componentMask() {
+
+		ComponentMask mask = 0;
+		((mask |= 1u << componentId<typename std::remove_const<Components>::type>()), ...);
+		return mask;
+
+	}
+
+	// Every entity with the same set of components lives in the same archetype. Its chunks are 16 KB
+	// blocks holding the entity handles followed by one tightly packed array per component, so a
+	// system touching one component streams through memory without loading the others
+	class EntityStore {
+
+	public:
+
+		Entity create(ComponentMask mask);
+
+		template<typename... Components>
+		Entity create() { return create(componentMask<Components...>()); }
+
+		// The last entity of the archetype is moved into the hole, so chunks stay dense
+		void destroy(Entity entity);
+
+		bool isAlive(Entity entity) const;
+
+		// Current handle for a live index, as stored by systems that only keep indices
+		Entity getEntity(uint32_t index) const;
+
+		// Indices run below this, destroyed entities included
+		uint32_t getEntitySlotCount() const;
+		size_t getEntityCount() const;
+
+		// Null when the entity is stale or lacks the component
+		template<typename Component>
+		Component* get(Entity entity) {
+
+			return static_cast<Component*>(getComponent(entity, componentId<Component>()));
+
+		}
+
+		template<typename Component>
+		const Component* get(Entity entity) const {
+
+			return static_cast<const Component*>(getComponent(entity, componentId<Component>()));
+
+		}
+
+		// Moves the entity to the archetype with the extra component
+		template<typename Component>
+		Component* add(Entity entity, const Component& value) {
+
+			changeArchetype(entity, archetypes[records[entity.index].archetype].mask | componentMask<Component>());
+			Component* component = get<Component>(entity);
+			*component = value;
+			return component;
+
+		}
+
+		template<typename Component>
+		void remove(Entity entity) {
+
+			changeArchetype(entity, archetypes[records[entity.index].archetype].mask & ~componentMask<Component>());
+
+		}
+
+		// Calls function(const Entity* entities, uint32_t count, Components*... arrays) once per chunk
+		// of every archetype holding all the requested components
+		template<typename... Components, typename Function>
+		void forEachChunk(Function&& function) {
+
+			ComponentMask required = componentMask<Components...>();
+
+			for (Archetype& archetype : archetypes) {
+
+				if ((archetype.mask & required) != required) {
+
+					continue;
+
+				}
+
+				for (Chunk& chunk : archetype.chunks) {
+
+					function(archetype.entities(chunk), chunk.count, archetype.template components<Components>(chunk)...);
+
+				}
+
+			}
+
+		}
+
+		template<typename... Components, typename Function>
+		void forEachChunk(Function&& function) const {
+
+			ComponentMask required = componentMask<Components...>();
+
+			for (const Archetype& archetype : archetypes) {
+
+				if ((archetype.mask & required) != required) {
+
+					continue;
+
+				}
+
+				for (const Chunk& chunk : archetype.chunks) {
+
+					function(static_cast<const Entity*>(archetype.entities(chunk)), chunk.count,
+						static_cast<const Components*>(archetype.template components<Components>(chunk))...);
+
+				}
+
+			}
+
+		}
+
+	private:
+
+		struct alignas(component_alignment) ChunkMemory {
+
+			unsigned char bytes[chunk_size];
+
+		};
+
+		struct Chunk {
+
+			std::unique_ptr<ChunkMemory> memory;
+			uint32_t count;
+
+		};
+
+		struct Archetype {
+
+			ComponentMask mask;
+			uint32_t capacity;
+			// Byte offset of each component's array within a chunk, the entity array starts at 0
+			std::array<uint32_t, max_component_types> offsets;
+			std::vector<Chunk> chunks;
+
+			Entity* entities(const Chunk& chunk) const {
+
+				return reinterpret_cast<Entity*>(chunk.memory->bytes);
+
+			}
+
+			template<typename Component>
+			Component* components(const Chunk& chunk) const {
+
+				return reinterpret_cast<Component*>(chunk.memory->bytes + offsets[componentId<typename std::remove_const<Component>::type>()]);
+
+			}
+
+			unsigned char* component(const Chunk& chunk, ComponentId component, uint32_t row) const {
+
+				return chunk.memory->bytes + offsets[component] + row * getComponentSize(component);
+
+			}
+
+		};
+
+		struct EntityRecord {
+
+			uint32_t generation;
+			uint32_t archetype;
+			uint32_t chunk;
+			uint32_t row;
+			bool alive;
+
+		};
+
+		std::vector<Archetype> archetypes;
+		std::unordered_map<ComponentMask, uint32_t> archetype_lookup;
+		std::vector<EntityRecord> records;
+		std::vector<uint32_t> free_indices;
+		size_t entity_count = 0;
+
+		uint32_t findOrAddArchetype(ComponentMask mask);
+		void allocateRow(uint32_t archetype_index, uint32_t entity_index);
+		void releaseRow(const EntityRecord& record);
+		void changeArchetype(Entity entity, ComponentMask mask);
+		void* getComponent(Entity entity, ComponentId component) const;
+
+	};
+
+}
@@ -0,0 +1,187 @@
+#include "FileWatcher.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <unordered_map>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace vkUtil {
+
+	namespace {
+
+		// How often the loop looks at running, and how often polling rescans the directory
+		const int wake_interval_ms = 100;
+		const int poll_interval_ms = 250;
+
+		void addUnique(std::vector<std::string>& paths, const std::string& path) {
+
+			if (std::find(paths.begin(), paths.end(), path) == paths.end()) {
+
+				paths.push_back(path);
+
+			}
+
+		}
+
+	}
+
+	FileWatcher::FileWatcher(const std::string& directory, std::function<void(const std::vector<std::string>&)> on_change) {
+
+		this->directory = directory;
+		this->on_change = std::move(on_change);
+		running = true;
+		thread = std::thread(&FileWatcher::watchLoop, this);
+
+	}
+
+	FileWatcher::~FileWatcher() {
+
+		running = false;
+		thread.join();
+
+	}
+
+	std::string FileWatcher::pathOf(const std::string& name) const {
+
+		return (std::filesystem::path(directory) / name).lexically_normal().generic_string();
+
+	}
+
+	void FileWatcher::watchLoop() {
+
+		if (!watchWithInotify()) {
+
+			watchByPolling();
+
+		}
+
+	}
+
+	bool FileWatcher::watchWithInotify() {
+
+#ifdef __linux__
+		int descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (descriptor < 0) {
+
+			return false;
+
+		}
+
+		// Editors either write in place or write a temporary file and rename it over the original
+		if (inotify_add_watch(descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+
+			close(descriptor);
+			return false;
+
+		}
+
+		alignas(inotify_event) char buffer[4096];
+
+		while (running.load(std::memory_order_relaxed)) {
+
+			pollfd poll_descriptor = { descriptor, POLLIN, 0 };
+
+			if (poll(&poll_descriptor, 1, wake_interval_ms) <= 0) {
+
+				continue;
+
+			}
+
+			std::vector<std::string> changed;
+			ssize_t length;
+
+			while ((length = read(descriptor, buffer, sizeof(buffer))) > 0) {
+
+				for (char* entry = buffer; entry < buffer + length;) {
+
+					const inotify_event* event = reinterpret_cast<const inotify_event*>(entry);
+
+					if (event->len > 0 && !(event->mask & IN_ISDIR)) {
+
+						addUnique(changed, pathOf(event->name));
+
+					}
+
+					entry += sizeof(inotify_event) + event->len;
+
+				}
+
+			}
+
+			if (!changed.empty()) {
+
+				on_change(changed);
+
+			}
+
+		}
+
+		close(descriptor);
+		return true;
+#else
+		return false;
+#endif
+
+	}
+
+	void FileWatcher::watchByPolling() {
+
+		std::unordered_map<std::string, std::filesystem::file_time_type> write_times;
+		bool first_scan = true;
+
+		while (running.load(std::memory_order_relaxed)) {
+
+			std::vector<std::string> changed;
+			std::error_code error;
+
+			for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error)) {
+
+				if (!entry.is_regular_file(error)) {
+
+					continue;
+
+				}
+
+				std::filesystem::file_time_type write_time = entry.last_write_time(error);
+				std::string path = pathOf(entry.path().filename().string());
+				auto known = write_times.find(path);
+
+				if (known == write_times.end() || known->second != write_time) {
+
+					write_times[path] = write_time;
+
+					// The first scan only learns what is there
+					if (!first_scan) {
+
+						changed.push_back(path);
+
+					}
+
+				}
+
+			}
+
+			first_scan = false;
+
+			if (!changed.empty()) {
+
+				on_change(changed);
+
+			}
+
+			for (int waited = 0; waited < poll_interval_ms && running.load(std::memory_order_relaxed); waited += wake_interval_ms) {
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(wake_interval_ms));
+
+			}
+
+		}
+
+	}
+
+}
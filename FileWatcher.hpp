@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vkUtil {
+
+	// Reports files written in one directory, not its subdirectories, from a thread of its own.
+	// Uses inotify on Linux and compares modification times a few times a second elsewhere
+	class FileWatcher {
+
+	public:
+
+		// on_change gets the changed paths as directory/name, on the watcher's thread
+		FileWatcher(const std::string& directory, std::function<void(const std::vector<std::string>&)> on_change);
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+	private:
+
+		std::string directory;
+		std::function<void(const std::vector<std::string>&)> on_change;
+		std::atomic<bool> running;
+		std::thread thread;
+
+		void watchLoop();
+		// False if inotify is unavailable, the caller falls back to polling
+		bool watchWithInotify();
+		void watchByPolling();
+		std::string pathOf(const std::string& name) const;
+
+	};
+
+}
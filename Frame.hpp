@@ -10,11 +10,21 @@ namespace vkUtil {
 		vk::Image image;
 		vk::ImageView image_view;
 		vk::Framebuffer framebuffer;
+
+		vk::Image depth_buffer;
+		vk::DeviceMemory depth_buffer_memory;
+		vk::ImageView depth_buffer_view;
+
 		vk::CommandBuffer commandbuffer;
 
 		vk::Semaphore image_available, render_finished;
 		vk::Fence in_flight;
 
+		// Async compute: reduces this frame's depth into the pyramid the next frame culls against
+		vk::CommandBuffer compute_commandbuffer;
+		vk::Semaphore depth_released, pyramid_ready;
+		vk::Fence compute_in_flight;
+
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "FrameArena.hpp"
+#include <cstdint>
+
+namespace vkUtil {
+
+	FrameArena::FrameArena(size_t capacity) {
+
+		this->capacity = capacity;
+		used = 0;
+		overflow_used = 0;
+
+		if (capacity > 0) {
+
+			block.reset(new unsigned char[capacity]);
+
+		}
+
+	}
+
+	void FrameArena::reset() {
+
+		if (!overflow_blocks.empty()) {
+
+			// Half again over what the frame needed, so slowly growing frames do not spill every time
+			size_t needed = used + overflow_used;
+			capacity = needed + needed / 2;
+			block.reset(new unsigned char[capacity]);
+			overflow_blocks.clear();
+
+		}
+
+		used = 0;
+		overflow_used = 0;
+
+	}
+
+	void* FrameArena::allocate(size_t size, size_t alignment) {
+
+		uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+		size_t offset = ((base + used + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+
+		if (block && offset + size <= capacity) {
+
+			used = offset + size;
+			return block.get() + offset;
+
+		}
+
+		// Padded so the start can be aligned within it
+		overflow_blocks.emplace_back(new unsigned char[size + alignment]);
+		overflow_used += size + alignment;
+
+		uintptr_t overflow_base = reinterpret_cast<uintptr_t>(overflow_blocks.back().get());
+		return reinterpret_cast<void*>((overflow_base + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+
+	}
+
+	size_t FrameArena::getUsed() const {
+
+		return used + overflow_used;
+
+	}
+
+	size_t FrameArena::getCapacity() const {
+
+		return capacity;
+
+	}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include <cstddef>
+
+namespace vkUtil {
+
+	// Bump allocator for data that lives for one frame. Nothing is freed on its own, reset() drops
+	// everything at once. A frame that outgrows the block spills into extra blocks, the next reset
+	// replaces them all with one block big enough for that frame.
+	class FrameArena {
+
+	public:
+
+		FrameArena(size_t capacity = 0);
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+		FrameArena(FrameArena&&) = default;
+		FrameArena& operator=(FrameArena&&) = default;
+
+		// Invalidates every pointer handed out since the last reset
+		void reset();
+
+		void* allocate(size_t size, size_t alignment);
+
+		// Uninitialized, only for types that need no destructor
+		template<typename T>
+		T* allocateArray(size_t count) {
+
+			static_assert(std::is_trivially_destructible<T>::value, "Arena memory is never destroyed");
+			return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+
+		}
+
+		size_t getUsed() const;
+		size_t getCapacity() const;
+
+	private:
+
+		std::unique_ptr<unsigned char[]> block;
+		size_t capacity;
+		size_t used;
+
+		// Spilled allocations of this frame, each in a block of its own
+		std::vector<std::unique_ptr<unsigned char[]>> overflow_blocks;
+		size_t overflow_used;
+
+	};
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 #include "Frame.hpp"
 #include <vector>
 
@@ -18,7 +19,7 @@ namespace vkInit {
 
 		for (int i = 0; i < frames.size(); ++i) {
 
-			std::vector<vk::ImageView> attachements = { frames[i].image_view };
+			std::vector<vk::ImageView> attachements = { frames[i].image_view, frames[i].depth_buffer_view };
 			vk::FramebufferCreateInfo framebuffer_info = {};
 
 			framebuffer_info.flags = vk::FramebufferCreateFlags();
@@ -31,7 +32,7 @@ namespace vkInit {
 
 			try {
 
-				frames[i].framebuffer = input_chunk.logical_device.createFramebuffer(framebuffer_info);
+				frames[i].framebuffer = input_chunk.logical_device.createFramebuffer(framebuffer_info, vkUtil::hostAllocator());
 
 			}
 			catch(vk::SystemError err){
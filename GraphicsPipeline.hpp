@@ -2,44 +2,42 @@
 
 #include "Shaders/Shaders.h"
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 #include <iostream>
+#include <algorithm>
 #include "RenderStructs.hpp"
+#include "PipelineState.hpp"
+#include "PipelineManager.hpp"
+#include "ShaderReflection.hpp"
+#include "DescriptorSetLayoutCache.hpp"
 
 namespace vkInit {
 
 	struct GraphicsPipelineInBundle {
 
 		vk::Device logical_device;
-		std::string vertex_file_path;
-		std::string fragment_file_path;
-		vk::Extent2D swapchain_extent;
-		vk::Format swapchain_image_format;
+		vkUtil::ShaderCompiler* shader_compiler;
+		vkUtil::DescriptorSetLayoutCache* layout_cache;
+		// Supplies the pipeline's layout and render pass, its cache objects outlive the pipeline
+		vkUtil::PipelineManager* pipeline_manager;
+		vk::PipelineCache pipeline_cache;
+		GraphicsPipelineState state;
 
 	};
 
-	struct GraphicsPipelineOutBundle {
-
-		vk::PipelineLayout layout;
-		vk::RenderPass render_pass;
-		vk::Pipeline pipeline;
-
-	};
-
-	vk::PipelineLayout makePipelineLayout(vk::Device logical_device) {
+	vk::PipelineLayout makePipelineLayout(vk::Device logical_device, const std::vector<vk::DescriptorSetLayout>& descriptor_set_layouts,
+										  const std::vector<vk::PushConstantRange>& push_constant_ranges) {
 
 		vk::PipelineLayoutCreateInfo layout_info = {};
 		layout_info.flags = vk::PipelineLayoutCreateFlags();
-		layout_info.setLayoutCount = 0;
-		layout_info.pushConstantRangeCount = 1;
-		vk::PushConstantRange push_constant_info = {};
-		push_constant_info.offset = 0;
-		push_constant_info.size = sizeof(vkUtil::ObjectData);
-		push_constant_info.stageFlags = vk::ShaderStageFlagBits::eVertex;
-		layout_info.pPushConstantRanges = &push_constant_info;
+		layout_info.setLayoutCount = static_cast<uint32_t>(descriptor_set_layouts.size());
+		layout_info.pSetLayouts = descriptor_set_layouts.data();
+		layout_info.pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size());
+		layout_info.pPushConstantRanges = push_constant_ranges.data();
 
 		try {
 
-			return logical_device.createPipelineLayout(layout_info);
+			return logical_device.createPipelineLayout(layout_info, vkUtil::hostAllocator());
 
 		}
 		catch(vk::SystemError err){
@@ -48,192 +46,526 @@ namespace vkInit {
 
 		}
 
+		return nullptr;
+
+	}
+
+	// Compiles a stage with the permutation's defines and adds what it declares to the reflection. Empty if it doesn't
+	// compile, disagrees with an earlier stage or lacks a constant the permutation specializes
+	std::vector<uint32_t> compileReflected(vkUtil::ShaderCompiler& compiler, const std::string& file_path, const vkUtil::ShaderPermutation& permutation,
+										   vk::ShaderStageFlagBits stage, vkUtil::ShaderReflection& reflection) {
+
+		std::vector<uint32_t> code = compiler.compile(file_path, permutation.defines);
+		std::string error;
+
+		if (!code.empty() && !vkUtil::reflectShader(code, stage, reflection, error)) {
+
+			std::cerr << "\"" << file_path << "\": " << error << std::endl;
+			code.clear();
+
+		}
+
+		for (const vkUtil::SpecializationConstant& constant : permutation.constants) {
+
+			// Vulkan ignores ids a shader doesn't declare, here they are more likely a typo
+			if (!code.empty() && !reflection.declaresConstant(stage, constant.id)) {
+
+				std::cerr << "\"" << file_path << "\": no specialization constant " << constant.id << std::endl;
+				code.clear();
+
+			}
+
+		}
+
+		return code;
+
+	}
+
+	// What a stage's pSpecializationInfo points to, it has to stay put until the pipeline is created
+	struct SpecializationData {
+
+		std::vector<vk::SpecializationMapEntry> entries;
+		std::vector<uint32_t> values;
+		vk::SpecializationInfo info;
+
+	};
+
+	void makeSpecializationInfo(const vkUtil::ShaderPermutation& permutation, SpecializationData& data) {
+
+		for (const vkUtil::SpecializationConstant& constant : permutation.constants) {
+
+			data.entries.push_back(vk::SpecializationMapEntry(constant.id, static_cast<uint32_t>(sizeof(uint32_t) * data.values.size()), sizeof(uint32_t)));
+			data.values.push_back(constant.value);
+
+		}
+
+		data.info.mapEntryCount = static_cast<uint32_t>(data.entries.size());
+		data.info.pMapEntries = data.entries.data();
+		data.info.dataSize = sizeof(uint32_t) * data.values.size();
+		data.info.pData = data.values.data();
+
+	}
+
+	// Fills in the layouts the caller left out, and checks every binding the shaders declare against the ones it
+	// provided: same type and count, visible to the stages that use it. False on a mismatch
+	bool resolveSetLayouts(const std::string& name, vkUtil::DescriptorSetLayoutCache& layout_cache, const vkUtil::ShaderReflection& reflection,
+						   std::vector<vk::DescriptorSetLayout>& descriptor_set_layouts) {
+
+		if (descriptor_set_layouts.size() < reflection.getSetCount()) {
+
+			descriptor_set_layouts.resize(reflection.getSetCount(), nullptr);
+
+		}
+
+		for (uint32_t set = 0; set < descriptor_set_layouts.size(); ++set) {
+
+			std::vector<vk::DescriptorSetLayoutBinding> reflected = reflection.getSetBindings(set);
+
+			if (!descriptor_set_layouts[set]) {
+
+				descriptor_set_layouts[set] = layout_cache.get(reflected);
+
+				if (!descriptor_set_layouts[set]) {
+
+					return false;
+
+				}
+
+				continue;
+
+			}
+
+			std::vector<vk::DescriptorSetLayoutBinding> provided;
+
+			// Layouts made outside the cache can't be checked
+			if (!layout_cache.getBindings(descriptor_set_layouts[set], provided)) {
+
+				continue;
+
+			}
+
+			for (const vk::DescriptorSetLayoutBinding& binding : reflected) {
+
+				auto match = std::find_if(provided.begin(), provided.end(), [&binding](const vk::DescriptorSetLayoutBinding& candidate) {
+
+					return candidate.binding == binding.binding;
+
+				});
+
+				if (match == provided.end() || match->descriptorType != binding.descriptorType || match->descriptorCount != binding.descriptorCount ||
+					(match->stageFlags & binding.stageFlags) != binding.stageFlags) {
+
+					std::cerr << "\"" << name << "\": set " << set << " binding " << binding.binding << " (" << vk::to_string(binding.descriptorType)
+						<< "[" << binding.descriptorCount << "], " << vk::to_string(binding.stageFlags) << ") doesn't match the layout it is bound with" << std::endl;
+					return false;
+
+				}
+
+			}
+
+		}
+
+		return true;
+
 	}
 
-	vk::RenderPass makeRenderPass(vk::Device logical_device, vk::Format swapchain_image_format) {
+	// Uses the attributes given, after checking the shader's inputs against them, or the reflected ones. False on a mismatch
+	bool resolveVertexAttributes(const std::string& name, const vkUtil::ShaderReflection& reflection, const std::vector<vk::VertexInputBindingDescription>& bindings,
+								 std::vector<vk::VertexInputAttributeDescription>& attributes) {
+
+		if (attributes.empty()) {
+
+			attributes = reflection.vertex_inputs;
+
+		}
+
+		for (const vk::VertexInputAttributeDescription& input : reflection.vertex_inputs) {
+
+			auto match = std::find_if(attributes.begin(), attributes.end(), [&input](const vk::VertexInputAttributeDescription& candidate) {
+
+				return candidate.location == input.location;
+
+			});
+
+			if (match == attributes.end() || match->format != input.format || bindings.empty()) {
+
+				std::cerr << "\"" << name << "\": vertex input at location " << input.location << " (" << vk::to_string(input.format)
+					<< ") isn't fed by the vertex input state" << std::endl;
+				return false;
+
+			}
+
+		}
+
+		return true;
+
+	}
+
+	vk::RenderPass makeRenderPass(vk::Device logical_device, vk::Format swapchain_image_format, vk::Format depth_format, bool depth_prepass,
+								  RenderPassStage stage) {
+
+		bool continues = stage == RenderPassStage::eLast;
+		bool presents = stage != RenderPassStage::eFirst;
 
 		vk::AttachmentDescription color_attachment = {};
 		color_attachment.flags = vk::AttachmentDescriptionFlags();
 		color_attachment.format = swapchain_image_format;
 		color_attachment.samples = vk::SampleCountFlagBits::e1;
-		color_attachment.loadOp = vk::AttachmentLoadOp::eClear;
+		color_attachment.loadOp = continues ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear;
 		color_attachment.storeOp = vk::AttachmentStoreOp::eStore;
 		color_attachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
 		color_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-		color_attachment.initialLayout = vk::ImageLayout::eUndefined;
-		color_attachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+		color_attachment.initialLayout = continues ? vk::ImageLayout::eColorAttachmentOptimal : vk::ImageLayout::eUndefined;
+		color_attachment.finalLayout = presents ? vk::ImageLayout::ePresentSrcKHR : vk::ImageLayout::eColorAttachmentOptimal;
 
 		vk::AttachmentReference color_attachment_refrence = {};
 		color_attachment_refrence.attachment = 0;
 		color_attachment_refrence.layout = vk::ImageLayout::eColorAttachmentOptimal;
 
+		vk::AttachmentDescription depth_attachment = {};
+		depth_attachment.flags = vk::AttachmentDescriptionFlags();
+		depth_attachment.format = depth_format;
+		depth_attachment.samples = vk::SampleCountFlagBits::e1;
+		depth_attachment.loadOp = continues ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear;
+		// Split passes keep depth around to be continued or reduced into the depth pyramid
+		depth_attachment.storeOp = stage == RenderPassStage::eOnly ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore;
+		depth_attachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
+		depth_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+		depth_attachment.initialLayout = continues ? vk::ImageLayout::eDepthStencilAttachmentOptimal : vk::ImageLayout::eUndefined;
+		depth_attachment.finalLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+
+		vk::AttachmentReference depth_attachment_refrence = {};
+		depth_attachment_refrence.attachment = 1;
+		depth_attachment_refrence.layout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+
+		std::array<vk::AttachmentDescription, 2> attachments = { color_attachment, depth_attachment };
+
+		std::vector<vk::SubpassDescription> subpasses;
+
+		if (depth_prepass) {
+
+			vk::SubpassDescription depth_subpass = {};
+			depth_subpass.flags = vk::SubpassDescriptionFlags();
+			depth_subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
+			depth_subpass.colorAttachmentCount = 0;
+			depth_subpass.pDepthStencilAttachment = &depth_attachment_refrence;
+			subpasses.push_back(depth_subpass);
+
+		}
+
 		vk::SubpassDescription subpass = {};
 		subpass.flags = vk::SubpassDescriptionFlags();
 		subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
 		subpass.colorAttachmentCount = 1;
 		subpass.pColorAttachments = &color_attachment_refrence;
+		subpass.pDepthStencilAttachment = &depth_attachment_refrence;
+		subpasses.push_back(subpass);
+
+		std::vector<vk::SubpassDependency> dependencies;
+
+		// Wait for the swapchain image and for the depth buffer's previous use before writing either
+		vk::SubpassDependency dependency = {};
+		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependency.dstSubpass = 0;
+		dependency.srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests;
+		dependency.srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+		dependency.dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests;
+		dependency.dstAccessMask = vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+		dependencies.push_back(dependency);
+
+		if (depth_prepass) {
+
+			// The shading subpass tests against the depth laid down by the pre-pass
+			vk::SubpassDependency prepass_dependency = {};
+			prepass_dependency.srcSubpass = 0;
+			prepass_dependency.dstSubpass = 1;
+			prepass_dependency.srcStageMask = vk::PipelineStageFlagBits::eLateFragmentTests;
+			prepass_dependency.srcAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+			prepass_dependency.dstStageMask = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+			prepass_dependency.dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead;
+			prepass_dependency.dependencyFlags = vk::DependencyFlagBits::eByRegion;
+			dependencies.push_back(prepass_dependency);
+
+		}
 
 		vk::RenderPassCreateInfo render_pass_info = {};
 		render_pass_info.flags = vk::RenderPassCreateFlags();
-		render_pass_info.attachmentCount = 1;
-		render_pass_info.pAttachments = &color_attachment;
-		render_pass_info.subpassCount = 1;
-		render_pass_info.pSubpasses = &subpass;
+		render_pass_info.attachmentCount = static_cast<uint32_t>(attachments.size());
+		render_pass_info.pAttachments = attachments.data();
+		render_pass_info.subpassCount = static_cast<uint32_t>(subpasses.size());
+		render_pass_info.pSubpasses = subpasses.data();
+		render_pass_info.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		render_pass_info.pDependencies = dependencies.data();
 
 		try {
 
-			return logical_device.createRenderPass(render_pass_info);
+			return logical_device.createRenderPass(render_pass_info, vkUtil::hostAllocator());
 
 		}
 		catch (vk::SystemError err) {
 
-			std::cerr << "Failed to create rander pass!" << std::endl;
+			std::cerr << "Failed to create render pass!" << std::endl;
 
 		}
 
+		return nullptr;
+
 	}
 
-	GraphicsPipelineOutBundle makeGraphicsPipeline(bool debug, GraphicsPipelineInBundle specification) {
+	// Both stages compiled and reflected, with the state's descriptor set layouts and vertex attributes resolved
+	struct GraphicsShaders {
 
-		vk::GraphicsPipelineCreateInfo graphics_pipeline_info = {};
+		std::vector<uint32_t> vertex_code;
+		std::vector<uint32_t> fragment_code;
+		vkUtil::ShaderReflection reflection;
+		bool valid;
 
-		graphics_pipeline_info.flags = vk::PipelineCreateFlags();
+	};
 
-		std::vector<vk::PipelineShaderStageCreateInfo> shader_stages;
+	void compileGraphicsShaders(GraphicsPipelineInBundle& specification, GraphicsShaders& shaders) {
 
-		/// FIRST STAGE: | VERTEX INPUT |
+		GraphicsPipelineState& state = specification.state;
+		bool depth_only = state.fragment_file_path.empty();
 
-		vk::PipelineVertexInputStateCreateInfo vertex_input_info = {};
+		shaders.reflection = {};
+		shaders.vertex_code = compileReflected(*specification.shader_compiler, state.vertex_file_path, state.vertex_permutation,
+											   vk::ShaderStageFlagBits::eVertex, shaders.reflection);
+		shaders.fragment_code.clear();
 
-		vertex_input_info.flags = vk::PipelineVertexInputStateCreateFlags();
-		vertex_input_info.vertexAttributeDescriptionCount = 0;
-		vertex_input_info.vertexBindingDescriptionCount = 0;
-		graphics_pipeline_info.pVertexInputState = &vertex_input_info;
+		if (!depth_only) {
 
-		/// SECOND STAGE: | INPUT ASSEMBLY |
+			shaders.fragment_code = compileReflected(*specification.shader_compiler, state.fragment_file_path, state.fragment_permutation,
+													 vk::ShaderStageFlagBits::eFragment, shaders.reflection);
+
+		}
 
-		vk::PipelineInputAssemblyStateCreateInfo input_assembly_info = {};
+		// Failed shaders, or shaders that don't fit the engine's layouts, leave the pipeline null
+		shaders.valid = !shaders.vertex_code.empty() && (depth_only || !shaders.fragment_code.empty()) &&
+			resolveSetLayouts(state.vertex_file_path, *specification.layout_cache, shaders.reflection, state.descriptor_set_layouts) &&
+			resolveVertexAttributes(state.vertex_file_path, shaders.reflection, state.vertex_bindings, state.vertex_attributes);
 
-		input_assembly_info.flags = vk::PipelineInputAssemblyStateCreateFlags();
-		input_assembly_info.topology = vk::PrimitiveTopology::eTriangleList;
-		graphics_pipeline_info.pInputAssemblyState = &input_assembly_info;
+	}
+
+	// Everything of a graphics pipeline but its shaders, layout and render pass. It points into itself, so it is
+	// filled in where it stays until the pipeline is created
+	struct FixedFunctionState {
+
+		vk::PipelineVertexInputStateCreateInfo vertex_input_info;
+		vk::PipelineInputAssemblyStateCreateInfo input_assembly_info;
+		vk::Viewport viewport;
+		vk::Rect2D scissor;
+		vk::PipelineViewportStateCreateInfo viewport_info;
+		vk::PipelineRasterizationStateCreateInfo rasterization_info;
+		vk::PipelineMultisampleStateCreateInfo multisampling_info;
+		vk::PipelineDepthStencilStateCreateInfo depth_stencil_info;
+		vk::PipelineColorBlendAttachmentState color_blend_attachment;
+		vk::PipelineColorBlendStateCreateInfo color_blend_info;
+
+	};
+
+	void makeFixedFunctionState(const GraphicsPipelineState& state, FixedFunctionState& fixed) {
+
+		// Depth-only pipelines have no fragment shader and no color output
+		bool depth_only = state.fragment_file_path.empty();
+
+		/// FIRST STAGE: | VERTEX INPUT |
+
+		fixed.vertex_input_info = vk::PipelineVertexInputStateCreateInfo();
+		fixed.vertex_input_info.flags = vk::PipelineVertexInputStateCreateFlags();
+		fixed.vertex_input_info.vertexBindingDescriptionCount = static_cast<uint32_t>(state.vertex_bindings.size());
+		fixed.vertex_input_info.pVertexBindingDescriptions = state.vertex_bindings.data();
+		fixed.vertex_input_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(state.vertex_attributes.size());
+		fixed.vertex_input_info.pVertexAttributeDescriptions = state.vertex_attributes.data();
 
-		/// THIRD STAGE: | VERTEX SHADER |
+		/// SECOND STAGE: | INPUT ASSEMBLY |
 
-		vk::ShaderModule vertex_shader_module = vkUtil::createShaderModule(debug, specification.vertex_file_path, specification.logical_device);
-		vk::PipelineShaderStageCreateInfo vertex_shader_info = {};
-		vertex_shader_info.flags = vk::PipelineShaderStageCreateFlags();
-		vertex_shader_info.stage = vk::ShaderStageFlagBits::eVertex;
-		vertex_shader_info.module = vertex_shader_module;
-		vertex_shader_info.pName = "main";
-		shader_stages.push_back(vertex_shader_info);
+		fixed.input_assembly_info = vk::PipelineInputAssemblyStateCreateInfo();
+		fixed.input_assembly_info.flags = vk::PipelineInputAssemblyStateCreateFlags();
+		fixed.input_assembly_info.topology = vk::PrimitiveTopology::eTriangleList;
 
 		/// FOURTH STAGE: | VIEWPORT AND SCISSOR
 
-		vk::Viewport viewport = {};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
+		fixed.viewport = vk::Viewport();
+		fixed.viewport.x = 0.0f;
+		fixed.viewport.y = 0.0f;
 
-		viewport.width = specification.swapchain_extent.width;
-		viewport.height = specification.swapchain_extent.height;
+		fixed.viewport.width = state.swapchain_extent.width;
+		fixed.viewport.height = state.swapchain_extent.height;
 
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
+		fixed.viewport.minDepth = 0.0f;
+		fixed.viewport.maxDepth = 1.0f;
 
-		vk::Rect2D scissor = {};
-		scissor.offset.x = 0.0f;
-		scissor.offset.y = 0.0f;
-		scissor.extent = specification.swapchain_extent;
-		vk::PipelineViewportStateCreateInfo viewport_info = {};
-		viewport_info.flags = vk::PipelineViewportStateCreateFlags();
-		viewport_info.viewportCount = 1;
-		viewport_info.pViewports = &viewport;
-		viewport_info.scissorCount = 1;
-		viewport_info.pScissors = &scissor;
+		fixed.scissor = vk::Rect2D();
+		fixed.scissor.offset.x = 0.0f;
+		fixed.scissor.offset.y = 0.0f;
+		fixed.scissor.extent = state.swapchain_extent;
 
-		graphics_pipeline_info.pViewportState = &viewport_info;
+		fixed.viewport_info = vk::PipelineViewportStateCreateInfo();
+		fixed.viewport_info.flags = vk::PipelineViewportStateCreateFlags();
+		fixed.viewport_info.viewportCount = 1;
+		fixed.viewport_info.pViewports = &fixed.viewport;
+		fixed.viewport_info.scissorCount = 1;
+		fixed.viewport_info.pScissors = &fixed.scissor;
 
 		/// FIFTH STAGE: | Rasterization |
 
-		vk::PipelineRasterizationStateCreateInfo rasterization_info = {};
-		rasterization_info.flags = vk::PipelineRasterizationStateCreateFlags();
-		rasterization_info.depthClampEnable = VK_FALSE;
-		rasterization_info.rasterizerDiscardEnable = VK_FALSE;
-		rasterization_info.polygonMode = vk::PolygonMode::eFill;
-		rasterization_info.lineWidth = 1.0f;
-		rasterization_info.cullMode = vk::CullModeFlagBits::eBack;
-		rasterization_info.frontFace = vk::FrontFace::eClockwise;
-		rasterization_info.depthBiasEnable = VK_FALSE;
-		graphics_pipeline_info.pRasterizationState = &rasterization_info;
-
-		/// SIXTH STAGE: | FRAGMENT SHADER |
-
-		vk::ShaderModule fragment_shader_module = vkUtil::createShaderModule(debug, specification.fragment_file_path, specification.logical_device);
-		vk::PipelineShaderStageCreateInfo fragment_shader_info = {};
-		fragment_shader_info.flags = vk::PipelineShaderStageCreateFlags();
-		fragment_shader_info.stage = vk::ShaderStageFlagBits::eFragment;
-		fragment_shader_info.module = fragment_shader_module;
-		fragment_shader_info.pName = "main";
-		shader_stages.push_back(fragment_shader_info);
-
-		graphics_pipeline_info.stageCount = shader_stages.size();
-		graphics_pipeline_info.pStages = shader_stages.data();
+		fixed.rasterization_info = vk::PipelineRasterizationStateCreateInfo();
+		fixed.rasterization_info.flags = vk::PipelineRasterizationStateCreateFlags();
+		fixed.rasterization_info.depthClampEnable = VK_FALSE;
+		fixed.rasterization_info.rasterizerDiscardEnable = VK_FALSE;
+		fixed.rasterization_info.polygonMode = vk::PolygonMode::eFill;
+		fixed.rasterization_info.lineWidth = 1.0f;
+		fixed.rasterization_info.cullMode = state.cull_mode;
+		fixed.rasterization_info.frontFace = vk::FrontFace::eClockwise;
+		fixed.rasterization_info.depthBiasEnable = VK_FALSE;
 
 		/// SEVENTH STAGE: | MULTISAMPLING |
 
-		vk::PipelineMultisampleStateCreateInfo multisampling_info = {};
-		multisampling_info.flags = vk::PipelineMultisampleStateCreateFlags();
-		multisampling_info.sampleShadingEnable = VK_FALSE;
-		multisampling_info.rasterizationSamples = vk::SampleCountFlagBits::e1;
+		fixed.multisampling_info = vk::PipelineMultisampleStateCreateInfo();
+		fixed.multisampling_info.flags = vk::PipelineMultisampleStateCreateFlags();
+		fixed.multisampling_info.sampleShadingEnable = VK_FALSE;
+		fixed.multisampling_info.rasterizationSamples = vk::SampleCountFlagBits::e1;
 
-		graphics_pipeline_info.pMultisampleState = &multisampling_info;
+		/// DEPTH TEST
+
+		fixed.depth_stencil_info = vk::PipelineDepthStencilStateCreateInfo();
+		fixed.depth_stencil_info.flags = vk::PipelineDepthStencilStateCreateFlags();
+		fixed.depth_stencil_info.depthTestEnable = state.depth_test;
+		fixed.depth_stencil_info.depthWriteEnable = state.depth_write;
+		fixed.depth_stencil_info.depthCompareOp = state.depth_compare_op;
+		fixed.depth_stencil_info.depthBoundsTestEnable = VK_FALSE;
+		fixed.depth_stencil_info.stencilTestEnable = VK_FALSE;
 
 		/// EIGHTH STAGE: | COLOR BLEND |
 
-		vk::PipelineColorBlendAttachmentState color_blend_attachment = {};
-		color_blend_attachment.colorWriteMask = vk::ColorComponentFlagBits::eR |
-											    vk::ColorComponentFlagBits::eG |
-			                                    vk::ColorComponentFlagBits::eB |
-			                                    vk::ColorComponentFlagBits::eA ;
-		color_blend_attachment.blendEnable = VK_FALSE;
-
-		vk::PipelineColorBlendStateCreateInfo color_blend_info = {};
-		color_blend_info.flags = vk::PipelineColorBlendStateCreateFlags();
-		color_blend_info.logicOpEnable = VK_FALSE;
-		color_blend_info.logicOp = vk::LogicOp::eCopy;
-		color_blend_info.attachmentCount = 1;
-		color_blend_info.pAttachments = &color_blend_attachment;
-		color_blend_info.blendConstants[0] = 0.0f;
-		color_blend_info.blendConstants[1] = 0.0f;
-		color_blend_info.blendConstants[2] = 0.0f;
-		color_blend_info.blendConstants[3] = 0.0f;
-
-		graphics_pipeline_info.pColorBlendState = &color_blend_info;
+		fixed.color_blend_attachment = vk::PipelineColorBlendAttachmentState();
+		fixed.color_blend_attachment.colorWriteMask = vk::ColorComponentFlagBits::eR |
+													  vk::ColorComponentFlagBits::eG |
+													  vk::ColorComponentFlagBits::eB |
+													  vk::ColorComponentFlagBits::eA ;
+		fixed.color_blend_attachment.blendEnable = state.blend;
+		// Straight alpha over what is already there
+		fixed.color_blend_attachment.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+		fixed.color_blend_attachment.dstColorBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+		fixed.color_blend_attachment.colorBlendOp = vk::BlendOp::eAdd;
+		fixed.color_blend_attachment.srcAlphaBlendFactor = vk::BlendFactor::eOne;
+		fixed.color_blend_attachment.dstAlphaBlendFactor = vk::BlendFactor::eOneMinusSrcAlpha;
+		fixed.color_blend_attachment.alphaBlendOp = vk::BlendOp::eAdd;
+
+		fixed.color_blend_info = vk::PipelineColorBlendStateCreateInfo();
+		fixed.color_blend_info.flags = vk::PipelineColorBlendStateCreateFlags();
+		fixed.color_blend_info.logicOpEnable = VK_FALSE;
+		fixed.color_blend_info.logicOp = vk::LogicOp::eCopy;
+		fixed.color_blend_info.attachmentCount = depth_only ? 0 : 1;
+		fixed.color_blend_info.pAttachments = &fixed.color_blend_attachment;
+		fixed.color_blend_info.blendConstants[0] = 0.0f;
+		fixed.color_blend_info.blendConstants[1] = 0.0f;
+		fixed.color_blend_info.blendConstants[2] = 0.0f;
+		fixed.color_blend_info.blendConstants[3] = 0.0f;
+
+	}
+
+	vk::PipelineShaderStageCreateInfo makeShaderStage(vk::ShaderStageFlagBits stage, vk::ShaderModule shader_module, const SpecializationData& specialization) {
+
+		vk::PipelineShaderStageCreateInfo shader_info = {};
+		shader_info.flags = vk::PipelineShaderStageCreateFlags();
+		shader_info.stage = stage;
+		shader_info.module = shader_module;
+		shader_info.pName = "main";
+		shader_info.pSpecializationInfo = &specialization.info;
+
+		return shader_info;
+
+	}
+
+	GraphicsPipelineOutBundle makeGraphicsPipeline(bool debug, GraphicsPipelineInBundle specification) {
+
+		GraphicsPipelineState& state = specification.state;
+		bool depth_only = state.fragment_file_path.empty();
+
+		GraphicsShaders shaders;
+		compileGraphicsShaders(specification, shaders);
+
+		FixedFunctionState fixed;
+		makeFixedFunctionState(state, fixed);
+
+		/// THIRD AND SIXTH STAGES: | VERTEX AND FRAGMENT SHADERS |
+
+		vk::ShaderModule vertex_shader_module = nullptr;
+		vk::ShaderModule fragment_shader_module = nullptr;
+
+		if (shaders.valid) {
+
+			vertex_shader_module = vkUtil::createShaderModule(debug, shaders.vertex_code, state.vertex_file_path, specification.logical_device);
+
+			if (!depth_only) {
+
+				fragment_shader_module = vkUtil::createShaderModule(debug, shaders.fragment_code, state.fragment_file_path, specification.logical_device);
+
+			}
+
+		}
+
+		SpecializationData vertex_specialization;
+		makeSpecializationInfo(state.vertex_permutation, vertex_specialization);
+		SpecializationData fragment_specialization;
+		makeSpecializationInfo(state.fragment_permutation, fragment_specialization);
+
+		std::vector<vk::PipelineShaderStageCreateInfo> shader_stages = {
+			makeShaderStage(vk::ShaderStageFlagBits::eVertex, vertex_shader_module, vertex_specialization)
+		};
+
+		if (!depth_only) {
+
+			shader_stages.push_back(makeShaderStage(vk::ShaderStageFlagBits::eFragment, fragment_shader_module, fragment_specialization));
+
+		}
 
 		/// PIPELINE LAYOUT
 
-		vk::PipelineLayout pipeline_layout = makePipelineLayout(specification.logical_device);
-		graphics_pipeline_info.layout = pipeline_layout;
+		vk::PipelineLayout pipeline_layout = nullptr;
 
+		if (shaders.valid) {
+
+			pipeline_layout = specification.pipeline_manager->getPipelineLayout(state.descriptor_set_layouts, shaders.reflection.push_constants);
+
+		}
 
 		/// RENDER PASS
 
-		vk::RenderPass render_pass = makeRenderPass(specification.logical_device, specification.swapchain_image_format);
+		vk::RenderPass render_pass = specification.pipeline_manager->getRenderPass(state.swapchain_image_format, state.depth_format, state.depth_prepass,
+																				   state.render_pass_stage);
+
+		vk::GraphicsPipelineCreateInfo graphics_pipeline_info = {};
+		graphics_pipeline_info.flags = vk::PipelineCreateFlags();
+		graphics_pipeline_info.stageCount = static_cast<uint32_t>(shader_stages.size());
+		graphics_pipeline_info.pStages = shader_stages.data();
+		graphics_pipeline_info.pVertexInputState = &fixed.vertex_input_info;
+		graphics_pipeline_info.pInputAssemblyState = &fixed.input_assembly_info;
+		graphics_pipeline_info.pViewportState = &fixed.viewport_info;
+		graphics_pipeline_info.pRasterizationState = &fixed.rasterization_info;
+		graphics_pipeline_info.pMultisampleState = &fixed.multisampling_info;
+		graphics_pipeline_info.pDepthStencilState = &fixed.depth_stencil_info;
+		graphics_pipeline_info.pColorBlendState = &fixed.color_blend_info;
+		graphics_pipeline_info.layout = pipeline_layout;
 		graphics_pipeline_info.renderPass = render_pass;
+		graphics_pipeline_info.subpass = state.subpass;
+		graphics_pipeline_info.basePipelineHandle = nullptr;
 
+		vk::Pipeline graphics_pipeline = nullptr;
 
-		graphics_pipeline_info.basePipelineHandle = nullptr;
+		if (pipeline_layout && vertex_shader_module && (depth_only || fragment_shader_module)) {
 
-		vk::Pipeline graphics_pipeline;
+			try {
 
-		try {
+				graphics_pipeline = (specification.logical_device.createGraphicsPipeline(specification.pipeline_cache, graphics_pipeline_info, vkUtil::hostAllocator())).value;
 
-			graphics_pipeline = (specification.logical_device.createGraphicsPipeline(nullptr, graphics_pipeline_info)).value;
+			}
+			catch (vk::SystemError err) {
 
-		}
-		catch (vk::SystemError err) {
+				std::cerr << "Failed to create graphics pipeline!" << std::endl;
 
-			std::cerr << "Failed to create graphics pipeline!" << std::endl;
+			}
 
 		}
 
@@ -242,10 +574,192 @@ namespace vkInit {
 		output.render_pass = render_pass;
 		output.pipeline = graphics_pipeline;
 
-		specification.logical_device.destroyShaderModule(vertex_shader_module);
-		specification.logical_device.destroyShaderModule(fragment_shader_module);
+		specification.logical_device.destroyShaderModule(vertex_shader_module, vkUtil::hostAllocator());
+		specification.logical_device.destroyShaderModule(fragment_shader_module, vkUtil::hostAllocator());
 		return output;
 
 	}
 
-}
\ No newline at end of file
+	// The share of a resolved state one part's library is built from. States agreeing on it can share the library,
+	// as long as they also agree on the layout for the parts that use one
+	GraphicsPipelineState makeLibraryKey(const GraphicsPipelineState& state, vk::GraphicsPipelineLibraryFlagBitsEXT part) {
+
+		GraphicsPipelineState key = {};
+
+		if (part != vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface) {
+
+			key.swapchain_image_format = state.swapchain_image_format;
+			key.depth_format = state.depth_format;
+			key.depth_prepass = state.depth_prepass;
+			key.render_pass_stage = state.render_pass_stage;
+			key.subpass = state.subpass;
+
+		}
+
+		switch (part) {
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface:
+
+			key.vertex_bindings = state.vertex_bindings;
+			key.vertex_attributes = state.vertex_attributes;
+			break;
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders:
+
+			key.vertex_file_path = state.vertex_file_path;
+			key.vertex_permutation = state.vertex_permutation;
+			key.swapchain_extent = state.swapchain_extent;
+			key.cull_mode = state.cull_mode;
+			break;
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader:
+
+			key.fragment_file_path = state.fragment_file_path;
+			key.fragment_permutation = state.fragment_permutation;
+			key.depth_test = state.depth_test;
+			key.depth_write = state.depth_write;
+			key.depth_compare_op = state.depth_compare_op;
+			break;
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface:
+
+			// Only whether there is a fragment shader matters to the output, not which one
+			key.fragment_file_path = state.fragment_file_path.empty() ? "" : "*";
+			key.blend = state.blend;
+			break;
+
+		}
+
+		return key;
+
+	}
+
+	// Builds the part of a graphics pipeline that one library holds. Libraries keep what link time optimization needs,
+	// so the same ones link into either a quick pipeline or an optimized one
+	vk::Pipeline makePipelineLibrary(bool debug, const GraphicsPipelineInBundle& specification, const GraphicsShaders& shaders,
+									 vk::PipelineLayout layout, vk::RenderPass render_pass, vk::GraphicsPipelineLibraryFlagBitsEXT part) {
+
+		const GraphicsPipelineState& state = specification.state;
+
+		FixedFunctionState fixed;
+		makeFixedFunctionState(state, fixed);
+
+		vk::GraphicsPipelineLibraryCreateInfoEXT library_info = {};
+		library_info.flags = part;
+
+		vk::GraphicsPipelineCreateInfo graphics_pipeline_info = {};
+		graphics_pipeline_info.pNext = &library_info;
+		graphics_pipeline_info.flags = vk::PipelineCreateFlagBits::eLibraryKHR | vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT;
+
+		vk::ShaderModule shader_module = nullptr;
+		SpecializationData specialization;
+		vk::PipelineShaderStageCreateInfo shader_info = {};
+
+		switch (part) {
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface:
+
+			graphics_pipeline_info.pVertexInputState = &fixed.vertex_input_info;
+			graphics_pipeline_info.pInputAssemblyState = &fixed.input_assembly_info;
+			break;
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders:
+
+			shader_module = vkUtil::createShaderModule(debug, shaders.vertex_code, state.vertex_file_path, specification.logical_device);
+			makeSpecializationInfo(state.vertex_permutation, specialization);
+			shader_info = makeShaderStage(vk::ShaderStageFlagBits::eVertex, shader_module, specialization);
+
+			graphics_pipeline_info.stageCount = 1;
+			graphics_pipeline_info.pStages = &shader_info;
+			graphics_pipeline_info.pViewportState = &fixed.viewport_info;
+			graphics_pipeline_info.pRasterizationState = &fixed.rasterization_info;
+			graphics_pipeline_info.layout = layout;
+			break;
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader:
+
+			// A depth-only pipeline's fragment part has no shader, just the depth test
+			if (!shaders.fragment_code.empty()) {
+
+				shader_module = vkUtil::createShaderModule(debug, shaders.fragment_code, state.fragment_file_path, specification.logical_device);
+				makeSpecializationInfo(state.fragment_permutation, specialization);
+				shader_info = makeShaderStage(vk::ShaderStageFlagBits::eFragment, shader_module, specialization);
+
+				graphics_pipeline_info.stageCount = 1;
+				graphics_pipeline_info.pStages = &shader_info;
+
+			}
+
+			graphics_pipeline_info.pMultisampleState = &fixed.multisampling_info;
+			graphics_pipeline_info.pDepthStencilState = &fixed.depth_stencil_info;
+			graphics_pipeline_info.layout = layout;
+			break;
+
+		case vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface:
+
+			graphics_pipeline_info.pMultisampleState = &fixed.multisampling_info;
+			graphics_pipeline_info.pColorBlendState = &fixed.color_blend_info;
+			break;
+
+		}
+
+		if (part != vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface) {
+
+			graphics_pipeline_info.renderPass = render_pass;
+			graphics_pipeline_info.subpass = state.subpass;
+
+		}
+
+		vk::Pipeline library = nullptr;
+
+		if (graphics_pipeline_info.stageCount == 0 || shader_module) {
+
+			try {
+
+				library = (specification.logical_device.createGraphicsPipeline(specification.pipeline_cache, graphics_pipeline_info, vkUtil::hostAllocator())).value;
+
+			}
+			catch (vk::SystemError err) {
+
+				std::cerr << "Failed to create graphics pipeline library!" << std::endl;
+
+			}
+
+		}
+
+		// The library has what it needs from the module, as a pipeline would
+		specification.logical_device.destroyShaderModule(shader_module, vkUtil::hostAllocator());
+		return library;
+
+	}
+
+	// Links one library of each part into a complete pipeline. Without optimization this is quick, the driver mostly
+	// stitches together what the libraries compiled. With it, the whole pipeline is compiled again
+	vk::Pipeline linkPipelineLibraries(vk::Device logical_device, vk::PipelineCache pipeline_cache, const std::array<vk::Pipeline, 4>& libraries,
+									   vk::PipelineLayout layout, bool optimize) {
+
+		vk::PipelineLibraryCreateInfoKHR linking_info = {};
+		linking_info.libraryCount = static_cast<uint32_t>(libraries.size());
+		linking_info.pLibraries = libraries.data();
+
+		vk::GraphicsPipelineCreateInfo graphics_pipeline_info = {};
+		graphics_pipeline_info.pNext = &linking_info;
+		graphics_pipeline_info.flags = optimize ? vk::PipelineCreateFlags(vk::PipelineCreateFlagBits::eLinkTimeOptimizationEXT) : vk::PipelineCreateFlags();
+		graphics_pipeline_info.layout = layout;
+
+		try {
+
+			return (logical_device.createGraphicsPipeline(pipeline_cache, graphics_pipeline_info, vkUtil::hostAllocator())).value;
+
+		}
+		catch (vk::SystemError err) {
+
+			std::cerr << "Failed to link graphics pipeline!" << std::endl;
+
+		}
+
+		return nullptr;
+
+	}
+
+}
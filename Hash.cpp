@@ -0,0 +1,27 @@
+#include "Hash.hpp"
+
+namespace vkUtil {
+
+	uint64_t hashBytes(const void* data, size_t size, uint64_t hash) {
+
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+		for (size_t i = 0; i < size; ++i) {
+
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ull;
+
+		}
+
+		return hash;
+
+	}
+
+	uint64_t hashString(const std::string& text, uint64_t hash) {
+
+		hash = hashValue(static_cast<uint64_t>(text.size()), hash);
+		return hashBytes(text.data(), text.size(), hash);
+
+	}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace vkUtil {
+
+	// FNV-1a, for every cache keyed by hashed state. Structs are hashed field by field, so padding never
+	// reaches the hash
+	const uint64_t hash_seed = 0xCBF29CE484222325ull;
+
+	uint64_t hashBytes(const void* data, size_t size, uint64_t hash);
+
+	template<typename T>
+	uint64_t hashValue(const T& value, uint64_t hash) {
+
+		return hashBytes(&value, sizeof(value), hash);
+
+	}
+
+	// The length goes in first, so neighbouring strings don't run into each other
+	uint64_t hashString(const std::string& text, uint64_t hash);
+
+}
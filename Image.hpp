@@ -0,0 +1,171 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
+#include <iostream>
+#include <vector>
+#include "Memory.hpp"
+
+namespace vkUtil {
+
+	struct ImageInput {
+
+		vk::Device logical_device;
+		vk::PhysicalDevice physical_device;
+		uint32_t width, height;
+		uint32_t mip_levels;
+		vk::Format format;
+		vk::ImageTiling tiling;
+		vk::ImageUsageFlags usage;
+		vk::MemoryPropertyFlags memory_properties;
+
+	};
+
+	vk::Image makeImage(const bool& debug, const ImageInput& input) {
+
+		vk::ImageCreateInfo image_info = {};
+		image_info.flags = vk::ImageCreateFlags();
+		image_info.imageType = vk::ImageType::e2D;
+		image_info.extent = vk::Extent3D(input.width, input.height, 1);
+		image_info.mipLevels = std::max(1u, input.mip_levels);
+		image_info.arrayLayers = 1;
+		image_info.format = input.format;
+		image_info.tiling = input.tiling;
+		image_info.initialLayout = vk::ImageLayout::eUndefined;
+		image_info.usage = input.usage;
+		image_info.sharingMode = vk::SharingMode::eExclusive;
+		image_info.samples = vk::SampleCountFlagBits::e1;
+
+		try {
+
+			return input.logical_device.createImage(image_info, vkUtil::hostAllocator());
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to create image" << std::endl;
+
+			}
+
+			return nullptr;
+
+		}
+
+	}
+
+	vk::DeviceMemory makeImageMemory(const bool& debug, const ImageInput& input, vk::Image image) {
+
+		vk::MemoryRequirements memory_requirements = input.logical_device.getImageMemoryRequirements(image);
+
+		vk::MemoryAllocateInfo allocate_info = {};
+		allocate_info.allocationSize = memory_requirements.size;
+		allocate_info.memoryTypeIndex = findMemoryTypeIndex(input.physical_device, memory_requirements.memoryTypeBits, input.memory_properties);
+
+		try {
+
+			vk::DeviceMemory image_memory = input.logical_device.allocateMemory(allocate_info, vkUtil::hostAllocator());
+			input.logical_device.bindImageMemory(image, image_memory, 0);
+			return image_memory;
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to allocate image memory" << std::endl;
+
+			}
+
+			return nullptr;
+
+		}
+
+	}
+
+	vk::ImageView makeImageView(vk::Device logical_device, vk::Image image, vk::Format format, vk::ImageAspectFlags aspect,
+								uint32_t base_mip_level, uint32_t mip_levels) {
+
+		vk::ImageViewCreateInfo create_image_view_info = {};
+		create_image_view_info.image = image;
+		create_image_view_info.viewType = vk::ImageViewType::e2D;
+		create_image_view_info.format = format;
+		create_image_view_info.components.r = vk::ComponentSwizzle::eIdentity;
+		create_image_view_info.components.g = vk::ComponentSwizzle::eIdentity;
+		create_image_view_info.components.b = vk::ComponentSwizzle::eIdentity;
+		create_image_view_info.components.a = vk::ComponentSwizzle::eIdentity;
+		create_image_view_info.subresourceRange.aspectMask = aspect;
+		create_image_view_info.subresourceRange.baseMipLevel = base_mip_level;
+		create_image_view_info.subresourceRange.levelCount = mip_levels;
+		create_image_view_info.subresourceRange.baseArrayLayer = 0;
+		create_image_view_info.subresourceRange.layerCount = 1;
+
+		return logical_device.createImageView(create_image_view_info, vkUtil::hostAllocator());
+
+	}
+
+	vk::Sampler makeSampler(const bool& debug, vk::Device logical_device, vk::Filter filter, vk::SamplerMipmapMode mipmap_mode,
+							vk::SamplerAddressMode address_mode) {
+
+		vk::SamplerCreateInfo sampler_info = {};
+		sampler_info.flags = vk::SamplerCreateFlags();
+		sampler_info.magFilter = filter;
+		sampler_info.minFilter = filter;
+		sampler_info.mipmapMode = mipmap_mode;
+		sampler_info.addressModeU = address_mode;
+		sampler_info.addressModeV = address_mode;
+		sampler_info.addressModeW = address_mode;
+		sampler_info.anisotropyEnable = VK_FALSE;
+		sampler_info.compareEnable = VK_FALSE;
+		sampler_info.minLod = 0.0f;
+		sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+		sampler_info.borderColor = vk::BorderColor::eFloatOpaqueWhite;
+		sampler_info.unnormalizedCoordinates = VK_FALSE;
+
+		try {
+
+			return logical_device.createSampler(sampler_info, vkUtil::hostAllocator());
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to create sampler" << std::endl;
+
+			}
+
+			return nullptr;
+
+		}
+
+	}
+
+	vk::Format findSupportedFormat(vk::PhysicalDevice physical_device, const std::vector<vk::Format>& candidates,
+								   vk::ImageTiling tiling, vk::FormatFeatureFlags features) {
+
+		for (vk::Format format : candidates) {
+
+			vk::FormatProperties properties = physical_device.getFormatProperties(format);
+
+			if (tiling == vk::ImageTiling::eLinear && (properties.linearTilingFeatures & features) == features) {
+
+				return format;
+
+			}
+
+			if (tiling == vk::ImageTiling::eOptimal && (properties.optimalTilingFeatures & features) == features) {
+
+				return format;
+
+			}
+
+		}
+
+		std::cerr << "Unable to find a suitable format" << std::endl;
+		return candidates[0];
+
+	}
+
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 #include <iostream>
 
 namespace vkInit {
@@ -118,7 +119,8 @@ namespace vkInit {
 		}
 
 		version &= ~(0xFFFU);
-		version = VK_MAKE_API_VERSION(0, 1, 0, 0);
+		// 1.1 where the loader has it, extension features such as pipeline libraries are queried through it
+		version = version >= VK_MAKE_API_VERSION(0, 1, 1, 0) ? VK_MAKE_API_VERSION(0, 1, 1, 0) : VK_MAKE_API_VERSION(0, 1, 0, 0);
 
 		vk::ApplicationInfo application_info = vk::ApplicationInfo( application_name, version,
 															"Cyan Crate", version, version);
@@ -165,7 +167,7 @@ namespace vkInit {
 
 		try {
 
-			return vk::createInstance(instance_create_info, nullptr);
+			return vk::createInstance(instance_create_info, vkUtil::hostAllocator());
 
 		}
 		catch (vk::SystemError err) {
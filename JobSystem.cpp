@@ -0,0 +1,344 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace jobs {
+
+	namespace {
+
+		// Jobs each thread can have in flight before spawning falls back to running inline
+		const uint32_t jobs_per_thread = 4096;
+
+		// Idle workers spin through this many empty searches before sleeping
+		const uint32_t idle_spins = 64;
+
+		thread_local const JobSystem* current_system = nullptr;
+		thread_local uint32_t current_context_index = 0;
+
+	}
+
+	bool WorkStealingDeque::push(Job* job) {
+
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+
+		if (b - t >= capacity) {
+
+			return false;
+
+		}
+
+		entries[b & (capacity - 1)].store(job, std::memory_order_relaxed);
+		bottom.store(b + 1, std::memory_order_release);
+
+		return true;
+
+	}
+
+	Job* WorkStealingDeque::pop() {
+
+		// Claims the bottom entry before looking at top, the sequentially consistent pair orders it against steal
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_seq_cst);
+
+		if (t > b) {
+
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+
+		}
+
+		Job* job = entries[b & (capacity - 1)].load(std::memory_order_relaxed);
+
+		// Last entry: race any thief for it
+		if (t == b) {
+
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+
+				job = nullptr;
+
+			}
+
+			bottom.store(b + 1, std::memory_order_relaxed);
+
+		}
+
+		return job;
+
+	}
+
+	Job* WorkStealingDeque::steal() {
+
+		int64_t t = top.load(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_seq_cst);
+
+		if (t >= b) {
+
+			return nullptr;
+
+		}
+
+		Job* job = entries[t & (capacity - 1)].load(std::memory_order_relaxed);
+
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+
+			return nullptr;
+
+		}
+
+		return job;
+
+	}
+
+	JobSystem::JobSystem(uint32_t worker_count) {
+
+		this->worker_count = worker_count;
+		running = true;
+		sleeping_workers = 0;
+
+		// Workers take the first contexts, attached threads the rest
+		for (uint32_t i = 0; i < worker_count + max_attached_threads; ++i) {
+
+			std::unique_ptr<ThreadContext> context = std::make_unique<ThreadContext>();
+			context->jobs = std::vector<Job>(jobs_per_thread);
+			context->next_victim = i;
+
+			for (Job& job : context->jobs) {
+
+				job.queued = 0;
+
+			}
+
+			contexts.push_back(std::move(context));
+
+		}
+
+		attached_count = 0;
+
+		for (uint32_t i = 0; i < worker_count; ++i) {
+
+			workers.emplace_back(&JobSystem::workerLoop, this, i);
+
+		}
+
+	}
+
+	JobSystem::~JobSystem() {
+
+		running = false;
+
+		{
+
+			std::lock_guard<std::mutex> lock(sleep_mutex);
+			wake_condition.notify_all();
+
+		}
+
+		for (std::thread& worker : workers) {
+
+			worker.join();
+
+		}
+
+	}
+
+	uint32_t JobSystem::getThreadCount() const {
+
+		return worker_count + 1;
+
+	}
+
+	size_t JobSystem::batchSizeFor(size_t count) const {
+
+		size_t batch_count = 4 * static_cast<size_t>(getThreadCount());
+		return std::max<size_t>(1, (count + batch_count - 1) / batch_count);
+
+	}
+
+	vkUtil::FrameArena& JobSystem::getThreadArena() {
+
+		return contexts[currentContext()]->arena;
+
+	}
+
+	void JobSystem::resetThreadArenas() {
+
+		for (std::unique_ptr<ThreadContext>& context : contexts) {
+
+			context->arena.reset();
+
+		}
+
+	}
+
+	uint32_t JobSystem::currentContext() {
+
+		if (current_system == this) {
+
+			return current_context_index;
+
+		}
+
+		uint32_t attached = attached_count.fetch_add(1);
+
+		if (attached >= max_attached_threads) {
+
+			throw std::runtime_error("Too many threads attached to the job system!");
+
+		}
+
+		current_system = this;
+		current_context_index = worker_count + attached;
+
+		return current_context_index;
+
+	}
+
+	Job* JobSystem::allocateJob() {
+
+		ThreadContext& context = *contexts[currentContext()];
+		Job& job = context.jobs[context.next_job];
+
+		// Entries are reused in order, one still queued means the ring has wrapped onto unfinished work
+		if (job.queued.load(std::memory_order_acquire)) {
+
+			return nullptr;
+
+		}
+
+		context.next_job = (context.next_job + 1) % jobs_per_thread;
+		job.queued.store(1, std::memory_order_relaxed);
+
+		return &job;
+
+	}
+
+	void JobSystem::submit(Job* job) {
+
+		if (!contexts[currentContext()]->deque.push(job)) {
+
+			execute(job);
+			return;
+
+		}
+
+		if (sleeping_workers.load(std::memory_order_relaxed) > 0) {
+
+			wake_condition.notify_one();
+
+		}
+
+	}
+
+	Job* JobSystem::findJob(uint32_t context_index) {
+
+		ThreadContext& context = *contexts[context_index];
+
+		if (Job* job = context.deque.pop()) {
+
+			return job;
+
+		}
+
+		// Round robin over the other threads, starting from the last one that had work
+		uint32_t context_count = static_cast<uint32_t>(contexts.size());
+
+		for (uint32_t attempt = 0; attempt < context_count; ++attempt) {
+
+			uint32_t victim = (context.next_victim + attempt) % context_count;
+
+			if (victim == context_index) {
+
+				continue;
+
+			}
+
+			if (Job* job = contexts[victim]->deque.steal()) {
+
+				context.next_victim = victim;
+				return job;
+
+			}
+
+		}
+
+		return nullptr;
+
+	}
+
+	void JobSystem::execute(Job* job) {
+
+		// Read before the entry is released, its owner may reuse it straight away
+		Counter* counter = job->counter;
+
+		{
+
+			allocations::Scope scope(job->subsystem);
+			job->function(*job);
+
+		}
+
+		job->queued.store(0, std::memory_order_release);
+		counter->remaining.fetch_sub(1, std::memory_order_acq_rel);
+
+	}
+
+	void JobSystem::wait(Counter& counter) {
+
+		uint32_t context_index = currentContext();
+
+		while (counter.remaining.load(std::memory_order_acquire) > 0) {
+
+			if (Job* job = findJob(context_index)) {
+
+				execute(job);
+
+			}
+			else {
+
+				std::this_thread::yield();
+
+			}
+
+		}
+
+	}
+
+	void JobSystem::workerLoop(uint32_t context_index) {
+
+		current_system = this;
+		current_context_index = context_index;
+
+		uint32_t idle = 0;
+
+		while (running.load(std::memory_order_relaxed)) {
+
+			if (Job* job = findJob(context_index)) {
+
+				execute(job);
+				idle = 0;
+				continue;
+
+			}
+
+			if (++idle < idle_spins) {
+
+				std::this_thread::yield();
+				continue;
+
+			}
+
+			// A wake can slip in between the last search and the wait, the timeout bounds how long that costs
+			std::unique_lock<std::mutex> lock(sleep_mutex);
+			++sleeping_workers;
+			wake_condition.wait_for(lock, std::chrono::milliseconds(1));
+			--sleeping_workers;
+			idle = 0;
+
+		}
+
+	}
+
+}
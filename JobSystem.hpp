@@ -0,0 +1,188 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstdint>
+#include "FrameArena.hpp"
+#include "Allocations.hpp"
+
+namespace jobs {
+
+	// Jobs still outstanding against it, wait() returns once it reaches zero
+	struct Counter {
+
+		std::atomic<uint32_t> remaining{ 0 };
+
+	};
+
+	// One cache line. The callable is stored in place, so spawning a job never allocates
+	struct alignas(64) Job {
+
+		static const size_t payload_size = 40;
+
+		alignas(8) unsigned char payload[payload_size];
+		void (*function)(Job& job);
+		Counter* counter;
+		std::atomic<uint32_t> queued;
+		// Allocations the job makes are charged to the spawning thread's subsystem
+		allocations::Subsystem subsystem;
+
+	};
+
+	// Chase-Lev deque: the owning thread pushes and pops at the bottom, other threads steal from the top
+	class WorkStealingDeque {
+
+	public:
+
+		static const int64_t capacity = 4096;
+
+		// Owner only, fails when full
+		bool push(Job* job);
+
+		// Owner only, newest job first
+		Job* pop();
+
+		// Any thread, oldest job first
+		Job* steal();
+
+	private:
+
+		alignas(64) std::atomic<int64_t> top{ 0 };
+		alignas(64) std::atomic<int64_t> bottom{ 0 };
+		std::atomic<Job*> entries[capacity];
+
+	};
+
+	// Work-stealing scheduler. Every thread that spawns or waits gets its own deque and job ring, workers
+	// pop their own jobs newest first and steal the oldest from others when they run dry. Waiting runs
+	// other jobs instead of blocking, so jobs may spawn and wait for jobs of their own.
+	class JobSystem {
+
+	public:
+
+		// Threads beyond the workers attach on first use, up to max_attached_threads
+		static const uint32_t max_attached_threads = 8;
+
+		JobSystem(uint32_t worker_count);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// Workers plus the waiting thread, the useful number of ways to split a task
+		uint32_t getThreadCount() const;
+
+		template<typename Function>
+		void run(Function&& function, Counter& counter) {
+
+			using Callable = typename std::decay<Function>::type;
+			static_assert(sizeof(Callable) <= Job::payload_size, "Job captures too much, capture by reference instead");
+			static_assert(alignof(Callable) <= 8, "Job capture alignment too large");
+
+			counter.remaining.fetch_add(1, std::memory_order_relaxed);
+
+			Job* job = allocateJob();
+
+			// The ring is full of queued jobs, doing the work here is cheaper than waiting for a free entry
+			if (!job) {
+
+				function();
+				counter.remaining.fetch_sub(1, std::memory_order_release);
+				return;
+
+			}
+
+			new (job->payload) Callable(std::forward<Function>(function));
+			job->function = [](Job& job) {
+
+				Callable* callable = reinterpret_cast<Callable*>(job.payload);
+				(*callable)();
+				callable->~Callable();
+
+			};
+			job->counter = &counter;
+			job->subsystem = allocations::getCurrentSubsystem();
+
+			submit(job);
+
+		}
+
+		void wait(Counter& counter);
+
+		// Calls function(first, last) over [0, count) in batches of batch_size, returns when all are done
+		template<typename Function>
+		void parallelFor(size_t count, size_t batch_size, Function&& function) {
+
+			batch_size = batch_size > 0 ? batch_size : 1;
+
+			if (count <= batch_size) {
+
+				function(static_cast<size_t>(0), count);
+				return;
+
+			}
+
+			Counter counter;
+
+			// The calling thread takes the first batch itself
+			for (size_t first = batch_size; first < count; first += batch_size) {
+
+				size_t last = first + batch_size < count ? first + batch_size : count;
+				run([&function, first, last]() { function(first, last); }, counter);
+
+			}
+
+			function(static_cast<size_t>(0), batch_size);
+			wait(counter);
+
+		}
+
+		// Batch size splitting count into a few batches per thread
+		size_t batchSizeFor(size_t count) const;
+
+		// The calling thread's own arena, for scratch memory of jobs that allocate without locking.
+		// Memory from it stays valid until resetThreadArenas
+		vkUtil::FrameArena& getThreadArena();
+
+		// Once a frame, while no job that took memory from a thread arena is still running
+		void resetThreadArenas();
+
+	private:
+
+		struct ThreadContext {
+
+			WorkStealingDeque deque;
+			std::vector<Job> jobs;
+			vkUtil::FrameArena arena;
+			uint32_t next_job = 0;
+			uint32_t next_victim = 0;
+
+		};
+
+		uint32_t worker_count;
+		std::vector<std::unique_ptr<ThreadContext>> contexts;
+		std::atomic<uint32_t> attached_count;
+		std::vector<std::thread> workers;
+
+		std::atomic<bool> running;
+		std::atomic<uint32_t> sleeping_workers;
+		std::mutex sleep_mutex;
+		std::condition_variable wake_condition;
+
+		uint32_t currentContext();
+		Job* allocateJob();
+		void submit(Job* job);
+		Job* findJob(uint32_t context_index);
+		void execute(Job* job);
+		void workerLoop(uint32_t context_index);
+
+	};
+
+}
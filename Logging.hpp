@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 #include <iostream>
 
 namespace vkInit {
@@ -63,7 +64,7 @@ namespace vkInit {
 
 
 		return instance.createDebugUtilsMessengerEXT(create_debug_utils_messenger_callback_data_flags,
-			nullptr, dispatch_loader);
+			vkUtil::hostAllocator(), dispatch_loader);
 
 	}
 
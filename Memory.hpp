@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
+#include <iostream>
+#include "Buffer.hpp"
+
+namespace vkUtil {
+
+	uint32_t findMemoryTypeIndex(vk::PhysicalDevice physical_device, uint32_t supported_memory_indices, vk::MemoryPropertyFlags requested_properties) {
+
+		vk::PhysicalDeviceMemoryProperties memory_properties = physical_device.getMemoryProperties();
+
+		for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+
+			bool supported = static_cast<bool>(supported_memory_indices & (1 << i));
+			bool sufficient = (memory_properties.memoryTypes[i].propertyFlags & requested_properties) == requested_properties;
+
+			if (supported && sufficient) {
+
+				return i;
+
+			}
+
+		}
+
+		return 0;
+
+	}
+
+	void allocateBufferMemory(const bool& debug, Buffer& buffer, const BufferInput& input) {
+
+		vk::MemoryRequirements memory_requirements = input.logical_device.getBufferMemoryRequirements(buffer.buffer);
+
+		vk::MemoryAllocateInfo allocate_info = {};
+		allocate_info.allocationSize = memory_requirements.size;
+		allocate_info.memoryTypeIndex = findMemoryTypeIndex(input.physical_device, memory_requirements.memoryTypeBits, input.memory_properties);
+
+		try {
+
+			buffer.buffer_memory = input.logical_device.allocateMemory(allocate_info, vkUtil::hostAllocator());
+			input.logical_device.bindBufferMemory(buffer.buffer, buffer.buffer_memory, 0);
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to allocate buffer memory" << std::endl;
+
+			}
+
+		}
+
+	}
+
+	Buffer createBuffer(const bool& debug, const BufferInput& input) {
+
+		vk::BufferCreateInfo buffer_info = {};
+		buffer_info.flags = vk::BufferCreateFlags();
+		buffer_info.size = input.size;
+		buffer_info.usage = input.usage;
+		buffer_info.sharingMode = vk::SharingMode::eExclusive;
+
+		Buffer buffer = {};
+		buffer.size = input.size;
+
+		try {
+
+			buffer.buffer = input.logical_device.createBuffer(buffer_info, vkUtil::hostAllocator());
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to create buffer" << std::endl;
+
+			}
+
+			return buffer;
+
+		}
+
+		allocateBufferMemory(debug, buffer, input);
+
+		return buffer;
+
+	}
+
+	void uploadToBuffer(vk::Device logical_device, Buffer& buffer, const void* data, vk::DeviceSize size) {
+
+		void* memory_location = logical_device.mapMemory(buffer.buffer_memory, 0, size);
+		memcpy(memory_location, data, size);
+		logical_device.unmapMemory(buffer.buffer_memory);
+
+	}
+
+	void destroyBuffer(vk::Device logical_device, Buffer& buffer) {
+
+		logical_device.destroyBuffer(buffer.buffer, vkUtil::hostAllocator());
+		logical_device.freeMemory(buffer.buffer_memory, vkUtil::hostAllocator());
+
+		buffer = {};
+
+	}
+
+}
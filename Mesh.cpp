@@ -0,0 +1,212 @@
+#include "Mesh.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace vkMesh {
+
+	Mesh makeSphere(const glm::vec3& center, float radius, uint32_t rings, uint32_t segments) {
+
+		Mesh mesh;
+		mesh.vertices.reserve((rings + 1) * (segments + 1));
+		mesh.indices.reserve(rings * segments * 6);
+
+		const float pi = 3.14159265358979f;
+
+		for (uint32_t ring = 0; ring <= rings; ++ring) {
+
+			float phi = pi * ring / rings;
+
+			for (uint32_t segment = 0; segment <= segments; ++segment) {
+
+				float theta = 2.0f * pi * segment / segments;
+
+				glm::vec3 normal = glm::vec3(std::sin(phi) * std::cos(theta), -std::cos(phi), std::sin(phi) * std::sin(theta));
+				mesh.vertices.push_back({ center + radius * normal, normal });
+
+			}
+
+		}
+
+		for (uint32_t ring = 0; ring < rings; ++ring) {
+
+			for (uint32_t segment = 0; segment < segments; ++segment) {
+
+				uint32_t a = ring * (segments + 1) + segment;
+				uint32_t b = a + segments + 1;
+
+				mesh.indices.insert(mesh.indices.end(), { a, a + 1, b });
+				mesh.indices.insert(mesh.indices.end(), { a + 1, b + 1, b });
+
+			}
+
+		}
+
+		return mesh;
+
+	}
+
+	void computeMeshletBounds(const Mesh& mesh, MeshletMesh& meshlet_mesh, Meshlet& meshlet) {
+
+		const uint32_t* vertices = meshlet_mesh.meshlet_vertices.data() + meshlet.vertex_offset;
+		const uint32_t* triangles = meshlet_mesh.meshlet_triangles.data() + meshlet.triangle_offset;
+
+		glm::vec3 min_corner = mesh.vertices[vertices[0]].position;
+		glm::vec3 max_corner = min_corner;
+
+		for (uint32_t i = 1; i < meshlet.vertex_count; ++i) {
+
+			min_corner = glm::min(min_corner, mesh.vertices[vertices[i]].position);
+			max_corner = glm::max(max_corner, mesh.vertices[vertices[i]].position);
+
+		}
+
+		glm::vec3 center = 0.5f * (min_corner + max_corner);
+		float radius = 0.0f;
+
+		for (uint32_t i = 0; i < meshlet.vertex_count; ++i) {
+
+			radius = std::max(radius, glm::length(mesh.vertices[vertices[i]].position - center));
+
+		}
+
+		meshlet.sphere = glm::vec4(center, radius);
+
+		// Front faces wind clockwise on screen, which in the engine's left handed
+		// world space makes cross(p1 - p0, p2 - p0) point away from the viewer
+		std::vector<glm::vec3> normals;
+		normals.reserve(meshlet.triangle_count);
+		glm::vec3 axis = glm::vec3(0.0f);
+
+		for (uint32_t i = 0; i < meshlet.triangle_count; ++i) {
+
+			const glm::vec3& p0 = mesh.vertices[vertices[triangles[i] & 0xFF]].position;
+			const glm::vec3& p1 = mesh.vertices[vertices[(triangles[i] >> 8) & 0xFF]].position;
+			const glm::vec3& p2 = mesh.vertices[vertices[(triangles[i] >> 16) & 0xFF]].position;
+
+			glm::vec3 normal = glm::cross(p2 - p0, p1 - p0);
+			float area = glm::length(normal);
+
+			if (area > 0.0f) {
+
+				normals.push_back(normal / area);
+				axis += normal / area;
+
+			}
+
+		}
+
+		meshlet.cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+		float axis_length = glm::length(axis);
+
+		if (axis_length == 0.0f) {
+
+			return;
+
+		}
+
+		axis /= axis_length;
+
+		float min_dot = 1.0f;
+
+		for (const glm::vec3& normal : normals) {
+
+			min_dot = std::min(min_dot, glm::dot(axis, normal));
+
+		}
+
+		// Cones wider than ~85 degrees never cull anything, keep them disabled
+		if (min_dot <= 0.1f) {
+
+			return;
+
+		}
+
+		meshlet.cone = glm::vec4(axis, std::sqrt(1.0f - min_dot * min_dot));
+
+	}
+
+	MeshletMesh buildMeshlets(const Mesh& mesh) {
+
+		MeshletMesh meshlet_mesh;
+		meshlet_mesh.triangle_count = static_cast<uint32_t>(mesh.indices.size() / 3);
+
+		std::vector<int32_t> local_indices(mesh.vertices.size(), -1);
+
+		Meshlet meshlet = {};
+
+		auto flush = [&]() {
+
+			if (meshlet.triangle_count == 0) {
+
+				return;
+
+			}
+
+			computeMeshletBounds(mesh, meshlet_mesh, meshlet);
+
+			for (uint32_t i = 0; i < meshlet.vertex_count; ++i) {
+
+				local_indices[meshlet_mesh.meshlet_vertices[meshlet.vertex_offset + i]] = -1;
+
+			}
+
+			meshlet_mesh.meshlets.push_back(meshlet);
+
+			meshlet = {};
+			meshlet.vertex_offset = static_cast<uint32_t>(meshlet_mesh.meshlet_vertices.size());
+			meshlet.triangle_offset = static_cast<uint32_t>(meshlet_mesh.meshlet_triangles.size());
+
+		};
+
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+
+			const uint32_t* triangle = &mesh.indices[i];
+
+			uint32_t new_vertices = 0;
+
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+
+				if (local_indices[triangle[corner]] < 0) {
+
+					++new_vertices;
+
+				}
+
+			}
+
+			if (meshlet.vertex_count + new_vertices > max_meshlet_vertices || meshlet.triangle_count + 1 > max_meshlet_triangles) {
+
+				flush();
+
+			}
+
+			uint32_t packed_triangle = 0;
+
+			for (uint32_t corner = 0; corner < 3; ++corner) {
+
+				int32_t& local_index = local_indices[triangle[corner]];
+
+				if (local_index < 0) {
+
+					local_index = static_cast<int32_t>(meshlet.vertex_count++);
+					meshlet_mesh.meshlet_vertices.push_back(triangle[corner]);
+
+				}
+
+				packed_triangle |= static_cast<uint32_t>(local_index) << (8 * corner);
+
+			}
+
+			meshlet_mesh.meshlet_triangles.push_back(packed_triangle);
+			++meshlet.triangle_count;
+
+		}
+
+		flush();
+
+		return meshlet_mesh;
+
+	}
+
+}
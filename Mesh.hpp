@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace vkMesh {
+
+	const uint32_t max_meshlet_vertices = 64;
+	const uint32_t max_meshlet_triangles = 124;
+
+	struct Vertex {
+
+		glm::vec3 position;
+		glm::vec3 normal;
+
+	};
+
+	struct Mesh {
+
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+
+	};
+
+	// Layout matches the std430 Meshlet struct in Shaders/meshlet_cull.comp
+	struct Meshlet {
+
+		glm::vec4 sphere;	// xyz: center, w: radius
+		glm::vec4 cone;		// xyz: axis, w: cutoff (sine of the cone half angle, 1 disables culling)
+		uint32_t vertex_offset;
+		uint32_t triangle_offset;
+		uint32_t vertex_count;
+		uint32_t triangle_count;
+
+	};
+
+	struct MeshletMesh {
+
+		std::vector<Meshlet> meshlets;
+		std::vector<uint32_t> meshlet_vertices;
+		// One entry per triangle, three 8 bit meshlet-local vertex indices
+		std::vector<uint32_t> meshlet_triangles;
+		uint32_t triangle_count;
+
+	};
+
+	Mesh makeSphere(const glm::vec3& center, float radius, uint32_t rings, uint32_t segments);
+
+	MeshletMesh buildMeshlets(const Mesh& mesh);
+
+}
@@ -0,0 +1,844 @@
+#include "PipelineManager.hpp"
+#include "GraphicsPipeline.hpp"
+#include "ComputePipeline.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+namespace vkUtil {
+
+	namespace {
+
+		template<typename Entry, typename State>
+		Entry* findEntry(std::vector<Entry>& entries, uint64_t hash, const State& state) {
+
+			for (Entry& entry : entries) {
+
+				if (entry.hash == hash && entry.state == state) {
+
+					return &entry;
+
+				}
+
+			}
+
+			return nullptr;
+
+		}
+
+		// Puts the displaced pipeline in replaced, null if the entry held none
+		template<typename Entry>
+		bool moveRebuilt(std::vector<Entry>& rebuilt, std::vector<Entry>& cached, vk::Pipeline pipeline, vk::Pipeline& replaced) {
+
+			for (size_t i = 0; i < rebuilt.size(); ++i) {
+
+				if (rebuilt[i].output.pipeline != pipeline) {
+
+					continue;
+
+				}
+
+				// Whatever the entry held, building, failed or built, the reloaded pipeline is newer
+				Entry* entry = findEntry(cached, rebuilt[i].hash, rebuilt[i].state);
+
+				if (entry) {
+
+					replaced = entry->output.pipeline;
+					entry->output = rebuilt[i].output;
+					entry->status = PipelineStatus::eReady;
+
+				}
+				else {
+
+					cached.push_back(rebuilt[i]);
+
+				}
+
+				rebuilt.erase(rebuilt.begin() + i);
+				return true;
+
+			}
+
+			return false;
+
+		}
+
+		template<typename Entry>
+		bool removeRebuilt(std::vector<Entry>& rebuilt, vk::Pipeline pipeline) {
+
+			for (size_t i = 0; i < rebuilt.size(); ++i) {
+
+				if (rebuilt[i].output.pipeline == pipeline) {
+
+					rebuilt.erase(rebuilt.begin() + i);
+					return true;
+
+				}
+
+			}
+
+			return false;
+
+		}
+
+		template<typename Entry, typename State, typename Output>
+		Output storeBuild(std::vector<Entry>& entries, uint64_t hash, const State& state, Output output, vk::Device logical_device) {
+
+			Entry* entry = findEntry(entries, hash, state);
+
+			// A hot reload filled the entry while this build ran, its pipeline is the newer one
+			if (entry->status != PipelineStatus::eBuilding) {
+
+				logical_device.destroyPipeline(output.pipeline, hostAllocator());
+				return entry->output;
+
+			}
+
+			entry->output = output;
+			entry->status = output.pipeline ? PipelineStatus::eReady : PipelineStatus::eFailed;
+
+			return output;
+
+		}
+
+	}
+
+	PipelineManager::PipelineManager(bool debug, vk::Device logical_device, ShaderCompiler* shader_compiler, DescriptorSetLayoutCache* layout_cache,
+									 jobs::JobSystem* job_system, bool pipeline_libraries) {
+
+		this->debug = debug;
+		this->logical_device = logical_device;
+		this->shader_compiler = shader_compiler;
+		this->layout_cache = layout_cache;
+		statistics = {};
+
+		// Jobs only run on workers or inside a wait, without workers a queued build could sit there forever
+		this->job_system = job_system && job_system->getThreadCount() > 1 ? job_system : nullptr;
+		// Linked pipelines run slower than whole ones, without workers to optimize them they would stay that way
+		this->pipeline_libraries = pipeline_libraries && this->job_system;
+
+		vk::PipelineCacheCreateInfo cache_info = {};
+		cache_info.flags = vk::PipelineCacheCreateFlags();
+
+		try {
+
+			pipeline_cache = logical_device.createPipelineCache(cache_info, hostAllocator());
+
+		}
+		catch (vk::SystemError err) {
+
+			// Pipelines still build without one, only slower
+			if (debug) {
+
+				std::cout << "Failed to create pipeline cache" << std::endl;
+
+			}
+
+			pipeline_cache = nullptr;
+
+		}
+
+	}
+
+	PipelineManager::~PipelineManager() {
+
+		// Builds first, they may still start optimized builds
+		waitForBuilds();
+		waitForOptimizedBuilds();
+
+		for (const GraphicsEntry& entry : graphics_pipelines) {
+
+			logical_device.destroyPipeline(entry.output.pipeline, hostAllocator());
+
+		}
+
+		for (const ComputeEntry& entry : compute_pipelines) {
+
+			logical_device.destroyPipeline(entry.output.pipeline, hostAllocator());
+
+		}
+
+		for (const GraphicsEntry& entry : rebuilt_graphics_pipelines) {
+
+			logical_device.destroyPipeline(entry.output.pipeline, hostAllocator());
+
+		}
+
+		for (const ComputeEntry& entry : rebuilt_compute_pipelines) {
+
+			logical_device.destroyPipeline(entry.output.pipeline, hostAllocator());
+
+		}
+
+		// Linked pipelines replaced by optimized ones nobody took the upgrade for
+		for (const PipelineUpgrade& upgrade : upgrades) {
+
+			logical_device.destroyPipeline(upgrade.linked, hostAllocator());
+
+		}
+
+		for (const LibraryEntry& entry : libraries) {
+
+			logical_device.destroyPipeline(entry.library, hostAllocator());
+
+		}
+
+		for (const LayoutEntry& entry : layouts) {
+
+			logical_device.destroyPipelineLayout(entry.layout, hostAllocator());
+
+		}
+
+		for (const RenderPassEntry& entry : render_passes) {
+
+			logical_device.destroyRenderPass(entry.render_pass, hostAllocator());
+
+		}
+
+		logical_device.destroyPipelineCache(pipeline_cache, hostAllocator());
+
+	}
+
+	vkInit::GraphicsPipelineOutBundle PipelineManager::getGraphicsPipeline(const vkInit::GraphicsPipelineState& state) {
+
+		uint64_t hash = state.hash();
+
+		{
+
+			std::unique_lock<std::mutex> lock(mutex);
+			GraphicsEntry* entry = findEntry(graphics_pipelines, hash, state);
+
+			// Another thread's build of the same state is waited for rather than repeated
+			while (entry && entry->status == PipelineStatus::eBuilding) {
+
+				build_finished.wait(lock);
+				entry = findEntry(graphics_pipelines, hash, state);
+
+			}
+
+			if (entry && entry->status == PipelineStatus::eReady) {
+
+				++statistics.pipeline_hits;
+				return entry->output;
+
+			}
+
+			++statistics.pipeline_misses;
+
+			if (entry) {
+
+				entry->status = PipelineStatus::eBuilding;
+
+			}
+			else {
+
+				graphics_pipelines.push_back({ hash, state, {}, PipelineStatus::eBuilding });
+
+			}
+
+		}
+
+		return finishGraphicsBuild(hash, state, buildGraphicsPipeline(state));
+
+	}
+
+	vkInit::ComputePipelineOutBundle PipelineManager::getComputePipeline(const vkInit::ComputePipelineState& state) {
+
+		uint64_t hash = state.hash();
+
+		{
+
+			std::unique_lock<std::mutex> lock(mutex);
+			ComputeEntry* entry = findEntry(compute_pipelines, hash, state);
+
+			while (entry && entry->status == PipelineStatus::eBuilding) {
+
+				build_finished.wait(lock);
+				entry = findEntry(compute_pipelines, hash, state);
+
+			}
+
+			if (entry && entry->status == PipelineStatus::eReady) {
+
+				++statistics.pipeline_hits;
+				return entry->output;
+
+			}
+
+			++statistics.pipeline_misses;
+
+			if (entry) {
+
+				entry->status = PipelineStatus::eBuilding;
+
+			}
+			else {
+
+				compute_pipelines.push_back({ hash, state, {}, PipelineStatus::eBuilding });
+
+			}
+
+		}
+
+		return finishComputeBuild(hash, state, buildComputePipeline(state));
+
+	}
+
+	vkInit::GraphicsPipelineOutBundle PipelineManager::requestGraphicsPipeline(const vkInit::GraphicsPipelineState& state,
+																			   const vkInit::GraphicsPipelineState* fallback) {
+
+		uint64_t hash = state.hash();
+		vkInit::GraphicsPipelineOutBundle output = {};
+		bool build = false;
+
+		{
+
+			std::lock_guard<std::mutex> lock(mutex);
+			GraphicsEntry* entry = findEntry(graphics_pipelines, hash, state);
+
+			if (entry && entry->status == PipelineStatus::eReady) {
+
+				++statistics.pipeline_hits;
+				return entry->output;
+
+			}
+
+			if (!entry) {
+
+				++statistics.pipeline_misses;
+				graphics_pipelines.push_back({ hash, state, {}, PipelineStatus::eBuilding });
+				build = true;
+
+			}
+
+			GraphicsEntry* fallback_entry = fallback ? findEntry(graphics_pipelines, fallback->hash(), *fallback) : nullptr;
+
+			if (fallback_entry && fallback_entry->status == PipelineStatus::eReady) {
+
+				output = fallback_entry->output;
+
+			}
+
+		}
+
+		if (build && job_system) {
+
+			// Job captures have to stay small, the state goes along on the heap
+			vkInit::GraphicsPipelineState* job_state = new vkInit::GraphicsPipelineState(state);
+
+			job_system->run([this, hash, job_state]() {
+
+				finishGraphicsBuild(hash, *job_state, buildGraphicsPipeline(*job_state));
+				delete job_state;
+
+			}, build_jobs);
+
+		}
+		else if (build) {
+
+			vkInit::GraphicsPipelineOutBundle built = finishGraphicsBuild(hash, state, buildGraphicsPipeline(state));
+
+			if (built.pipeline) {
+
+				return built;
+
+			}
+
+		}
+
+		if (!output.pipeline) {
+
+			// Enough to begin the pass whose draws are skipped
+			output.render_pass = getRenderPass(state.swapchain_image_format, state.depth_format, state.depth_prepass, state.render_pass_stage);
+
+		}
+
+		return output;
+
+	}
+
+	vkInit::ComputePipelineOutBundle PipelineManager::requestComputePipeline(const vkInit::ComputePipelineState& state) {
+
+		uint64_t hash = state.hash();
+		bool build = false;
+
+		{
+
+			std::lock_guard<std::mutex> lock(mutex);
+			ComputeEntry* entry = findEntry(compute_pipelines, hash, state);
+
+			if (entry && entry->status == PipelineStatus::eReady) {
+
+				++statistics.pipeline_hits;
+				return entry->output;
+
+			}
+
+			if (!entry) {
+
+				++statistics.pipeline_misses;
+				compute_pipelines.push_back({ hash, state, {}, PipelineStatus::eBuilding });
+				build = true;
+
+			}
+
+		}
+
+		if (build && job_system) {
+
+			vkInit::ComputePipelineState* job_state = new vkInit::ComputePipelineState(state);
+
+			job_system->run([this, hash, job_state]() {
+
+				finishComputeBuild(hash, *job_state, buildComputePipeline(*job_state));
+				delete job_state;
+
+			}, build_jobs);
+
+		}
+		else if (build) {
+
+			return finishComputeBuild(hash, state, buildComputePipeline(state));
+
+		}
+
+		return {};
+
+	}
+
+	void PipelineManager::warmUp(const std::vector<vkInit::GraphicsPipelineState>& graphics_states,
+								 const std::vector<vkInit::ComputePipelineState>& compute_states) {
+
+		for (const vkInit::GraphicsPipelineState& state : graphics_states) {
+
+			requestGraphicsPipeline(state);
+
+		}
+
+		for (const vkInit::ComputePipelineState& state : compute_states) {
+
+			requestComputePipeline(state);
+
+		}
+
+		waitForBuilds();
+
+	}
+
+	void PipelineManager::waitForBuilds() {
+
+		if (job_system) {
+
+			job_system->wait(build_jobs);
+
+		}
+
+	}
+
+	void PipelineManager::waitForOptimizedBuilds() {
+
+		if (job_system) {
+
+			job_system->wait(optimize_jobs);
+
+		}
+
+	}
+
+	vkInit::GraphicsPipelineOutBundle PipelineManager::rebuildGraphicsPipeline(const vkInit::GraphicsPipelineState& state) {
+
+		vkInit::GraphicsPipelineOutBundle output = buildGraphicsPipeline(state);
+
+		if (output.pipeline) {
+
+			std::lock_guard<std::mutex> lock(mutex);
+			rebuilt_graphics_pipelines.push_back({ state.hash(), state, output, PipelineStatus::eReady });
+
+		}
+
+		return output;
+
+	}
+
+	vkInit::ComputePipelineOutBundle PipelineManager::rebuildComputePipeline(const vkInit::ComputePipelineState& state) {
+
+		vkInit::ComputePipelineOutBundle output = buildComputePipeline(state);
+
+		if (output.pipeline) {
+
+			std::lock_guard<std::mutex> lock(mutex);
+			rebuilt_compute_pipelines.push_back({ state.hash(), state, output, PipelineStatus::eReady });
+
+		}
+
+		return output;
+
+	}
+
+	vk::Pipeline PipelineManager::replacePipeline(vk::Pipeline pipeline) {
+
+		vk::Pipeline replaced = nullptr;
+		GraphicsEntry linked = {};
+
+		{
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if (moveRebuilt(rebuilt_graphics_pipelines, graphics_pipelines, pipeline, replaced)) {
+
+				auto entry = std::find_if(graphics_pipelines.begin(), graphics_pipelines.end(),
+					[pipeline](const GraphicsEntry& candidate) { return candidate.output.pipeline == pipeline; });
+				linked = *entry;
+
+			}
+			else {
+
+				moveRebuilt(rebuilt_compute_pipelines, compute_pipelines, pipeline, replaced);
+
+			}
+
+			// A get may be waiting on the entry just filled
+			build_finished.notify_all();
+
+		}
+
+		// A reloaded pipeline is linked like any other, and gets optimized once it is in the cache
+		if (pipeline_libraries && linked.output.pipeline) {
+
+			optimizeLinkedPipeline(linked.hash, linked.state, linked.output.pipeline);
+
+		}
+
+		return replaced;
+
+	}
+
+	void PipelineManager::discardPipeline(vk::Pipeline pipeline) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (removeRebuilt(rebuilt_graphics_pipelines, pipeline) || removeRebuilt(rebuilt_compute_pipelines, pipeline)) {
+
+			logical_device.destroyPipeline(pipeline, hostAllocator());
+
+		}
+
+	}
+
+	vk::RenderPass PipelineManager::getRenderPass(vk::Format swapchain_image_format, vk::Format depth_format, bool depth_prepass, vkInit::RenderPassStage stage) {
+
+		// Render passes are cheap to make, building one under the lock is fine
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (const RenderPassEntry& entry : render_passes) {
+
+			if (entry.swapchain_image_format == swapchain_image_format && entry.depth_format == depth_format &&
+				entry.depth_prepass == depth_prepass && entry.stage == stage) {
+
+				++statistics.render_pass_hits;
+				return entry.render_pass;
+
+			}
+
+		}
+
+		++statistics.render_pass_misses;
+
+		vk::RenderPass render_pass = vkInit::makeRenderPass(logical_device, swapchain_image_format, depth_format, depth_prepass, stage);
+
+		if (render_pass) {
+
+			render_passes.push_back({ swapchain_image_format, depth_format, depth_prepass, stage, render_pass });
+
+		}
+
+		return render_pass;
+
+	}
+
+	vk::PipelineLayout PipelineManager::getPipelineLayout(const std::vector<vk::DescriptorSetLayout>& descriptor_set_layouts,
+														  const std::vector<vk::PushConstantRange>& push_constant_ranges) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (const LayoutEntry& entry : layouts) {
+
+			if (entry.descriptor_set_layouts == descriptor_set_layouts && entry.push_constant_ranges == push_constant_ranges) {
+
+				++statistics.layout_hits;
+				return entry.layout;
+
+			}
+
+		}
+
+		++statistics.layout_misses;
+
+		vk::PipelineLayout layout = vkInit::makePipelineLayout(logical_device, descriptor_set_layouts, push_constant_ranges);
+
+		if (layout) {
+
+			layouts.push_back({ descriptor_set_layouts, push_constant_ranges, layout });
+
+		}
+
+		return layout;
+
+	}
+
+	bool PipelineManager::takeUpgrade(PipelineUpgrade& upgrade) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (upgrades.empty()) {
+
+			return false;
+
+		}
+
+		upgrade = upgrades.back();
+		upgrades.pop_back();
+
+		return true;
+
+	}
+
+	PipelineCacheStatistics PipelineManager::getStatistics() {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		return statistics;
+
+	}
+
+	vkInit::GraphicsPipelineOutBundle PipelineManager::buildGraphicsPipeline(const vkInit::GraphicsPipelineState& state) {
+
+		if (pipeline_libraries) {
+
+			return linkGraphicsPipeline(state, false);
+
+		}
+
+		vkInit::GraphicsPipelineInBundle specification = {};
+		specification.logical_device = logical_device;
+		specification.shader_compiler = shader_compiler;
+		specification.layout_cache = layout_cache;
+		specification.pipeline_manager = this;
+		specification.pipeline_cache = pipeline_cache;
+		specification.state = state;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		vkInit::GraphicsPipelineOutBundle output = vkInit::makeGraphicsPipeline(debug, specification);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		statistics.creation_time += elapsed.count();
+
+		return output;
+
+	}
+
+	vkInit::ComputePipelineOutBundle PipelineManager::buildComputePipeline(const vkInit::ComputePipelineState& state) {
+
+		vkInit::ComputePipelineInBundle specification = {};
+		specification.logical_device = logical_device;
+		specification.shader_compiler = shader_compiler;
+		specification.layout_cache = layout_cache;
+		specification.pipeline_manager = this;
+		specification.pipeline_cache = pipeline_cache;
+		specification.state = state;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		vkInit::ComputePipelineOutBundle output = vkInit::makeComputePipeline(debug, specification);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		statistics.creation_time += elapsed.count();
+
+		return output;
+
+	}
+
+	vkInit::GraphicsPipelineOutBundle PipelineManager::linkGraphicsPipeline(const vkInit::GraphicsPipelineState& state, bool optimize) {
+
+		vkInit::GraphicsPipelineInBundle specification = {};
+		specification.logical_device = logical_device;
+		specification.shader_compiler = shader_compiler;
+		specification.layout_cache = layout_cache;
+		specification.pipeline_manager = this;
+		specification.pipeline_cache = pipeline_cache;
+		specification.state = state;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		// Compiling is a SPIR-V cache hit for every part already built, it is reflection that decides the layout
+		vkInit::GraphicsShaders shaders;
+		vkInit::compileGraphicsShaders(specification, shaders);
+
+		vkInit::GraphicsPipelineOutBundle output = {};
+		output.render_pass = getRenderPass(state.swapchain_image_format, state.depth_format, state.depth_prepass, state.render_pass_stage);
+
+		if (shaders.valid) {
+
+			output.layout = getPipelineLayout(specification.state.descriptor_set_layouts, shaders.reflection.push_constants);
+
+		}
+
+		const vk::GraphicsPipelineLibraryFlagBitsEXT parts[] = {
+			vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface,
+			vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders,
+			vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader,
+			vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface
+		};
+
+		std::array<vk::Pipeline, 4> part_libraries = {};
+		bool complete = output.layout && output.render_pass;
+
+		for (size_t i = 0; i < part_libraries.size() && complete; ++i) {
+
+			part_libraries[i] = getPipelineLibrary(parts[i], specification, shaders, output.layout, output.render_pass);
+			complete = static_cast<bool>(part_libraries[i]);
+
+		}
+
+		if (complete) {
+
+			output.pipeline = vkInit::linkPipelineLibraries(logical_device, pipeline_cache, part_libraries, output.layout, optimize);
+
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		statistics.creation_time += elapsed.count();
+
+		return output;
+
+	}
+
+	vk::Pipeline PipelineManager::getPipelineLibrary(vk::GraphicsPipelineLibraryFlagBitsEXT part, const vkInit::GraphicsPipelineInBundle& specification,
+													 const vkInit::GraphicsShaders& shaders, vk::PipelineLayout layout, vk::RenderPass render_pass) {
+
+		vkInit::GraphicsPipelineState key = vkInit::makeLibraryKey(specification.state, part);
+		uint64_t hash = key.hash();
+
+		// Vertex input and fragment output have no shaders, any layout goes with them
+		bool uses_layout = part == vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders ||
+						   part == vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader;
+		vk::PipelineLayout key_layout = uses_layout ? layout : nullptr;
+
+		auto matches = [&](const LibraryEntry& entry) {
+
+			return entry.part == part && entry.hash == hash && entry.layout == key_layout && entry.key == key;
+
+		};
+
+		{
+
+			std::lock_guard<std::mutex> lock(mutex);
+			auto entry = std::find_if(libraries.begin(), libraries.end(), matches);
+
+			if (entry != libraries.end()) {
+
+				++statistics.library_hits;
+				return entry->library;
+
+			}
+
+			++statistics.library_misses;
+
+		}
+
+		// Built without the lock. Two threads missing the same part both build it, the second one keeps the first's
+		vk::Pipeline library = vkInit::makePipelineLibrary(debug, specification, shaders, layout, render_pass, part);
+
+		if (!library) {
+
+			return nullptr;
+
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		auto entry = std::find_if(libraries.begin(), libraries.end(), matches);
+
+		if (entry != libraries.end()) {
+
+			logical_device.destroyPipeline(library, hostAllocator());
+			return entry->library;
+
+		}
+
+		libraries.push_back({ part, hash, key, key_layout, library });
+
+		return library;
+
+	}
+
+	void PipelineManager::optimizeLinkedPipeline(uint64_t hash, const vkInit::GraphicsPipelineState& state, vk::Pipeline linked) {
+
+		vkInit::GraphicsPipelineState* job_state = new vkInit::GraphicsPipelineState(state);
+
+		job_system->run([this, hash, job_state, linked]() {
+
+			finishOptimizedBuild(hash, *job_state, linked, linkGraphicsPipeline(*job_state, true).pipeline);
+			delete job_state;
+
+		}, optimize_jobs);
+
+	}
+
+	void PipelineManager::finishOptimizedBuild(uint64_t hash, const vkInit::GraphicsPipelineState& state, vk::Pipeline linked,
+											   vk::Pipeline optimized) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		GraphicsEntry* entry = findEntry(graphics_pipelines, hash, state);
+
+		// A hot reload replaced the linked pipeline meanwhile, what was optimized is out of date. If optimizing
+		// failed, the linked pipeline simply stays
+		if (!optimized || !entry || entry->output.pipeline != linked) {
+
+			logical_device.destroyPipeline(optimized, hostAllocator());
+			return;
+
+		}
+
+		entry->output.pipeline = optimized;
+		upgrades.push_back({ linked, optimized });
+
+	}
+
+	vkInit::GraphicsPipelineOutBundle PipelineManager::finishGraphicsBuild(uint64_t hash, const vkInit::GraphicsPipelineState& state,
+																		   vkInit::GraphicsPipelineOutBundle output) {
+
+		vk::Pipeline built = output.pipeline;
+
+		{
+
+			std::lock_guard<std::mutex> lock(mutex);
+			output = storeBuild(graphics_pipelines, hash, state, output, logical_device);
+			build_finished.notify_all();
+
+		}
+
+		// Linked pipelines are usable at once, the optimized build takes their place later
+		if (pipeline_libraries && built && output.pipeline == built) {
+
+			optimizeLinkedPipeline(hash, state, built);
+
+		}
+
+		return output;
+
+	}
+
+	vkInit::ComputePipelineOutBundle PipelineManager::finishComputeBuild(uint64_t hash, const vkInit::ComputePipelineState& state,
+																		 vkInit::ComputePipelineOutBundle output) {
+
+		std::lock_guard<std::mutex> lock(mutex);
+		output = storeBuild(compute_pipelines, hash, state, output, logical_device);
+		build_finished.notify_all();
+
+		return output;
+
+	}
+
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "PipelineState.hpp"
+#include "ShaderCompiler.hpp"
+#include "DescriptorSetLayoutCache.hpp"
+#include "JobSystem.hpp"
+
+namespace vkInit {
+
+	// From GraphicsPipeline.hpp, which includes this header in turn
+	struct GraphicsPipelineInBundle;
+	struct GraphicsShaders;
+
+}
+
+namespace vkUtil {
+
+	struct PipelineCacheStatistics {
+
+		uint32_t pipeline_hits;
+		uint32_t pipeline_misses;
+		uint32_t layout_hits;
+		uint32_t layout_misses;
+		uint32_t render_pass_hits;
+		uint32_t render_pass_misses;
+		uint32_t library_hits;
+		uint32_t library_misses;
+		// Milliseconds spent building pipelines on misses and rebuilds, shader compilation included.
+		// Summed over threads, so builds in parallel add up to more than the time they took
+		double creation_time;
+
+	};
+
+	enum class PipelineStatus {
+
+		eBuilding,
+		eReady,
+		eFailed
+
+	};
+
+	// A fast-linked pipeline whose optimized build has taken over its cache entry
+	struct PipelineUpgrade {
+
+		vk::Pipeline linked;
+		vk::Pipeline optimized;
+
+	};
+
+	// Hands out pipelines, pipeline layouts and render passes for a description of their state, creating each
+	// the first time it is asked for and returning the same object after that. Owns all of them until it is
+	// destroyed. Creation goes through one VkPipelineCache. Safe to use from several threads, and requested
+	// pipelines build as jobs so several compile at once.
+	// With pipeline libraries, a graphics pipeline is linked from four separately cached parts: vertex input,
+	// pre-rasterization shaders, fragment shader and fragment output. New combinations of parts already built only
+	// need linking, and an optimized build of each linked pipeline follows on a worker to take its place
+	class PipelineManager {
+
+	public:
+
+		// Without a job system, or one without workers, requested pipelines build on the calling thread. Pipeline
+		// libraries need the device to have VK_EXT_graphics_pipeline_library enabled, and workers for the optimized builds
+		PipelineManager(bool debug, vk::Device logical_device, ShaderCompiler* shader_compiler, DescriptorSetLayoutCache* layout_cache,
+						jobs::JobSystem* job_system, bool pipeline_libraries);
+		~PipelineManager();
+
+		PipelineManager(const PipelineManager&) = delete;
+		PipelineManager& operator=(const PipelineManager&) = delete;
+
+		// Builds on the calling thread, or waits for a build already under way. Null pipeline if a shader
+		// fails, a failed state is tried again on the next call
+		vkInit::GraphicsPipelineOutBundle getGraphicsPipeline(const vkInit::GraphicsPipelineState& state);
+		vkInit::ComputePipelineOutBundle getComputePipeline(const vkInit::ComputePipelineState& state);
+
+		// Never waits. A pipeline not built yet starts building on a worker, meanwhile the fallback's pipeline
+		// is returned if that one is built, otherwise a null pipeline whose draws the caller skips. The render
+		// pass is always filled in. Asking again returns the pipeline once it is ready, a failed build stays
+		// failed until getGraphicsPipeline or a hot reload tries it again
+		vkInit::GraphicsPipelineOutBundle requestGraphicsPipeline(const vkInit::GraphicsPipelineState& state,
+																  const vkInit::GraphicsPipelineState* fallback = nullptr);
+		vkInit::ComputePipelineOutBundle requestComputePipeline(const vkInit::ComputePipelineState& state);
+
+		// Requests every state and waits for them, with the calling thread helping, so a known set of
+		// pipelines is ready before the first frame
+		void warmUp(const std::vector<vkInit::GraphicsPipelineState>& graphics_states,
+					const std::vector<vkInit::ComputePipelineState>& compute_states);
+		// A linked pipeline counts as built, its optimized build carries on
+		void waitForBuilds();
+		void waitForOptimizedBuilds();
+
+		// Builds a new pipeline even if the state is cached, for shader hot reload. It is held aside until
+		// replacePipeline puts it in the cache or discardPipeline destroys it
+		vkInit::GraphicsPipelineOutBundle rebuildGraphicsPipeline(const vkInit::GraphicsPipelineState& state);
+		vkInit::ComputePipelineOutBundle rebuildComputePipeline(const vkInit::ComputePipelineState& state);
+
+		// The rebuilt pipeline takes over the cache entry of its state, or gets one of its own. Returns the pipeline
+		// the entry held, which the caller destroys once nothing uses it. With pipeline libraries that may be an
+		// optimized pipeline whose upgrade hasn't been taken yet, rather than the one the caller was using
+		vk::Pipeline replacePipeline(vk::Pipeline pipeline);
+		void discardPipeline(vk::Pipeline pipeline);
+
+		// False once every finished optimized build has been taken. From then on the cache hands out the optimized
+		// pipeline, the caller swaps it in wherever it used the linked one and destroys that once nothing uses it
+		bool takeUpgrade(PipelineUpgrade& upgrade);
+
+		vk::RenderPass getRenderPass(vk::Format swapchain_image_format, vk::Format depth_format, bool depth_prepass, vkInit::RenderPassStage stage);
+		vk::PipelineLayout getPipelineLayout(const std::vector<vk::DescriptorSetLayout>& descriptor_set_layouts,
+											 const std::vector<vk::PushConstantRange>& push_constant_ranges);
+
+		PipelineCacheStatistics getStatistics();
+
+	private:
+
+		struct GraphicsEntry {
+
+			uint64_t hash;
+			vkInit::GraphicsPipelineState state;
+			vkInit::GraphicsPipelineOutBundle output;
+			PipelineStatus status;
+
+		};
+
+		struct ComputeEntry {
+
+			uint64_t hash;
+			vkInit::ComputePipelineState state;
+			vkInit::ComputePipelineOutBundle output;
+			PipelineStatus status;
+
+		};
+
+		struct RenderPassEntry {
+
+			vk::Format swapchain_image_format;
+			vk::Format depth_format;
+			bool depth_prepass;
+			vkInit::RenderPassStage stage;
+			vk::RenderPass render_pass;
+
+		};
+
+		// Keyed by the share of the state the part is built from, and by the layout for the parts with shaders
+		struct LibraryEntry {
+
+			vk::GraphicsPipelineLibraryFlagBitsEXT part;
+			uint64_t hash;
+			vkInit::GraphicsPipelineState key;
+			vk::PipelineLayout layout;
+			vk::Pipeline library;
+
+		};
+
+		struct LayoutEntry {
+
+			std::vector<vk::DescriptorSetLayout> descriptor_set_layouts;
+			std::vector<vk::PushConstantRange> push_constant_ranges;
+			vk::PipelineLayout layout;
+
+		};
+
+		bool debug;
+		vk::Device logical_device;
+		ShaderCompiler* shader_compiler;
+		DescriptorSetLayoutCache* layout_cache;
+		jobs::JobSystem* job_system;
+		bool pipeline_libraries;
+		vk::PipelineCache pipeline_cache;
+
+		// Never held while building a pipeline, so one slow pipeline doesn't stall the others
+		std::mutex mutex;
+		// Signalled whenever an entry stops building
+		std::condition_variable build_finished;
+		jobs::Counter build_jobs;
+		jobs::Counter optimize_jobs;
+		std::vector<GraphicsEntry> graphics_pipelines;
+		std::vector<ComputeEntry> compute_pipelines;
+		std::vector<RenderPassEntry> render_passes;
+		std::vector<LayoutEntry> layouts;
+		std::vector<GraphicsEntry> rebuilt_graphics_pipelines;
+		std::vector<ComputeEntry> rebuilt_compute_pipelines;
+		std::vector<LibraryEntry> libraries;
+		std::vector<PipelineUpgrade> upgrades;
+		PipelineCacheStatistics statistics;
+
+		// Linked from libraries when they are in use, otherwise built whole
+		vkInit::GraphicsPipelineOutBundle buildGraphicsPipeline(const vkInit::GraphicsPipelineState& state);
+		vkInit::ComputePipelineOutBundle buildComputePipeline(const vkInit::ComputePipelineState& state);
+
+		vkInit::GraphicsPipelineOutBundle linkGraphicsPipeline(const vkInit::GraphicsPipelineState& state, bool optimize);
+		// Takes the specification's state resolved by compileGraphicsShaders, null if the part fails to build
+		vk::Pipeline getPipelineLibrary(vk::GraphicsPipelineLibraryFlagBitsEXT part, const vkInit::GraphicsPipelineInBundle& specification,
+										const vkInit::GraphicsShaders& shaders, vk::PipelineLayout layout, vk::RenderPass render_pass);
+		// Queues the optimized build of a linked pipeline that just went into the cache
+		void optimizeLinkedPipeline(uint64_t hash, const vkInit::GraphicsPipelineState& state, vk::Pipeline linked);
+		void finishOptimizedBuild(uint64_t hash, const vkInit::GraphicsPipelineState& state, vk::Pipeline linked, vk::Pipeline optimized);
+
+		// Store a build in the entry marked as building, returns what the entry holds afterwards
+		vkInit::GraphicsPipelineOutBundle finishGraphicsBuild(uint64_t hash, const vkInit::GraphicsPipelineState& state,
+															  vkInit::GraphicsPipelineOutBundle output);
+		vkInit::ComputePipelineOutBundle finishComputeBuild(uint64_t hash, const vkInit::ComputePipelineState& state,
+															vkInit::ComputePipelineOutBundle output);
+
+	};
+
+}
@@ -0,0 +1,132 @@
+#include "PipelineState.hpp"
+#include "Hash.hpp"
+
+namespace vkInit {
+
+	namespace {
+
+		uint64_t hashSetLayouts(const std::vector<vk::DescriptorSetLayout>& layouts, uint64_t hash) {
+
+			hash = vkUtil::hashValue(layouts.size(), hash);
+
+			for (vk::DescriptorSetLayout layout : layouts) {
+
+				hash = vkUtil::hashValue(static_cast<VkDescriptorSetLayout>(layout), hash);
+
+			}
+
+			return hash;
+
+		}
+
+		uint64_t hashPermutation(const vkUtil::ShaderPermutation& permutation, uint64_t hash) {
+
+			hash = vkUtil::hashValue(permutation.defines.size(), hash);
+
+			for (const vkUtil::ShaderDefine& define : permutation.defines) {
+
+				hash = vkUtil::hashString(define.name, hash);
+				hash = vkUtil::hashString(define.value, hash);
+
+			}
+
+			hash = vkUtil::hashValue(permutation.constants.size(), hash);
+
+			for (const vkUtil::SpecializationConstant& constant : permutation.constants) {
+
+				hash = vkUtil::hashValue(constant.id, hash);
+				hash = vkUtil::hashValue(constant.value, hash);
+
+			}
+
+			return hash;
+
+		}
+
+	}
+
+	bool GraphicsPipelineState::operator==(const GraphicsPipelineState& other) const {
+
+		return vertex_file_path == other.vertex_file_path
+			&& fragment_file_path == other.fragment_file_path
+			&& vertex_permutation == other.vertex_permutation
+			&& fragment_permutation == other.fragment_permutation
+			&& vertex_bindings == other.vertex_bindings
+			&& vertex_attributes == other.vertex_attributes
+			&& descriptor_set_layouts == other.descriptor_set_layouts
+			&& swapchain_extent == other.swapchain_extent
+			&& cull_mode == other.cull_mode
+			&& blend == other.blend
+			&& depth_test == other.depth_test
+			&& depth_write == other.depth_write
+			&& depth_compare_op == other.depth_compare_op
+			&& swapchain_image_format == other.swapchain_image_format
+			&& depth_format == other.depth_format
+			&& depth_prepass == other.depth_prepass
+			&& render_pass_stage == other.render_pass_stage
+			&& subpass == other.subpass;
+
+	}
+
+	uint64_t GraphicsPipelineState::hash() const {
+
+		uint64_t hash = vkUtil::hash_seed;
+		hash = vkUtil::hashString(vertex_file_path, hash);
+		hash = vkUtil::hashString(fragment_file_path, hash);
+		hash = hashPermutation(vertex_permutation, hash);
+		hash = hashPermutation(fragment_permutation, hash);
+
+		hash = vkUtil::hashValue(vertex_bindings.size(), hash);
+
+		for (const vk::VertexInputBindingDescription& binding : vertex_bindings) {
+
+			hash = vkUtil::hashValue(binding.binding, hash);
+			hash = vkUtil::hashValue(binding.stride, hash);
+			hash = vkUtil::hashValue(binding.inputRate, hash);
+
+		}
+
+		hash = vkUtil::hashValue(vertex_attributes.size(), hash);
+
+		for (const vk::VertexInputAttributeDescription& attribute : vertex_attributes) {
+
+			hash = vkUtil::hashValue(attribute.location, hash);
+			hash = vkUtil::hashValue(attribute.binding, hash);
+			hash = vkUtil::hashValue(attribute.format, hash);
+			hash = vkUtil::hashValue(attribute.offset, hash);
+
+		}
+
+		hash = hashSetLayouts(descriptor_set_layouts, hash);
+		hash = vkUtil::hashValue(swapchain_extent.width, hash);
+		hash = vkUtil::hashValue(swapchain_extent.height, hash);
+		hash = vkUtil::hashValue(static_cast<VkCullModeFlags>(cull_mode), hash);
+		hash = vkUtil::hashValue(blend, hash);
+		hash = vkUtil::hashValue(depth_test, hash);
+		hash = vkUtil::hashValue(depth_write, hash);
+		hash = vkUtil::hashValue(depth_compare_op, hash);
+		hash = vkUtil::hashValue(swapchain_image_format, hash);
+		hash = vkUtil::hashValue(depth_format, hash);
+		hash = vkUtil::hashValue(depth_prepass, hash);
+		hash = vkUtil::hashValue(render_pass_stage, hash);
+		return vkUtil::hashValue(subpass, hash);
+
+	}
+
+	bool ComputePipelineState::operator==(const ComputePipelineState& other) const {
+
+		return compute_file_path == other.compute_file_path
+			&& permutation == other.permutation
+			&& descriptor_set_layouts == other.descriptor_set_layouts;
+
+	}
+
+	uint64_t ComputePipelineState::hash() const {
+
+		uint64_t hash = vkUtil::hashString(compute_file_path, vkUtil::hash_seed);
+		hash = hashPermutation(permutation, hash);
+		return hashSetLayouts(descriptor_set_layouts, hash);
+
+	}
+
+}
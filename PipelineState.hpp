@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ShaderPermutation.hpp"
+
+namespace vkInit {
+
+	// Where a render pass sits when a frame's drawing is split across several passes
+	enum class RenderPassStage {
+
+		eOnly,		// clears, then presents
+		eFirst,		// clears, keeps color and depth for a following pass
+		eLast		// continues a previous pass, then presents
+
+	};
+
+	// Everything a graphics pipeline is built from, and the pipeline manager's cache key
+	struct GraphicsPipelineState {
+
+		// GLSL sources under the compiler's shader directory, no fragment shader for depth-only pipelines
+		std::string vertex_file_path;
+		std::string fragment_file_path;
+		vkUtil::ShaderPermutation vertex_permutation;
+		vkUtil::ShaderPermutation fragment_permutation;
+
+		std::vector<vk::VertexInputBindingDescription> vertex_bindings;
+		// Left empty, attributes are reflected from the vertex shader's inputs, packed in location order into binding 0
+		std::vector<vk::VertexInputAttributeDescription> vertex_attributes;
+		// Layouts the caller allocates descriptor sets from, checked against what the shaders declare.
+		// Sets past the end or left null get a layout reflected from the shaders
+		std::vector<vk::DescriptorSetLayout> descriptor_set_layouts;
+
+		vk::Extent2D swapchain_extent;
+		vk::CullModeFlags cull_mode;
+		bool blend;
+		bool depth_test;
+		bool depth_write;
+		vk::CompareOp depth_compare_op;
+
+		// Render pass compatibility. Pipelines agreeing on these share one render pass
+		vk::Format swapchain_image_format;
+		vk::Format depth_format;
+		// Render pass variant with a depth-only subpass 0 ahead of the color subpass 1
+		bool depth_prepass;
+		RenderPassStage render_pass_stage;
+		uint32_t subpass;
+
+		bool operator==(const GraphicsPipelineState& other) const;
+		uint64_t hash() const;
+
+	};
+
+	struct ComputePipelineState {
+
+		std::string compute_file_path;
+		vkUtil::ShaderPermutation permutation;
+		// Checked against the shader, as for graphics pipelines. The push constant range is reflected
+		std::vector<vk::DescriptorSetLayout> descriptor_set_layouts;
+
+		bool operator==(const ComputePipelineState& other) const;
+		uint64_t hash() const;
+
+	};
+
+	struct GraphicsPipelineOutBundle {
+
+		vk::PipelineLayout layout;
+		vk::RenderPass render_pass;
+		vk::Pipeline pipeline;
+
+	};
+
+	struct ComputePipelineOutBundle {
+
+		vk::PipelineLayout layout;
+		vk::Pipeline pipeline;
+
+	};
+
+}
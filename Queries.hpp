@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
+#include <iostream>
+
+namespace vkInit {
+
+	vk::QueryPool makeQueryPool(const bool& debug, vk::Device logical_device, vk::QueryType query_type, uint32_t query_count) {
+
+		vk::QueryPoolCreateInfo query_pool_info = {};
+		query_pool_info.flags = vk::QueryPoolCreateFlags();
+		query_pool_info.queryType = query_type;
+		query_pool_info.queryCount = query_count;
+
+		try {
+
+			return logical_device.createQueryPool(query_pool_info, vkUtil::hostAllocator());
+
+		}
+		catch (vk::SystemError err) {
+
+			if (debug) {
+
+				std::cout << "Failed to create query pool" << std::endl;
+
+			}
+
+			return nullptr;
+
+		}
+
+	}
+
+}
@@ -12,6 +12,8 @@ namespace vkUtil {
 
 		std::optional<uint32_t> graphics_family;
 		std::optional<uint32_t> present_family;
+		// A family that computes but can't draw, for async compute. Left empty when every compute family also draws
+		std::optional<uint32_t> compute_family;
 
 		bool isComplete() {
 
@@ -68,6 +70,27 @@ namespace vkUtil {
 
 		}
 
+		// The loop above stops early, so look for a compute-only family on its own
+		for (uint32_t j = 0; j < queue_families.size(); ++j) {
+
+			vk::QueueFlags flags = queue_families[j].queueFlags;
+
+			if ((flags & vk::QueueFlagBits::eCompute) && !(flags & vk::QueueFlagBits::eGraphics)) {
+
+				indices.compute_family = j;
+
+				if (debug) {
+
+					std::cout << "Queue family " << j << " is suitable for async compute. \n";
+
+				}
+
+				break;
+
+			}
+
+		}
+
 		return indices;
 
 	}
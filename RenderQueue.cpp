@@ -0,0 +1,127 @@
+#include "RenderQueue.hpp"
+#include <cstring>
+#include <utility>
+
+namespace vkUtil {
+
+	uint64_t RenderQueue::makeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) {
+
+		// Non-negative floats order the same as their bit patterns, the top bits keep that order
+		uint32_t depth_pattern = 0;
+
+		if (depth > 0.0f) {
+
+			std::memcpy(&depth_pattern, &depth, sizeof(depth_pattern));
+
+		}
+
+		uint64_t key = static_cast<uint64_t>(pipeline & ((1u << pipeline_bits) - 1));
+		key = (key << material_bits) | (material & ((1u << material_bits) - 1));
+		key = (key << mesh_bits) | (mesh & ((1u << mesh_bits) - 1));
+		key = (key << depth_bits) | (depth_pattern >> (32 - depth_bits));
+
+		return key;
+
+	}
+
+	uint32_t RenderQueue::getPipeline(uint64_t key) {
+
+		return static_cast<uint32_t>(key >> (material_bits + mesh_bits + depth_bits));
+
+	}
+
+	uint32_t RenderQueue::getMaterial(uint64_t key) {
+
+		return static_cast<uint32_t>(key >> (mesh_bits + depth_bits)) & ((1u << material_bits) - 1);
+
+	}
+
+	uint32_t RenderQueue::getMesh(uint64_t key) {
+
+		return static_cast<uint32_t>(key >> depth_bits) & ((1u << mesh_bits) - 1);
+
+	}
+
+	uint64_t RenderQueue::getState(uint64_t key) {
+
+		return key >> depth_bits;
+
+	}
+
+	void RenderQueue::begin(FrameArena& arena, uint32_t capacity) {
+
+		draws = arena.allocateArray<QueuedDraw>(capacity);
+		scratch = arena.allocateArray<QueuedDraw>(capacity);
+		count = 0;
+
+	}
+
+	void RenderQueue::add(uint64_t key, uint32_t item) {
+
+		draws[count++] = { key, item };
+
+	}
+
+	void RenderQueue::sort() {
+
+		// Every histogram in one read of the keys
+		uint32_t histograms[8][256] = {};
+
+		for (uint32_t i = 0; i < count; ++i) {
+
+			const QueuedDraw& draw = draws[i];
+
+			for (uint32_t digit = 0; digit < 8; ++digit) {
+
+				++histograms[digit][(draw.key >> (8 * digit)) & 0xFF];
+
+			}
+
+		}
+
+		for (uint32_t digit = 0; digit < 8; ++digit) {
+
+			uint32_t* histogram = histograms[digit];
+
+			// One bucket holding everything means every key has this byte in common
+			if (count == 0 || histogram[(draws[0].key >> (8 * digit)) & 0xFF] == count) {
+
+				continue;
+
+			}
+
+			uint32_t offset = 0;
+
+			for (uint32_t bucket = 0; bucket < 256; ++bucket) {
+
+				uint32_t bucket_size = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucket_size;
+
+			}
+
+			for (uint32_t i = 0; i < count; ++i) {
+
+				scratch[histogram[(draws[i].key >> (8 * digit)) & 0xFF]++] = draws[i];
+
+			}
+
+			std::swap(draws, scratch);
+
+		}
+
+	}
+
+	const QueuedDraw* RenderQueue::getDraws() const {
+
+		return draws;
+
+	}
+
+	uint32_t RenderQueue::getDrawCount() const {
+
+		return count;
+
+	}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include "FrameArena.hpp"
+
+namespace vkUtil {
+
+	// A draw in the queue, item indexes whatever list the draws were made from
+	struct QueuedDraw {
+
+		uint64_t key;
+		uint32_t item;
+
+	};
+
+	// Orders a frame's draws by a 64-bit key so draws sharing state end up next to each other. From the top:
+	// 8 bits of pipeline, 12 of material, 16 of mesh and 28 of depth, so state changes are sorted out first
+	// and draws with the same state go nearest first.
+	class RenderQueue {
+
+	public:
+
+		static const uint32_t pipeline_bits = 8;
+		static const uint32_t material_bits = 12;
+		static const uint32_t mesh_bits = 16;
+		static const uint32_t depth_bits = 28;
+
+		// Ids past their field's range are wrapped, negative depths count as zero
+		static uint64_t makeKey(uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+		static uint32_t getPipeline(uint64_t key);
+		static uint32_t getMaterial(uint64_t key);
+		static uint32_t getMesh(uint64_t key);
+		// Everything above the depth, equal for draws that can share one draw command
+		static uint64_t getState(uint64_t key);
+
+		// Drops the previous draws and takes room for capacity new ones, and the sort's scratch, from arena
+		void begin(FrameArena& arena, uint32_t capacity);
+		// At most the capacity given to begin
+		void add(uint64_t key, uint32_t item);
+
+		// LSD radix sort a byte at a time, skipping bytes every key shares
+		void sort();
+
+		const QueuedDraw* getDraws() const;
+		uint32_t getDrawCount() const;
+
+	private:
+
+		QueuedDraw* draws = nullptr;
+		QueuedDraw* scratch = nullptr;
+		uint32_t count = 0;
+
+	};
+
+}
@@ -9,6 +9,50 @@ namespace vkUtil {
 	struct ObjectData {
 
 		glm::mat4 model;
+		glm::mat4 view_projection;
+
+	};
+
+	// Push constants of Shaders/shader.vert, depth-only or not, world matrices are read from the transform buffer
+	struct SceneDrawData {
+
+		glm::mat4 view_projection;
+
+	};
+
+	struct MeshletCullData {
+
+		glm::vec4 frustum[6];
+		glm::vec4 camera_position;
+
+	};
+
+	struct OcclusionCullData {
+
+		glm::mat4 view;
+		glm::vec4 frustum;		// x, z of the side plane normals, then y, z of the top/bottom plane normals
+		glm::vec4 projection;	// P00, P11, P22, P32
+		glm::vec4 pyramid;		// level 0 width, height, level count, near plane
+		uint32_t object_count;
+		uint32_t late_offset;
+
+	};
+
+	struct FrameStatistics {
+
+		// GPU times in milliseconds, measured with timestamp queries
+		float gpu_frame_time;
+		// With occlusion culling this spans the early pass instead
+		float depth_prepass_time;
+		float shading_time;
+
+		// Recorded for CPU-culled scene draws, across every pass. Each batch is one draw command
+		// covering draw_count / batch_count objects on average
+		uint32_t draw_count;
+		uint32_t batch_count;
+		float average_batch_size;
+		uint32_t pipeline_binds;
+		uint32_t descriptor_set_binds;
 
 	};
 
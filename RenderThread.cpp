@@ -0,0 +1,80 @@
+#include "RenderThread.hpp"
+#include <chrono>
+
+namespace {
+
+	// Bounds how long the main thread stops handling events if the render thread stalls
+	const std::chrono::milliseconds handoff_timeout(100);
+
+}
+
+RenderThread::RenderThread(Engine* engine) {
+
+	this->engine = engine;
+	snapshot_waiting = false;
+	running = true;
+
+	thread = std::thread(&RenderThread::renderLoop, this);
+
+}
+
+RenderThread::~RenderThread() {
+
+	{
+
+		std::lock_guard<std::mutex> lock(handoff_mutex);
+		running = false;
+
+	}
+
+	handoff_condition.notify_all();
+	thread.join();
+
+}
+
+SceneSnapshot& RenderThread::getSnapshot() {
+
+	return snapshots.getWriteBuffer();
+
+}
+
+void RenderThread::publish() {
+
+	std::unique_lock<std::mutex> lock(handoff_mutex);
+
+	snapshots.publish();
+	snapshot_waiting = true;
+	handoff_condition.notify_all();
+
+	handoff_condition.wait_for(lock, handoff_timeout, [this]() { return !snapshot_waiting; });
+
+}
+
+void RenderThread::renderLoop() {
+
+	while (true) {
+
+		{
+
+			std::unique_lock<std::mutex> lock(handoff_mutex);
+			handoff_condition.wait(lock, [this]() { return !running || snapshot_waiting; });
+
+			if (!running) {
+
+				return;
+
+			}
+
+			snapshots.acquire();
+			snapshot_waiting = false;
+
+		}
+
+		// Lets the main thread start on the next snapshot while this one renders
+		handoff_condition.notify_all();
+
+		engine->render(snapshots.getReadBuffer());
+
+	}
+
+}
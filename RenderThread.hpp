@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "Engine.hpp"
+#include "TripleBuffer.hpp"
+
+// Renders on its own thread from snapshots the main thread publishes, so event handling and simulation
+// of the next frame overlap with recording and submitting this one. The engine is used only from the
+// render thread while it runs, but is created and destroyed by the caller.
+class RenderThread {
+
+public:
+
+	RenderThread(Engine* engine);
+	// Finishes the frame in progress and joins, the engine can be destroyed afterwards
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	// Main thread only, the snapshot to fill before publishing
+	SceneSnapshot& getSnapshot();
+
+	// Main thread only. Replaces any snapshot the render thread has not started yet, then waits until the
+	// render thread picks this one up, so simulation runs at most one frame ahead of rendering
+	void publish();
+
+private:
+
+	Engine* engine;
+	vkUtil::TripleBuffer<SceneSnapshot> snapshots;
+
+	// Guards the triple buffer's swaps only, snapshots are filled and rendered outside it
+	std::mutex handoff_mutex;
+	std::condition_variable handoff_condition;
+	bool snapshot_waiting;
+	bool running;
+
+	std::thread thread;
+
+	void renderLoop();
+
+};
@@ -1,15 +1,360 @@
 #include "Scene.hpp"
+#include "Allocations.hpp"
+#include <glm/glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <limits>
 
-Scene::Scene() {
+namespace {
+
+	// Below this many moving objects a single thread queries the grid faster than several
+	const size_t parallel_query_threshold = 16384;
+
+}
+
+Scene::Scene(jobs::JobSystem* job_system) : grid(0.5f) {
+
+	this->job_system = job_system;
+
+	camera_position = glm::vec3(0.0f, 0.0f, -2.5f);
+	camera_target = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	static_rebuild_needed = false;
+	static_refit_needed = false;
 
 	for (float x = -1.0f; x < 1.0f; x += 0.2f) {
 
 		for (float y = -1.0f; y < 1.0f; y += 0.2f) {
 
-			triangle_positions.push_back(glm::vec3(x, y, 0.0f));
+			addObject(glm::vec3(x, y, 0.0f), SpatialClass::eDynamic);
 
 		}
 
 	}
 
+}
+
+glm::mat4 Scene::localMatrix(const Transform& transform) const {
+
+	return glm::translate(glm::mat4(1.0f), transform.position) * glm::mat4_cast(transform.rotation);
+
+}
+
+vkUtil::AABB Scene::objectBounds(const glm::mat4& world) const {
+
+	// Matches the corners in Shaders/shader.vert
+	const glm::vec3 half_extent = glm::vec3(0.05f, 0.05f, 0.0f);
+
+	glm::vec3 center = glm::vec3(world[3]);
+	glm::vec3 extent = glm::abs(glm::vec3(world[0])) * half_extent.x + glm::abs(glm::vec3(world[1])) * half_extent.y
+		+ glm::abs(glm::vec3(world[2])) * half_extent.z;
+
+	return { center - extent, center + extent };
+
+}
+
+ecs::Entity Scene::addObject(const glm::vec3& position, SpatialClass spatial_class, ecs::Entity parent) {
+
+	ecs::Entity object = spatial_class == SpatialClass::eDynamic
+		? entities.create<Transform, vkUtil::AABB, Renderable>()
+		: entities.create<Transform, vkUtil::AABB, Renderable, StaticBody>();
+
+	Transform* transform = entities.get<Transform>(object);
+	transform->position = position;
+	transform->rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+
+	// Every corner of the triangle lies within this of its position
+	Renderable* renderable = entities.get<Renderable>(object);
+	renderable->bounding_radius = 0.0708f;
+	renderable->mesh = 0;
+	renderable->material = 0;
+
+	uint32_t parent_index = isAlive(parent) ? parent.index : vkUtil::TransformHierarchy::no_parent;
+	glm::mat4 local = localMatrix(*transform);
+	hierarchy.insert(object.index, parent_index, local);
+
+	// Placed with the parent's last computed matrix, the next update corrects it
+	glm::mat4 world = parent_index == vkUtil::TransformHierarchy::no_parent ? local : hierarchy.getWorld(parent_index) * local;
+	vkUtil::AABB bounds = objectBounds(world);
+	*entities.get<vkUtil::AABB>(object) = bounds;
+
+	if (spatial_class == SpatialClass::eDynamic) {
+
+		grid.insert(object.index, bounds);
+
+	}
+	else {
+
+		entities.get<StaticBody>(object)->bvh_slot = static_cast<uint32_t>(static_objects.size());
+		static_objects.push_back(object.index);
+		static_bounds.push_back(bounds);
+		static_rebuild_needed = true;
+
+	}
+
+	return object;
+
+}
+
+void Scene::moveObject(ecs::Entity object, const glm::vec3& position) {
+
+	if (!isAlive(object)) {
+
+		return;
+
+	}
+
+	Transform* transform = entities.get<Transform>(object);
+	transform->position = position;
+	hierarchy.setLocal(object.index, localMatrix(*transform));
+
+}
+
+void Scene::rotateObject(ecs::Entity object, const glm::quat& rotation) {
+
+	if (!isAlive(object)) {
+
+		return;
+
+	}
+
+	Transform* transform = entities.get<Transform>(object);
+	transform->rotation = rotation;
+	hierarchy.setLocal(object.index, localMatrix(*transform));
+
+}
+
+bool Scene::attachObject(ecs::Entity object, ecs::Entity parent) {
+
+	if (!isAlive(object)) {
+
+		return false;
+
+	}
+
+	return hierarchy.setParent(object.index, isAlive(parent) ? parent.index : vkUtil::TransformHierarchy::no_parent);
+
+}
+
+void Scene::removeObject(ecs::Entity object) {
+
+	if (!isAlive(object)) {
+
+		return;
+
+	}
+
+	// Copied, each removal edits the list
+	std::vector<uint32_t> attached = hierarchy.getChildren(object.index);
+
+	for (uint32_t child : attached) {
+
+		removeObject(entities.getEntity(child));
+
+	}
+
+	hierarchy.remove(object.index);
+
+	if (const StaticBody* static_body = entities.get<StaticBody>(object)) {
+
+		uint32_t slot = static_body->bvh_slot;
+		uint32_t last_object = static_objects.back();
+
+		static_objects[slot] = last_object;
+		static_bounds[slot] = static_bounds.back();
+		entities.get<StaticBody>(entities.getEntity(last_object))->bvh_slot = slot;
+		static_objects.pop_back();
+		static_bounds.pop_back();
+		static_rebuild_needed = true;
+
+	}
+	else {
+
+		grid.remove(object.index);
+
+	}
+
+	entities.destroy(object);
+
+}
+
+void Scene::updateBounds(ecs::Entity object, const vkUtil::AABB& bounds) {
+
+	*entities.get<vkUtil::AABB>(object) = bounds;
+
+	if (const StaticBody* static_body = entities.get<StaticBody>(object)) {
+
+		static_bounds[static_body->bvh_slot] = bounds;
+		static_refit_needed = true;
+
+	}
+	else {
+
+		grid.move(object.index, bounds);
+
+	}
+
+}
+
+void Scene::updateTransforms() {
+
+	changed_objects.clear();
+	hierarchy.update(job_system, changed_objects);
+
+	for (uint32_t object : changed_objects) {
+
+		updateBounds(entities.getEntity(object), objectBounds(hierarchy.getWorld(object)));
+
+	}
+
+}
+
+bool Scene::isAlive(ecs::Entity object) const {
+
+	return entities.isAlive(object);
+
+}
+
+uint32_t Scene::getObjectSlotCount() const {
+
+	return entities.getEntitySlotCount();
+
+}
+
+glm::vec3 Scene::getPosition(uint32_t object) const {
+
+	return glm::vec3(hierarchy.getWorld(object)[3]);
+
+}
+
+const ecs::EntityStore& Scene::getEntities() const {
+
+	return entities;
+
+}
+
+void Scene::makeCameraMatrices(float aspect_ratio, glm::mat4& view, glm::mat4& projection) const {
+
+	view = glm::lookAtLH(camera_position, camera_target, glm::vec3(0.0f, 1.0f, 0.0f));
+	projection = glm::perspectiveLH_ZO(glm::radians(45.0f), aspect_ratio, 0.1f, 100.0f);
+
+}
+
+void Scene::extractSnapshot(float aspect_ratio, SceneSnapshot& snapshot) {
+
+	allocations::Scope allocation_scope(allocations::Subsystem::eScene);
+
+	// Extraction starts the scene's frame, the scratch its jobs left behind last frame is dead
+	if (job_system) {
+
+		job_system->resetThreadArenas();
+
+	}
+
+	updateTransforms();
+
+	makeCameraMatrices(aspect_ratio, snapshot.view, snapshot.projection);
+	snapshot.camera_position = camera_position;
+
+	// The renderer finished with this snapshot's last frame before it was handed back
+	snapshot.arena.reset();
+
+	cullFrustum(vkUtil::extractFrustum(snapshot.projection * snapshot.view), visible_objects);
+
+	snapshot.item_count = static_cast<uint32_t>(visible_objects.size());
+	snapshot.items = snapshot.arena.allocateArray<RenderItem>(snapshot.item_count);
+
+	glm::vec4 view_depth_row = glm::vec4(snapshot.view[0][2], snapshot.view[1][2], snapshot.view[2][2], snapshot.view[3][2]);
+
+	for (uint32_t i = 0; i < snapshot.item_count; ++i) {
+
+		uint32_t object = visible_objects[i];
+		const Renderable* renderable = entities.get<Renderable>(entities.getEntity(object));
+
+		RenderItem& item = snapshot.items[i];
+		item.world = hierarchy.getWorld(object);
+		item.object = object;
+		item.mesh = renderable->mesh;
+		item.material = renderable->material;
+		item.depth = glm::dot(view_depth_row, item.world[3]);
+
+	}
+
+	snapshot.object_count = static_cast<uint32_t>(entities.getEntityCount());
+	snapshot.object_spheres = snapshot.arena.allocateArray<glm::vec4>(snapshot.object_count);
+
+	// Chunks hold only live objects, the GPU never sees scene object indices
+	glm::vec4* spheres = snapshot.object_spheres;
+
+	entities.forEachChunk<const vkUtil::AABB, const Renderable>([&spheres](const ecs::Entity*, uint32_t count,
+		const vkUtil::AABB* bounds, const Renderable* renderables) {
+
+		for (uint32_t i = 0; i < count; ++i) {
+
+			glm::vec3 center = 0.5f * (bounds[i].min + bounds[i].max);
+			*spheres++ = glm::vec4(center, renderables[i].bounding_radius);
+
+		}
+
+	});
+
+}
+
+void Scene::updateStaticHierarchy() {
+
+	if (static_rebuild_needed) {
+
+		bvh.build(static_bounds, job_system);
+
+	}
+	else if (static_refit_needed) {
+
+		bvh.refit(static_bounds);
+
+	}
+
+	static_rebuild_needed = false;
+	static_refit_needed = false;
+
+}
+
+void Scene::cullFrustum(const vkUtil::Frustum& frustum, std::vector<uint32_t>& visible_objects) {
+
+	if (job_system && grid.getObjectCount() >= parallel_query_threshold) {
+
+		grid.queryFrustumParallel(frustum, visible_objects, *job_system);
+
+	}
+	else {
+
+		grid.queryFrustum(frustum, visible_objects);
+
+	}
+
+	updateStaticHierarchy();
+	bvh.cullFrustum(static_bounds, frustum, static_visible);
+
+	for (uint32_t slot : static_visible) {
+
+		visible_objects.push_back(static_objects[slot]);
+
+	}
+
+}
+
+vkUtil::RayHit Scene::pick(const glm::vec3& origin, const glm::vec3& direction) {
+
+	updateStaticHierarchy();
+
+	vkUtil::RayHit hit = bvh.raycast(static_bounds, origin, direction, std::numeric_limits<float>::max());
+
+	if (hit.hit) {
+
+		hit.object = static_objects[hit.object];
+
+	}
+
+	vkUtil::RayHit dynamic_hit = grid.raycast(origin, direction, hit.distance);
+
+	return dynamic_hit.hit ? dynamic_hit : hit;
+
 }
\ No newline at end of file
@@ -1,15 +1,112 @@
 #pragma once
 
 #include <glm/glm/glm.hpp>
+#include <glm/glm/gtc/quaternion.hpp>
 #include <vector>
+#include "Bvh.hpp"
+#include "SpatialGrid.hpp"
+#include "EntityStore.hpp"
+#include "JobSystem.hpp"
+#include "TransformHierarchy.hpp"
+#include "SceneSnapshot.hpp"
+
+enum class SpatialClass {
+
+	eStatic,	// rarely moves, kept in the BVH
+	eDynamic	// moves often, kept in the loose grid
+
+};
+
+// Relative to the parent, world matrices live in the scene's transform hierarchy
+struct Transform {
+
+	glm::vec3 position;
+	glm::quat rotation;
+
+};
+
+struct Renderable {
+
+	float bounding_radius;
+	// Resolved by the renderer, every object uses mesh 0 and material 0 so far
+	uint32_t mesh;
+	uint32_t material;
+
+};
+
+// Only on static objects, the entry in the packed BVH arrays
+struct StaticBody {
+
+	uint32_t bvh_slot;
+
+};
 
 class Scene {
 
 public:
 
-	Scene();
-	std::vector<glm::vec3> triangle_positions;
+	// Jobs split culling, BVH builds and transform updates, a null job system runs them inline
+	Scene(jobs::JobSystem* job_system);
+
+	ecs::Entity addObject(const glm::vec3& position, SpatialClass spatial_class, ecs::Entity parent = ecs::null_entity);
+
+	// Local changes reach world matrices and bounds on the next updateTransforms
+	void moveObject(ecs::Entity object, const glm::vec3& position);
+	void rotateObject(ecs::Entity object, const glm::quat& rotation);
+	// A null parent makes the object a root, fails if the parent is attached below the object
+	bool attachObject(ecs::Entity object, ecs::Entity parent);
+
+	// Objects attached below it are removed with it
+	void removeObject(ecs::Entity object);
+	bool isAlive(ecs::Entity object) const;
+
+	// Recomputes world matrices of moved subtrees and refreshes their bounds
+	void updateTransforms();
+
+	// Culling and picking report entity indices, these look them up without a handle
+	uint32_t getObjectSlotCount() const;
+	glm::vec3 getPosition(uint32_t object) const;
+
+	const ecs::EntityStore& getEntities() const;
+
+	void makeCameraMatrices(float aspect_ratio, glm::mat4& view, glm::mat4& projection) const;
+
+	// Updates transforms, then copies what the renderer needs into a flat list in the snapshot's arena.
+	// Once it returns the scene can change again, the framebuffer size is left to the caller. Resets the
+	// job system's thread arenas first, nothing else may be using them meanwhile
+	void extractSnapshot(float aspect_ratio, SceneSnapshot& snapshot);
+
+	void cullFrustum(const vkUtil::Frustum& frustum, std::vector<uint32_t>& visible_objects);
+
+	vkUtil::RayHit pick(const glm::vec3& origin, const glm::vec3& direction);
+
+	glm::vec3 camera_position;
+	glm::vec3 camera_target;
+
+private:
+
+	jobs::JobSystem* job_system;
+
+	// Transform, AABB and Renderable on every object, StaticBody on static ones
+	ecs::EntityStore entities;
+
+	// Static objects are packed for the BVH, StaticBody maps an object to its packed entry
+	std::vector<vkUtil::AABB> static_bounds;
+	std::vector<uint32_t> static_objects;
+	bool static_rebuild_needed;
+	bool static_refit_needed;
+	vkUtil::Bvh bvh;
+	std::vector<uint32_t> static_visible;
+
+	vkUtil::SpatialGrid grid;
 
+	vkUtil::TransformHierarchy hierarchy;
+	std::vector<uint32_t> changed_objects;
+	std::vector<uint32_t> visible_objects;
 
+	glm::mat4 localMatrix(const Transform& transform) const;
+	vkUtil::AABB objectBounds(const glm::mat4& world) const;
+	void updateBounds(ecs::Entity object, const vkUtil::AABB& bounds);
+	void updateStaticHierarchy();
 
-};
\ No newline at end of file
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <cstdint>
+#include "FrameArena.hpp"
+
+// One visible object as the renderer sees it, copied out of the scene
+struct RenderItem {
+
+	glm::mat4 world;
+	uint32_t object;
+	uint32_t mesh;
+	uint32_t material;
+	// Distance along the view axis
+	float depth;
+
+};
+
+// What one frame needs from the scene, copied out so rendering never reads the scene while it changes.
+// The arrays live in the snapshot's own arena, extracting the next frame into it resets them
+struct SceneSnapshot {
+
+	// Size of the window's framebuffer when the snapshot was taken, zero while minimized
+	int framebuffer_width;
+	int framebuffer_height;
+
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 camera_position;
+
+	// Objects that passed frustum culling, in no particular order
+	RenderItem* items = nullptr;
+	uint32_t item_count = 0;
+
+	// Every live object, for culling on the GPU
+	glm::vec4* object_spheres = nullptr;
+	uint32_t object_count = 0;
+
+	vkUtil::FrameArena arena;
+
+};
@@ -0,0 +1,518 @@
+#include "ShaderCompiler.hpp"
+#include "EmbeddedShaders.hpp"
+#include "Hash.hpp"
+#include <spirv-headers/spirv.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+
+namespace vkUtil {
+
+	namespace {
+
+		// Part of every cache key, bump it when the cache layout or compile settings change meaning
+		const char* cache_version = "spirv-cache-2";
+
+		const uint32_t spirv_magic = 0x07230203;
+
+		bool readText(const std::string& path, std::string& text) {
+
+			std::ifstream file(path, std::ios::binary);
+
+			if (!file.is_open()) {
+
+				return false;
+
+			}
+
+			std::stringstream contents;
+			contents << file.rdbuf();
+			text = contents.str();
+
+			return true;
+
+		}
+
+		// Quoted includes are relative to the including file, bracketed ones to the shader directory
+		std::string resolveInclude(const std::string& requested, bool relative, const std::string& requesting, const std::string& shader_directory) {
+
+			std::filesystem::path base = relative ? std::filesystem::path(requesting).parent_path() : std::filesystem::path(shader_directory);
+			return (base / requested).lexically_normal().generic_string();
+
+		}
+
+		// Finds the #include directives of a source, without evaluating conditionals: a disabled
+		// include only makes the cache key stricter than it needs to be
+		void findIncludes(const std::string& source, std::vector<std::pair<std::string, bool>>& includes) {
+
+			std::istringstream lines(source);
+			std::string line;
+
+			while (std::getline(lines, line)) {
+
+				size_t position = line.find_first_not_of(" \t");
+
+				if (position == std::string::npos || line[position] != '#') {
+
+					continue;
+
+				}
+
+				position = line.find_first_not_of(" \t", position + 1);
+
+				if (position == std::string::npos || line.compare(position, 7, "include") != 0) {
+
+					continue;
+
+				}
+
+				position = line.find_first_not_of(" \t", position + 7);
+
+				if (position == std::string::npos || (line[position] != '"' && line[position] != '<')) {
+
+					continue;
+
+				}
+
+				char terminator = line[position] == '"' ? '"' : '>';
+				size_t end = line.find(terminator, position + 1);
+
+				if (end != std::string::npos) {
+
+					includes.push_back({ line.substr(position + 1, end - position - 1), terminator == '"' });
+
+				}
+
+			}
+
+		}
+
+		// Drops names, source text and line information, the instructions spirv-opt's strip-debug pass removes.
+		// Reflection then sees unnamed resources, only error messages ever showed the names
+		void stripDebugInfo(std::vector<uint32_t>& code) {
+
+			const size_t header_size = 5;
+
+			if (code.size() < header_size) {
+
+				return;
+
+			}
+
+			std::vector<uint32_t> stripped(code.begin(), code.begin() + header_size);
+
+			for (size_t position = header_size; position < code.size();) {
+
+				uint32_t word_count = code[position] >> spv::WordCountShift;
+				spv::Op opcode = static_cast<spv::Op>(code[position] & spv::OpCodeMask);
+
+				// Malformed, the module is left for the driver or the validation layers to reject
+				if (word_count == 0 || position + word_count > code.size()) {
+
+					return;
+
+				}
+
+				switch (opcode) {
+
+				case spv::OpSourceContinued:
+				case spv::OpSource:
+				case spv::OpSourceExtension:
+				case spv::OpName:
+				case spv::OpMemberName:
+				case spv::OpString:
+				case spv::OpLine:
+				case spv::OpNoLine:
+				case spv::OpModuleProcessed:
+					break;
+				default:
+					stripped.insert(stripped.end(), code.begin() + position, code.begin() + position + word_count);
+					break;
+
+				}
+
+				position += word_count;
+
+			}
+
+			code.swap(stripped);
+
+		}
+
+		shaderc_shader_kind kindFromExtension(const std::string& file_name) {
+
+			static const std::pair<const char*, shaderc_shader_kind> kinds[] = {
+				{ ".vert", shaderc_vertex_shader },
+				{ ".frag", shaderc_fragment_shader },
+				{ ".comp", shaderc_compute_shader },
+				{ ".geom", shaderc_geometry_shader },
+				{ ".tesc", shaderc_tess_control_shader },
+				{ ".tese", shaderc_tess_evaluation_shader },
+				{ ".task", shaderc_task_shader },
+				{ ".mesh", shaderc_mesh_shader }
+			};
+
+			std::string extension = std::filesystem::path(file_name).extension().string();
+
+			for (const std::pair<const char*, shaderc_shader_kind>& kind : kinds) {
+
+				if (extension == kind.first) {
+
+					return kind.second;
+
+				}
+
+			}
+
+			// Lets a #pragma shader_stage in the source decide
+			return shaderc_glsl_infer_from_source;
+
+		}
+
+		class Includer : public shaderc::CompileOptions::IncluderInterface {
+
+		public:
+
+			Includer(const std::string& shader_directory) : shader_directory(shader_directory) {}
+
+			shaderc_include_result* GetInclude(const char* requested_source, shaderc_include_type type, const char* requesting_source,
+											   size_t) override {
+
+				Include* include = new Include;
+				include->name = resolveInclude(requested_source, type == shaderc_include_type_relative, requesting_source, shader_directory);
+
+				// An empty name tells shaderc the include failed, the content becomes the error message
+				if (!readText(include->name, include->content)) {
+
+					include->content = "Failed to read \"" + include->name + "\"";
+					include->name.clear();
+
+				}
+
+				include->result = { include->name.data(), include->name.size(), include->content.data(), include->content.size(), include };
+
+				return &include->result;
+
+			}
+
+			void ReleaseInclude(shaderc_include_result* data) override {
+
+				delete static_cast<Include*>(data->user_data);
+
+			}
+
+		private:
+
+			struct Include {
+
+				std::string name;
+				std::string content;
+				shaderc_include_result result;
+
+			};
+
+			std::string shader_directory;
+
+		};
+
+	}
+
+	ShaderCompiler::ShaderCompiler(bool debug, const std::string& shader_directory, const std::string& cache_directory, bool optimize,
+								   bool embedded) {
+
+		this->debug = debug;
+		this->optimize = optimize;
+		// Decided by the build, the runtime debug flag only turns on logging and validation
+#ifdef NDEBUG
+		this->debug_info = false;
+#else
+		this->debug_info = true;
+#endif
+		this->embedded = embedded;
+		this->shader_directory = shader_directory;
+		this->cache_directory = cache_directory;
+
+	}
+
+	const std::string& ShaderCompiler::getShaderDirectory() const {
+
+		return shader_directory;
+
+	}
+
+	bool ShaderCompiler::readsFile(const std::string& file_name, const std::string& path) {
+
+		std::lock_guard<std::mutex> lock(dependency_mutex);
+		auto entry = dependencies.find(file_name);
+
+		return entry != dependencies.end() && std::find(entry->second.begin(), entry->second.end(), path) != entry->second.end();
+
+	}
+
+	void ShaderCompiler::markChanged(const std::vector<std::string>& paths) {
+
+		std::lock_guard<std::mutex> lock(dependency_mutex);
+
+		for (const std::string& path : paths) {
+
+			if (std::find(changed_files.begin(), changed_files.end(), path) == changed_files.end()) {
+
+				changed_files.push_back(path);
+
+			}
+
+		}
+
+	}
+
+	bool ShaderCompiler::loadEmbedded(const std::string& file_name, const std::vector<ShaderDefine>& defines, std::vector<uint32_t>& code) {
+
+		const EmbeddedShader* shader = embedded ? findEmbeddedShader(file_name, defines, optimize, debug_info) : nullptr;
+
+		if (!shader) {
+
+			return false;
+
+		}
+
+		std::vector<std::string> sources;
+
+		for (const char* const* source = shader->sources; *source; ++source) {
+
+			sources.push_back((std::filesystem::path(shader_directory) / *source).lexically_normal().generic_string());
+
+		}
+
+		std::lock_guard<std::mutex> lock(dependency_mutex);
+
+		for (const std::string& source : sources) {
+
+			if (std::find(changed_files.begin(), changed_files.end(), source) != changed_files.end()) {
+
+				return false;
+
+			}
+
+		}
+
+		// Hot reload still learns which files the module reads
+		dependencies[file_name] = sources;
+		code.assign(shader->code, shader->code + shader->word_count);
+
+		return true;
+
+	}
+
+	void ShaderCompiler::setOptions(shaderc::CompileOptions& options, const std::vector<ShaderDefine>& defines) const {
+
+		options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+		options.SetSourceLanguage(shaderc_source_language_glsl);
+		// shaderc runs spirv-opt's performance recipe: inlining, dead code elimination, constant folding,
+		// unrolling loops marked [[unroll]] and so on
+		options.SetOptimizationLevel(optimize ? shaderc_optimization_level_performance : shaderc_optimization_level_zero);
+		options.SetIncluder(std::make_unique<Includer>(shader_directory));
+
+		if (debug_info) {
+
+			options.SetGenerateDebugInfo();
+
+		}
+
+		for (const ShaderDefine& define : defines) {
+
+			options.AddMacroDefinition(define.name, define.value);
+
+		}
+
+	}
+
+	bool ShaderCompiler::hashSources(const std::string& path, const std::string& source, uint64_t& hash, std::vector<std::string>& visited) const {
+
+		// Include guards make repeats legal, each file only counts once
+		if (std::find(visited.begin(), visited.end(), path) != visited.end()) {
+
+			return true;
+
+		}
+
+		visited.push_back(path);
+		hash = hashString(path, hash);
+		hash = hashString(source, hash);
+
+		std::vector<std::pair<std::string, bool>> includes;
+		findIncludes(source, includes);
+
+		for (const std::pair<std::string, bool>& include : includes) {
+
+			std::string include_path = resolveInclude(include.first, include.second, path, shader_directory);
+			std::string include_source;
+
+			if (!readText(include_path, include_source) || !hashSources(include_path, include_source, hash, visited)) {
+
+				return false;
+
+			}
+
+		}
+
+		return true;
+
+	}
+
+	bool ShaderCompiler::readCache(uint64_t key, std::vector<uint32_t>& code) const {
+
+		std::stringstream name;
+		name << std::hex << key << ".spv";
+
+		std::ifstream file(std::filesystem::path(cache_directory) / name.str(), std::ios::ate | std::ios::binary);
+
+		if (!file.is_open()) {
+
+			return false;
+
+		}
+
+		size_t size = static_cast<size_t>(file.tellg());
+
+		if (size == 0 || size % sizeof(uint32_t) != 0) {
+
+			return false;
+
+		}
+
+		code.resize(size / sizeof(uint32_t));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(code.data()), size);
+
+		return file.good() && code[0] == spirv_magic;
+
+	}
+
+	void ShaderCompiler::writeCache(uint64_t key, const std::vector<uint32_t>& code) const {
+
+		std::stringstream name;
+		name << std::hex << key << ".spv";
+
+		std::error_code error;
+		std::filesystem::create_directories(cache_directory, error);
+
+		// Written aside and renamed into place, so a reader never sees half a file
+		std::filesystem::path path = std::filesystem::path(cache_directory) / name.str();
+		std::filesystem::path temporary_path = path;
+		temporary_path += ".tmp";
+
+		{
+
+			std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(uint32_t));
+
+			if (!file.good()) {
+
+				return;
+
+			}
+
+		}
+
+		std::filesystem::rename(temporary_path, path, error);
+
+	}
+
+	std::vector<uint32_t> ShaderCompiler::compile(const std::string& file_name, const std::vector<ShaderDefine>& defines) {
+
+		std::vector<uint32_t> code;
+
+		if (loadEmbedded(file_name, defines, code)) {
+
+			return code;
+
+		}
+
+		std::string path = (std::filesystem::path(shader_directory) / file_name).lexically_normal().generic_string();
+		std::string source;
+
+		if (!readText(path, source)) {
+
+			if (debug) {
+
+				std::cout << "Failed to load \"" << path << "\"" << std::endl;
+
+			}
+
+			return {};
+
+		}
+
+		uint64_t key = hashString(cache_version, hash_seed);
+		key = hashString(debug_info ? "debug" : "release", key);
+		key = hashString(optimize ? "optimized" : "unoptimized", key);
+
+		for (const ShaderDefine& define : defines) {
+
+			key = hashString(define.name, key);
+			key = hashString(define.value, key);
+
+		}
+
+		std::vector<std::string> visited;
+		bool sources_hashed = hashSources(path, source, key, visited);
+
+		{
+
+			std::lock_guard<std::mutex> lock(dependency_mutex);
+			dependencies[file_name] = visited;
+
+		}
+
+		if (sources_hashed && readCache(key, code)) {
+
+			return code;
+
+		}
+
+		shaderc::CompileOptions options;
+		setOptions(options, defines);
+
+		shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kindFromExtension(file_name), path.c_str(), options);
+
+		if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+
+			if (debug) {
+
+				std::cout << "Failed to compile \"" << path << "\":\n" << result.GetErrorMessage();
+
+			}
+
+			return {};
+
+		}
+
+		code.assign(result.cbegin(), result.cend());
+
+		// Debug builds keep names for RenderDoc and the validation layers
+		if (!debug_info) {
+
+			stripDebugInfo(code);
+
+		}
+
+		if (debug) {
+
+			std::cout << "Compiled \"" << path << "\"" << (result.GetNumWarnings() > 0 ? ":\n" + result.GetErrorMessage() : "\n");
+
+		}
+
+		// An include that couldn't be read but was skipped by the preprocessor leaves no usable key
+		if (sources_hashed) {
+
+			writeCache(key, code);
+
+		}
+
+		return code;
+
+	}
+
+}
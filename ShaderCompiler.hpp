@@ -0,0 +1,76 @@
+#pragma once
+
+#include <shaderc/shaderc.hpp>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+namespace vkUtil {
+
+	struct ShaderDefine {
+
+		std::string name;
+		std::string value;
+
+	};
+
+	// Compiles GLSL to SPIR-V at runtime through shaderc. Results are cached on disk under a hash of the
+	// source, every file it includes, the defines and the compiler options, so unchanged shaders load
+	// straight from the cache and an edit recompiles only the shaders that read the edited file.
+	// Outside debug builds the cached SPIR-V carries no debug information.
+	// Modules embedded into the executable at build time can be loaded instead, without touching the disk.
+	// Compiling from several threads at once is safe.
+	class ShaderCompiler {
+
+	public:
+
+		// Sources are looked up under shader_directory, compiled SPIR-V is kept in cache_directory.
+		// optimize runs spirv-opt's performance passes over every module. With embedded, a module the executable
+		// holds, compiled with the same settings, is used before anything on disk
+		ShaderCompiler(bool debug, const std::string& shader_directory, const std::string& cache_directory, bool optimize, bool embedded);
+
+		// The stage comes from the extension: .vert, .frag, .comp and so on. Empty on failure
+		std::vector<uint32_t> compile(const std::string& file_name, const std::vector<ShaderDefine>& defines = {});
+
+		const std::string& getShaderDirectory() const;
+
+		// True if the last compile of file_name read path, directly or through an include.
+		// Paths are written as shader_directory/name, the way the compiler resolves them
+		bool readsFile(const std::string& file_name, const std::string& path);
+
+		// Files edited since the build, in the form readsFile takes. Modules reading any of them are compiled
+		// from disk from now on, their embedded code is out of date
+		void markChanged(const std::vector<std::string>& paths);
+
+	private:
+
+		bool debug;
+		// Kept in debug builds, stripped in release builds
+		bool debug_info;
+		bool optimize;
+		bool embedded;
+		std::string shader_directory;
+		std::string cache_directory;
+		shaderc::Compiler compiler;
+
+		std::mutex dependency_mutex;
+		std::unordered_map<std::string, std::vector<std::string>> dependencies;
+		std::vector<std::string> changed_files;
+
+		// Records the module's sources like a compile would. False if it isn't embedded or a source has changed
+		bool loadEmbedded(const std::string& file_name, const std::vector<ShaderDefine>& defines, std::vector<uint32_t>& code);
+
+		// Filled in place, moving CompileOptions would leave its includer behind
+		void setOptions(shaderc::CompileOptions& options, const std::vector<ShaderDefine>& defines) const;
+
+		// Hashes the source and, recursively, each file it includes. False if a file can't be read
+		bool hashSources(const std::string& path, const std::string& source, uint64_t& hash, std::vector<std::string>& visited) const;
+
+		bool readCache(uint64_t key, std::vector<uint32_t>& code) const;
+		void writeCache(uint64_t key, const std::vector<uint32_t>& code) const;
+
+	};
+
+}
@@ -0,0 +1,106 @@
+#include "ShaderPermutation.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace vkUtil {
+
+	ShaderPermutation& ShaderPermutation::define(const std::string& name, const std::string& value) {
+
+		auto position = std::lower_bound(defines.begin(), defines.end(), name, [](const ShaderDefine& define, const std::string& name) {
+
+			return define.name < name;
+
+		});
+
+		if (position != defines.end() && position->name == name) {
+
+			position->value = value;
+
+		}
+		else {
+
+			defines.insert(position, { name, value });
+
+		}
+
+		return *this;
+
+	}
+
+	ShaderPermutation& ShaderPermutation::specialize(uint32_t id, bool value) {
+
+		return specialize(id, value ? 1u : 0u);
+
+	}
+
+	ShaderPermutation& ShaderPermutation::specialize(uint32_t id, int32_t value) {
+
+		return specialize(id, static_cast<uint32_t>(value));
+
+	}
+
+	ShaderPermutation& ShaderPermutation::specialize(uint32_t id, uint32_t value) {
+
+		auto position = std::lower_bound(constants.begin(), constants.end(), id, [](const SpecializationConstant& constant, uint32_t id) {
+
+			return constant.id < id;
+
+		});
+
+		if (position != constants.end() && position->id == id) {
+
+			position->value = value;
+
+		}
+		else {
+
+			constants.insert(position, { id, value });
+
+		}
+
+		return *this;
+
+	}
+
+	ShaderPermutation& ShaderPermutation::specialize(uint32_t id, float value) {
+
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		return specialize(id, bits);
+
+	}
+
+	bool ShaderPermutation::operator==(const ShaderPermutation& other) const {
+
+		if (defines.size() != other.defines.size() || constants.size() != other.constants.size()) {
+
+			return false;
+
+		}
+
+		for (size_t i = 0; i < defines.size(); ++i) {
+
+			if (defines[i].name != other.defines[i].name || defines[i].value != other.defines[i].value) {
+
+				return false;
+
+			}
+
+		}
+
+		for (size_t i = 0; i < constants.size(); ++i) {
+
+			if (constants[i].id != other.constants[i].id || constants[i].value != other.constants[i].value) {
+
+				return false;
+
+			}
+
+		}
+
+		return true;
+
+	}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "ShaderCompiler.hpp"
+
+namespace vkUtil {
+
+	// 32 bits whatever the GLSL type: a bool as VkBool32, an int or uint, or a float's bits
+	struct SpecializationConstant {
+
+		uint32_t id;
+		uint32_t value;
+
+	};
+
+	// Which variant of a shader a pipeline is built from. Defines are compiled in, every set of them is SPIR-V of
+	// its own. Specialization constants are applied when the pipeline is created, so one SPIR-V module serves every
+	// value and the driver folds away the branches they decide. Both lists are kept sorted, the order values are
+	// set in never makes two permutations differ
+	struct ShaderPermutation {
+
+		std::vector<ShaderDefine> defines;
+		std::vector<SpecializationConstant> constants;
+
+		// Each replaces an earlier value for the same name or constant id
+		ShaderPermutation& define(const std::string& name, const std::string& value = "1");
+		ShaderPermutation& specialize(uint32_t id, bool value);
+		ShaderPermutation& specialize(uint32_t id, int32_t value);
+		ShaderPermutation& specialize(uint32_t id, uint32_t value);
+		ShaderPermutation& specialize(uint32_t id, float value);
+
+		bool operator==(const ShaderPermutation& other) const;
+
+	};
+
+}
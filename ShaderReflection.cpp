@@ -0,0 +1,288 @@
+#include "ShaderReflection.hpp"
+#include <spirv_cross/spirv_cross.hpp>
+#include <algorithm>
+#include <sstream>
+
+namespace vkUtil {
+
+	namespace {
+
+		uint32_t arraySize(const spirv_cross::SPIRType& type) {
+
+			// Runtime sized arrays count as one, the layout can't size them
+			if (type.array.empty() || !type.array_size_literal[0] || type.array[0] == 0) {
+
+				return 1;
+
+			}
+
+			uint32_t count = 1;
+
+			for (uint32_t dimension : type.array) {
+
+				count *= dimension;
+
+			}
+
+			return count;
+
+		}
+
+		bool formatOf(const spirv_cross::SPIRType& type, vk::Format& format) {
+
+			static const vk::Format float_formats[] = { vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat, vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat };
+			static const vk::Format int_formats[] = { vk::Format::eR32Sint, vk::Format::eR32G32Sint, vk::Format::eR32G32B32Sint, vk::Format::eR32G32B32A32Sint };
+			static const vk::Format uint_formats[] = { vk::Format::eR32Uint, vk::Format::eR32G32Uint, vk::Format::eR32G32B32Uint, vk::Format::eR32G32B32A32Uint };
+
+			// Matrix inputs take several locations, nothing here uses them
+			if (type.columns != 1 || type.vecsize < 1 || type.vecsize > 4) {
+
+				return false;
+
+			}
+
+			switch (type.basetype) {
+
+			case spirv_cross::SPIRType::Float:
+				format = float_formats[type.vecsize - 1];
+				return true;
+			case spirv_cross::SPIRType::Int:
+				format = int_formats[type.vecsize - 1];
+				return true;
+			case spirv_cross::SPIRType::UInt:
+				format = uint_formats[type.vecsize - 1];
+				return true;
+			default:
+				return false;
+
+			}
+
+		}
+
+		bool addBinding(const spirv_cross::Compiler& compiler, const spirv_cross::Resource& resource, vk::DescriptorType type,
+						vk::ShaderStageFlagBits stage, ShaderReflection& reflection, std::string& error) {
+
+			ReflectedBinding reflected = {};
+			reflected.set = compiler.get_decoration(resource.id, spv::DecorationDescriptorSet);
+			reflected.binding.binding = compiler.get_decoration(resource.id, spv::DecorationBinding);
+			reflected.binding.descriptorType = type;
+			reflected.binding.descriptorCount = arraySize(compiler.get_type(resource.type_id));
+			reflected.binding.stageFlags = stage;
+
+			for (ReflectedBinding& existing : reflection.bindings) {
+
+				if (existing.set != reflected.set || existing.binding.binding != reflected.binding.binding) {
+
+					continue;
+
+				}
+
+				if (existing.binding.descriptorType != type || existing.binding.descriptorCount != reflected.binding.descriptorCount) {
+
+					std::stringstream message;
+					message << "set " << reflected.set << " binding " << reflected.binding.binding << " is declared as "
+						<< vk::to_string(existing.binding.descriptorType) << "[" << existing.binding.descriptorCount << "] and "
+						<< vk::to_string(type) << "[" << reflected.binding.descriptorCount << "] by different stages";
+					error = message.str();
+
+					return false;
+
+				}
+
+				existing.binding.stageFlags |= stage;
+				return true;
+
+			}
+
+			reflection.bindings.push_back(reflected);
+			return true;
+
+		}
+
+		bool addBindings(const spirv_cross::Compiler& compiler, const spirv_cross::SmallVector<spirv_cross::Resource>& resources,
+						 vk::DescriptorType type, vk::DescriptorType buffer_type, vk::ShaderStageFlagBits stage, ShaderReflection& reflection, std::string& error) {
+
+			for (const spirv_cross::Resource& resource : resources) {
+
+				// Texel buffers are images with a buffer dimension
+				bool texel_buffer = compiler.get_type(resource.type_id).image.dim == spv::DimBuffer;
+
+				if (!addBinding(compiler, resource, texel_buffer ? buffer_type : type, stage, reflection, error)) {
+
+					return false;
+
+				}
+
+			}
+
+			return true;
+
+		}
+
+	}
+
+	uint32_t ShaderReflection::getSetCount() const {
+
+		uint32_t set_count = 0;
+
+		for (const ReflectedBinding& reflected : bindings) {
+
+			set_count = std::max(set_count, reflected.set + 1);
+
+		}
+
+		return set_count;
+
+	}
+
+	bool ShaderReflection::declaresConstant(vk::ShaderStageFlagBits stage, uint32_t constant_id) const {
+
+		for (const ReflectedConstant& constant : specialization_constants) {
+
+			if (constant.stage == stage && constant.constant_id == constant_id) {
+
+				return true;
+
+			}
+
+		}
+
+		return false;
+
+	}
+
+	std::vector<vk::DescriptorSetLayoutBinding> ShaderReflection::getSetBindings(uint32_t set) const {
+
+		std::vector<vk::DescriptorSetLayoutBinding> set_bindings;
+
+		for (const ReflectedBinding& reflected : bindings) {
+
+			if (reflected.set == set) {
+
+				set_bindings.push_back(reflected.binding);
+
+			}
+
+		}
+
+		std::sort(set_bindings.begin(), set_bindings.end(), [](const vk::DescriptorSetLayoutBinding& a, const vk::DescriptorSetLayoutBinding& b) {
+
+			return a.binding < b.binding;
+
+		});
+
+		return set_bindings;
+
+	}
+
+	bool reflectShader(const std::vector<uint32_t>& code, vk::ShaderStageFlagBits stage, ShaderReflection& reflection, std::string& error) {
+
+		try {
+
+			spirv_cross::Compiler compiler(code);
+			spirv_cross::ShaderResources resources = compiler.get_shader_resources();
+
+			reflection.stages |= stage;
+
+			bool bindings_added =
+				addBindings(compiler, resources.uniform_buffers, vk::DescriptorType::eUniformBuffer, vk::DescriptorType::eUniformBuffer, stage, reflection, error) &&
+				addBindings(compiler, resources.storage_buffers, vk::DescriptorType::eStorageBuffer, vk::DescriptorType::eStorageBuffer, stage, reflection, error) &&
+				addBindings(compiler, resources.sampled_images, vk::DescriptorType::eCombinedImageSampler, vk::DescriptorType::eUniformTexelBuffer, stage, reflection, error) &&
+				addBindings(compiler, resources.separate_images, vk::DescriptorType::eSampledImage, vk::DescriptorType::eUniformTexelBuffer, stage, reflection, error) &&
+				addBindings(compiler, resources.separate_samplers, vk::DescriptorType::eSampler, vk::DescriptorType::eSampler, stage, reflection, error) &&
+				addBindings(compiler, resources.storage_images, vk::DescriptorType::eStorageImage, vk::DescriptorType::eStorageTexelBuffer, stage, reflection, error) &&
+				addBindings(compiler, resources.subpass_inputs, vk::DescriptorType::eInputAttachment, vk::DescriptorType::eInputAttachment, stage, reflection, error);
+
+			if (!bindings_added) {
+
+				return false;
+
+			}
+
+			for (const spirv_cross::Resource& resource : resources.push_constant_buffers) {
+
+				uint32_t size = static_cast<uint32_t>(compiler.get_declared_struct_size(compiler.get_type(resource.base_type_id)));
+
+				if (reflection.push_constants.empty()) {
+
+					reflection.push_constants.push_back(vk::PushConstantRange(stage, 0, size));
+
+				}
+				else {
+
+					// Stages may not share a stage flag between ranges, one range wide enough for all of them is simplest
+					reflection.push_constants[0].stageFlags |= stage;
+					reflection.push_constants[0].size = std::max(reflection.push_constants[0].size, size);
+
+				}
+
+			}
+
+			for (const spirv_cross::SpecializationConstant& constant : compiler.get_specialization_constants()) {
+
+				const spirv_cross::SPIRType& type = compiler.get_type(compiler.get_constant(constant.id).constant_type);
+
+				// Booleans are declared one bit wide but specialized as a VkBool32
+				if (type.basetype != spirv_cross::SPIRType::Boolean && type.width != 32) {
+
+					error = "specialization constant " + std::to_string(constant.constant_id) + " isn't 32 bits wide";
+					return false;
+
+				}
+
+				reflection.specialization_constants.push_back({ stage, constant.constant_id });
+
+			}
+
+			if (stage != vk::ShaderStageFlagBits::eVertex) {
+
+				return true;
+
+			}
+
+			std::vector<std::pair<uint32_t, vk::Format>> inputs;
+
+			for (const spirv_cross::Resource& resource : resources.stage_inputs) {
+
+				vk::Format format;
+
+				if (!formatOf(compiler.get_type(resource.type_id), format)) {
+
+					error = "vertex input \"" + resource.name + "\" has a type vertex attributes can't hold";
+					return false;
+
+				}
+
+				inputs.push_back({ compiler.get_decoration(resource.id, spv::DecorationLocation), format });
+
+			}
+
+			std::sort(inputs.begin(), inputs.end(), [](const std::pair<uint32_t, vk::Format>& a, const std::pair<uint32_t, vk::Format>& b) {
+
+				return a.first < b.first;
+
+			});
+
+			// Every component is 32 bits
+			uint32_t offset = 0;
+
+			for (const std::pair<uint32_t, vk::Format>& input : inputs) {
+
+				reflection.vertex_inputs.push_back(vk::VertexInputAttributeDescription(input.first, 0, input.second, offset));
+				offset += 4 * vk::componentCount(input.second);
+
+			}
+
+			return true;
+
+		}
+		catch (const spirv_cross::CompilerError& compiler_error) {
+
+			error = compiler_error.what();
+			return false;
+
+		}
+
+	}
+
+}
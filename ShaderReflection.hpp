@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace vkUtil {
+
+	struct ReflectedBinding {
+
+		uint32_t set;
+		vk::DescriptorSetLayoutBinding binding;
+
+	};
+
+	struct ReflectedConstant {
+
+		vk::ShaderStageFlagBits stage;
+		uint32_t constant_id;
+
+	};
+
+	// The resources a pipeline's shaders declare, merged over its stages
+	struct ShaderReflection {
+
+		vk::ShaderStageFlags stages;
+		std::vector<ReflectedBinding> bindings;
+		// At most one range, covering every stage that has a push constant block
+		std::vector<vk::PushConstantRange> push_constants;
+		// Vertex stage inputs packed in location order into binding 0
+		std::vector<vk::VertexInputAttributeDescription> vertex_inputs;
+		// Specialization constants of each stage, all of them 32 bits wide
+		std::vector<ReflectedConstant> specialization_constants;
+
+		// Sets up to and including the highest one a binding uses
+		uint32_t getSetCount() const;
+		bool declaresConstant(vk::ShaderStageFlagBits stage, uint32_t constant_id) const;
+		// Sorted by binding number
+		std::vector<vk::DescriptorSetLayoutBinding> getSetBindings(uint32_t set) const;
+
+	};
+
+	// Adds one stage's resources through SPIRV-Cross. False, with the reason in error, for unreadable SPIR-V or a
+	// resource that disagrees with what an earlier stage declared for the same set and binding, or a specialization constant wider than 32 bits
+	bool reflectShader(const std::vector<uint32_t>& code, vk::ShaderStageFlagBits stage, ShaderReflection& reflection, std::string& error);
+
+}
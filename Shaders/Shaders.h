@@ -4,25 +4,47 @@
 #include <iostream>
 #include <vector>
 #include <vulkan/vulkan.hpp>
+#include "../Allocator.hpp"
+#include "../ShaderCompiler.hpp"
 
 namespace vkUtil {
 
-	std::vector<char> readFile(bool debug, std::string file_path) {
+	// SPIR-V read straight into 32-bit words. A char buffer isn't guaranteed the alignment pCode needs, and a
+	// file that isn't a whole number of words can't be SPIR-V. Empty if the file can't be read
+	std::vector<uint32_t> readFile(bool debug, std::string file_path) {
 
 		std::ifstream file(file_path, std::ios::ate | std::ios::binary);
 
-		if (debug && !file.is_open()) {
+		if (!file.is_open()) {
 
-			std::cout << "Failed to load \"" << file_path << "\"" << std::endl;
+			if (debug) {
+
+				std::cout << "Failed to load \"" << file_path << "\"" << std::endl;
+
+			}
+
+			return {};
 
 		}
 
 		size_t file_size = static_cast<size_t> (file.tellg());
 
-		std::vector<char> buffer(file_size);
+		if (file_size == 0 || file_size % sizeof(uint32_t) != 0) {
+
+			if (debug) {
+
+				std::cout << "\"" << file_path << "\" isn't SPIR-V" << std::endl;
+
+			}
+
+			return {};
+
+		}
+
+		std::vector<uint32_t> buffer(file_size / sizeof(uint32_t));
 
 		file.seekg(0);
-		file.read(buffer.data(), file_size);
+		file.read(reinterpret_cast<char*>(buffer.data()), file_size);
 
 		file.close();
 
@@ -30,18 +52,17 @@ namespace vkUtil {
 
 	}
 
-	vk::ShaderModule createShaderModule(bool debug, std::string file_path, vk::Device logical_device) {
-
-		std::vector<char> source_code = readFile(debug, file_path);
+	// The pipeline helpers compile and reflect the code first, file_path only names it in errors
+	vk::ShaderModule createShaderModule(bool debug, const std::vector<uint32_t>& code, std::string file_path, vk::Device logical_device) {
 
 		vk::ShaderModuleCreateInfo shader_module_info = {};
 		shader_module_info.flags = vk::ShaderModuleCreateFlags();
-		shader_module_info.codeSize = source_code.size();
-		shader_module_info.pCode = reinterpret_cast<const uint32_t*>(source_code.data());
+		shader_module_info.codeSize = code.size() * sizeof(uint32_t);
+		shader_module_info.pCode = code.data();
 
 		try {
 
-			return logical_device.createShaderModule(shader_module_info);
+			return logical_device.createShaderModule(shader_module_info, vkUtil::hostAllocator());
 
 		}
 		catch (vk::SystemError err) {
@@ -52,6 +73,8 @@ namespace vkUtil {
 
 			}
 
+			return nullptr;
+
 		}
 
 
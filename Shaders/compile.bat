@@ -1,4 +1,3 @@
-C:\VulkanSDK\1.3.246.1\Bin\glslc.exe shader.vert -o vertex.spv
-C:\VulkanSDK\1.3.246.1\Bin\glslc.exe shader.frag -o fragment.spv
+python embed_shaders.py EmbeddedShaderData.inl
 
 pause
\ No newline at end of file
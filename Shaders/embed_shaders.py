@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+# Compiles the shaders the engine builds at startup with glslc and writes them out as C++ arrays, so the executable
+# starts without reading a shader from disk. Run by the pre-build step:
+#
+#     python Shaders/embed_shaders.py Shaders/EmbeddedShaderData.inl
+#
+# Each module is embedded twice, with debug information and stripped of it, compiled the way ShaderCompiler compiles
+# with optimization on. Without glslc an empty registry is written and every shader comes from disk as before.
+
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+SHADER_DIRECTORY = os.path.dirname(os.path.abspath(__file__))
+
+# File and defines, as the engine passes them to ShaderCompiler::compile. Defines sorted by name, the way
+# ShaderPermutation keeps them
+MODULES = [
+    ("shader.vert", []),
+    ("shader.vert", [("DEPTH_ONLY", "1")]),
+    ("shader.frag", []),
+    ("shader_occlusion.vert", []),
+    ("meshlet.vert", []),
+    ("meshlet.vert", [("DEPTH_ONLY", "1")]),
+    ("meshlet_cull.comp", []),
+    ("occlusion_cull.comp", []),
+    ("depth_reduce.comp", []),
+]
+
+SPIRV_MAGIC = 0x07230203
+
+# OpSourceContinued, OpSource, OpSourceExtension, OpName, OpMemberName, OpString, OpLine, OpNoLine, OpModuleProcessed.
+# The same instructions ShaderCompiler strips outside debug builds
+DEBUG_OPCODES = {2, 3, 4, 5, 6, 7, 8, 317, 330}
+
+
+def find_glslc():
+
+    sdk = os.environ.get("VULKAN_SDK")
+
+    if sdk:
+
+        for name in ("glslc.exe", "glslc"):
+
+            path = os.path.join(sdk, "Bin", name)
+
+            if os.path.isfile(path):
+
+                return path
+
+    return shutil.which("glslc")
+
+
+def compile_module(glslc, file_name, defines, debug_info, output_path):
+
+    # Matches ShaderCompiler::setOptions with optimization on
+    arguments = [glslc, "--target-env=vulkan1.0", "-O", "-I", "."]
+    arguments += ["-D%s=%s" % define for define in defines]
+
+    if debug_info:
+
+        arguments.append("-g")
+
+    subprocess.run(arguments + [file_name, "-o", output_path], cwd=SHADER_DIRECTORY, check=True)
+
+    with open(output_path, "rb") as file:
+
+        data = file.read()
+
+    words = [int.from_bytes(data[i:i + 4], "little") for i in range(0, len(data), 4)]
+
+    if len(data) % 4 != 0 or not words or words[0] != SPIRV_MAGIC:
+
+        raise RuntimeError("glslc wrote something that isn't SPIR-V for " + file_name)
+
+    return words if debug_info else strip_debug_info(words)
+
+
+def strip_debug_info(words):
+
+    # The five word header, then instructions whose first word holds the word count above the opcode
+    stripped = words[:5]
+    position = 5
+
+    while position < len(words):
+
+        count = words[position] >> 16
+        opcode = words[position] & 0xFFFF
+
+        if count == 0:
+
+            raise RuntimeError("malformed SPIR-V instruction")
+
+        if opcode not in DEBUG_OPCODES:
+
+            stripped += words[position:position + count]
+
+        position += count
+
+    return stripped
+
+
+def read_sources(glslc, file_name, defines):
+
+    # glslc -M prints a make rule, "target: source include...", paths relative to the shader directory
+    arguments = [glslc, "-M", "-I", "."] + ["-D%s=%s" % define for define in defines] + [file_name]
+    rule = subprocess.run(arguments, cwd=SHADER_DIRECTORY, check=True, capture_output=True, text=True).stdout
+    sources = rule.split(":", 1)[1].replace("\\\n", " ").split()
+
+    return [os.path.normpath(source).replace("\\", "/") for source in sources]
+
+
+def write_registry(output_path, entries):
+
+    lines = ["// Generated by Shaders/embed_shaders.py, do not edit", ""]
+    lines.append("namespace {")
+    lines.append("")
+
+    for index, (file_name, defines, debug_info, sources, words) in enumerate(entries):
+
+        lines.append("\tconst uint32_t module_%d_code[] = {" % index)
+
+        for row in range(0, len(words), 8):
+
+            lines.append("\t\t" + ", ".join("0x%08x" % word for word in words[row:row + 8]) + ",")
+
+        lines.append("\t};")
+        source_list = ", ".join('"%s"' % source for source in sources)
+        lines.append("\tconst char* const module_%d_sources[] = { %s, nullptr };" % (index, source_list))
+        lines.append("")
+
+    lines.append("}")
+    lines.append("")
+    lines.append("const EmbeddedShader embedded_shaders[] = {")
+    lines.append("")
+
+    for index, (file_name, defines, debug_info, sources, words) in enumerate(entries):
+
+        define_text = ";".join("%s=%s" % define for define in defines)
+        lines.append('\t{ "%s", "%s", module_%d_sources, module_%d_code, %d, true, %s },' %
+                     (file_name, define_text, index, index, len(words), "true" if debug_info else "false"))
+
+    lines.append("\t{ nullptr, nullptr, nullptr, nullptr, 0, false, false }")
+    lines.append("")
+    lines.append("};")
+    lines.append("")
+
+    text = "\n".join(lines)
+
+    # Left alone when nothing changed, so the registry isn't recompiled on every build
+    if os.path.isfile(output_path):
+
+        with open(output_path, "r") as file:
+
+            if file.read() == text:
+
+                return
+
+    with open(output_path, "w") as file:
+
+        file.write(text)
+
+
+def main():
+
+    if len(sys.argv) != 2:
+
+        print("usage: embed_shaders.py <output .inl>")
+        return 1
+
+    glslc = find_glslc()
+    entries = []
+
+    if glslc is None:
+
+        print("embed_shaders: glslc not found, the executable will read its shaders from disk")
+
+    else:
+
+        with tempfile.TemporaryDirectory() as directory:
+
+            output_path = os.path.join(directory, "module.spv")
+
+            for file_name, defines in MODULES:
+
+                sources = read_sources(glslc, file_name, defines)
+
+                for debug_info in (True, False):
+
+                    words = compile_module(glslc, file_name, defines, debug_info, output_path)
+                    entries.append((file_name, sorted(defines), debug_info, sources, words))
+
+    write_registry(sys.argv[1], entries)
+    return 0
+
+
+if __name__ == "__main__":
+
+    sys.exit(main())
@@ -0,0 +1,30 @@
+#version 450
+
+// DEPTH_ONLY builds the depth pre-pass variant, reading positions only from the same vertex stream
+layout(location = 0) in vec3 vertex_position;
+#ifndef DEPTH_ONLY
+layout(location = 1) in vec3 vertex_normal;
+#endif
+
+layout (push_constant) uniform constants {
+
+	mat4 model;
+	mat4 view_projection;
+
+} ObjectData;
+
+#ifndef DEPTH_ONLY
+layout(location = 0) out vec3 frag_color;
+#endif
+
+// The shading pass depth-tests EQUAL against the pre-pass, both must produce identical positions
+invariant gl_Position;
+
+void main(){
+
+	gl_Position = ObjectData.view_projection * ObjectData.model * vec4(vertex_position, 1.0);
+#ifndef DEPTH_ONLY
+	frag_color = 0.5 * vertex_normal + 0.5;
+#endif
+
+}
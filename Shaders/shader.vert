@@ -8,6 +8,8 @@ vec2 positions[3] = vec2[](
 
 );
 
+// DEPTH_ONLY builds the depth pre-pass variant, without a color output
+#ifndef DEPTH_ONLY
 vec3 colors[3] = vec3[](
 
 	vec3(1.0, 0.0, 0.0),
@@ -15,19 +17,33 @@ vec3 colors[3] = vec3[](
 	vec3(0.0, 0.0, 1.0)
 
 );
+#endif
+
+// In draw order, a batched draw's instances cover its run of the buffer starting at its first instance
+layout(std430, set = 0, binding = 0) readonly buffer Transforms {
+
+	mat4 world_matrices[];
+
+};
 
 layout (push_constant) uniform constants {
 
-	mat4 model;
+	mat4 view_projection;
 
 } ObjectData;
 
-
+#ifndef DEPTH_ONLY
 layout(location = 0) out vec3 frag_color;
+#endif
+
+// The shading pass depth-tests EQUAL against the pre-pass, both must produce identical positions
+invariant gl_Position;
 
 void main(){
 
-	gl_Position = ObjectData.model * vec4(positions[gl_VertexIndex], 0.0, 1.0);
+	gl_Position = ObjectData.view_projection * world_matrices[gl_InstanceIndex] * vec4(positions[gl_VertexIndex], 0.0, 1.0);
+#ifndef DEPTH_ONLY
 	frag_color = colors[gl_VertexIndex];
+#endif
 
 }
\ No newline at end of file
@@ -0,0 +1,48 @@
+#version 450
+
+vec2 positions[3] = vec2[](
+
+	vec2(0.0, -0.05),
+	vec2(0.05, 0.05),
+	vec2(-0.05, 0.05)
+
+);
+
+vec3 colors[3] = vec3[](
+
+	vec3(1.0, 0.0, 0.0),
+	vec3(0.0, 1.0, 0.0),
+	vec3(0.0, 0.0, 1.0)
+
+);
+
+layout(std430, set = 0, binding = 0) readonly buffer Objects {
+
+	vec4 object_spheres[];
+
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer VisibleObjects {
+
+	uint visible_objects[];
+
+};
+
+layout (push_constant) uniform constants {
+
+	mat4 model;
+	mat4 view_projection;
+
+} ObjectData;
+
+
+layout(location = 0) out vec3 frag_color;
+
+void main(){
+
+	vec3 position = object_spheres[visible_objects[gl_InstanceIndex]].xyz;
+
+	gl_Position = ObjectData.view_projection * vec4(vec3(positions[gl_VertexIndex], 0.0) + position, 1.0);
+	frag_color = colors[gl_VertexIndex];
+
+}
@@ -0,0 +1,299 @@
+#include "SpatialGrid.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace vkUtil {
+
+	// All 32 bits of every axis reach the hash, and the map compares the coordinates themselves,
+	// so cells far apart never share an entry
+	size_t SpatialGrid::CellHash::operator()(const glm::ivec3& coordinates) const {
+
+		uint64_t hash = static_cast<uint32_t>(coordinates.x);
+		hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(coordinates.y);
+		hash = hash * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(coordinates.z);
+		return static_cast<size_t>(hash ^ (hash >> 32));
+
+	}
+
+	SpatialGrid::SpatialGrid(float cell_size) {
+
+		this->cell_size = cell_size;
+		this->inverse_cell_size = 1.0f / cell_size;
+		max_half_extent = glm::vec3(0.0f);
+		object_count = 0;
+
+	}
+
+	glm::ivec3 SpatialGrid::cellCoordinates(const AABB& bounds) const {
+
+		return glm::ivec3(glm::floor(0.5f * (bounds.min + bounds.max) * inverse_cell_size));
+
+	}
+
+	uint32_t SpatialGrid::findOrAddCell(const glm::ivec3& coordinates) {
+
+		auto found = cell_lookup.find(coordinates);
+
+		if (found != cell_lookup.end()) {
+
+			return found->second;
+
+		}
+
+		uint32_t cell_index = static_cast<uint32_t>(cells.size());
+		cells.push_back({ coordinates, {} });
+		cell_lookup.emplace(coordinates, cell_index);
+
+		return cell_index;
+
+	}
+
+	void SpatialGrid::insert(uint32_t object, const AABB& bounds) {
+
+		if (object >= entries.size()) {
+
+			entries.resize(object + 1, { {}, not_present, not_present });
+
+		}
+
+		if (entries[object].cell != not_present) {
+
+			move(object, bounds);
+			return;
+
+		}
+
+		max_half_extent = glm::max(max_half_extent, 0.5f * (bounds.max - bounds.min));
+
+		uint32_t cell_index = findOrAddCell(cellCoordinates(bounds));
+		std::vector<uint32_t>& cell_objects = cells[cell_index].objects;
+
+		entries[object] = { bounds, cell_index, static_cast<uint32_t>(cell_objects.size()) };
+		cell_objects.push_back(object);
+		++object_count;
+
+	}
+
+	void SpatialGrid::removeFromCell(uint32_t object) {
+
+		Entry& entry = entries[object];
+		std::vector<uint32_t>& cell_objects = cells[entry.cell].objects;
+
+		uint32_t last_object = cell_objects.back();
+		cell_objects[entry.slot] = last_object;
+		entries[last_object].slot = entry.slot;
+		cell_objects.pop_back();
+
+		if (!cell_objects.empty()) {
+
+			return;
+
+		}
+
+		// The last cell takes the emptied one's place, its objects follow it there
+		uint32_t emptied_cell = entry.cell;
+		uint32_t last_cell = static_cast<uint32_t>(cells.size() - 1);
+		cell_lookup.erase(cells[emptied_cell].coordinates);
+
+		if (emptied_cell != last_cell) {
+
+			cells[emptied_cell] = std::move(cells[last_cell]);
+			cell_lookup[cells[emptied_cell].coordinates] = emptied_cell;
+
+			for (uint32_t moved_object : cells[emptied_cell].objects) {
+
+				entries[moved_object].cell = emptied_cell;
+
+			}
+
+		}
+
+		cells.pop_back();
+
+	}
+
+	void SpatialGrid::move(uint32_t object, const AABB& bounds) {
+
+		Entry& entry = entries[object];
+		entry.bounds = bounds;
+		max_half_extent = glm::max(max_half_extent, 0.5f * (bounds.max - bounds.min));
+
+		glm::ivec3 coordinates = cellCoordinates(bounds);
+
+		// Most moves stay within the cell and only touch the entry
+		if (coordinates == cells[entry.cell].coordinates) {
+
+			return;
+
+		}
+
+		// First, removing may renumber the cells
+		removeFromCell(object);
+
+		uint32_t cell_index = findOrAddCell(coordinates);
+		std::vector<uint32_t>& cell_objects = cells[cell_index].objects;
+		entry.cell = cell_index;
+		entry.slot = static_cast<uint32_t>(cell_objects.size());
+		cell_objects.push_back(object);
+
+	}
+
+	void SpatialGrid::remove(uint32_t object) {
+
+		if (!contains(object)) {
+
+			return;
+
+		}
+
+		removeFromCell(object);
+		entries[object].cell = not_present;
+		--object_count;
+
+	}
+
+	bool SpatialGrid::contains(uint32_t object) const {
+
+		return object < entries.size() && entries[object].cell != not_present;
+
+	}
+
+	size_t SpatialGrid::getObjectCount() const {
+
+		return object_count;
+
+	}
+
+	AABB SpatialGrid::looseCellBounds(const Cell& cell) const {
+
+		glm::vec3 cell_min = glm::vec3(cell.coordinates) * cell_size;
+		return { cell_min - max_half_extent, cell_min + glm::vec3(cell_size) + max_half_extent };
+
+	}
+
+	template<typename Emit>
+	void SpatialGrid::queryCells(const Frustum& frustum, size_t first_cell, size_t last_cell, Emit&& emit) const {
+
+		for (size_t i = first_cell; i < last_cell; ++i) {
+
+			const Cell& cell = cells[i];
+			AABB cell_bounds = looseCellBounds(cell);
+			uint32_t plane_mask = 0x3F;
+
+			if (!boxInFrustum(frustum, cell_bounds.min, cell_bounds.max, plane_mask)) {
+
+				continue;
+
+			}
+
+			for (uint32_t object : cell.objects) {
+
+				uint32_t object_mask = plane_mask;
+				const AABB& bounds = entries[object].bounds;
+
+				if (object_mask == 0 || boxInFrustum(frustum, bounds.min, bounds.max, object_mask)) {
+
+					emit(object);
+
+				}
+
+			}
+
+		}
+
+	}
+
+	void SpatialGrid::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& visible_objects) const {
+
+		visible_objects.clear();
+		queryCells(frustum, 0, cells.size(), [&visible_objects](uint32_t object) { visible_objects.push_back(object); });
+
+	}
+
+	void SpatialGrid::queryFrustumParallel(const Frustum& frustum, std::vector<uint32_t>& visible_objects, jobs::JobSystem& job_system) const {
+
+		struct PartialResult {
+
+			uint32_t* objects;
+			uint32_t count;
+
+		};
+
+		visible_objects.clear();
+
+		// parallelFor still runs its body once for no items, which would write a result the arena never sized
+		if (cells.empty()) {
+
+			return;
+
+		}
+
+		size_t batch_size = job_system.batchSizeFor(cells.size());
+		size_t batch_count = (cells.size() + batch_size - 1) / batch_size;
+		PartialResult* partial_results = job_system.getThreadArena().allocateArray<PartialResult>(batch_count);
+
+		job_system.parallelFor(cells.size(), batch_size, [&](size_t first_cell, size_t last_cell) {
+
+			// Sized for every object in the batch's cells, from the arena of whichever thread runs it
+			size_t capacity = 0;
+
+			for (size_t i = first_cell; i < last_cell; ++i) {
+
+				capacity += cells[i].objects.size();
+
+			}
+
+			PartialResult& partial_result = partial_results[first_cell / batch_size];
+			partial_result.objects = job_system.getThreadArena().allocateArray<uint32_t>(capacity);
+			partial_result.count = 0;
+
+			queryCells(frustum, first_cell, last_cell, [&partial_result](uint32_t object) {
+
+				partial_result.objects[partial_result.count++] = object;
+
+			});
+
+		});
+
+		for (size_t i = 0; i < batch_count; ++i) {
+
+			visible_objects.insert(visible_objects.end(), partial_results[i].objects, partial_results[i].objects + partial_results[i].count);
+
+		}
+
+	}
+
+	RayHit SpatialGrid::raycast(const glm::vec3& origin, const glm::vec3& direction, float max_distance) const {
+
+		glm::vec3 inverse_direction = 1.0f / direction;
+		RayHit closest = { false, 0, max_distance };
+
+		for (const Cell& cell : cells) {
+			AABB cell_bounds = looseCellBounds(cell);
+
+			if (intersectRayBox(origin, inverse_direction, cell_bounds.min, cell_bounds.max) > closest.distance) {
+
+				continue;
+
+			}
+
+			for (uint32_t object : cell.objects) {
+
+				const AABB& bounds = entries[object].bounds;
+				float distance = intersectRayBox(origin, inverse_direction, bounds.min, bounds.max);
+
+				if (distance <= closest.distance) {
+
+					closest = { true, object, distance };
+
+				}
+
+			}
+
+		}
+
+		return closest;
+
+	}
+
+}
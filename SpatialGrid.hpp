@@ -0,0 +1,85 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include "Culling.hpp"
+#include "JobSystem.hpp"
+
+namespace vkUtil {
+
+	// Loose hashed uniform grid: an object lives in the one cell holding its center, and every
+	// cell's bounds are widened by the largest object half extent seen. Insert, move and remove
+	// are O(1) amortized, so it suits objects that move every frame where a BVH refit degrades.
+	// Only occupied cells are kept, so queries cost the same wherever the objects have been.
+	class SpatialGrid {
+
+	public:
+
+		SpatialGrid(float cell_size);
+
+		// Objects are caller-chosen indices, the grid grows to hold the largest one
+		void insert(uint32_t object, const AABB& bounds);
+		void move(uint32_t object, const AABB& bounds);
+		void remove(uint32_t object);
+
+		bool contains(uint32_t object) const;
+		size_t getObjectCount() const;
+
+		void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& visible_objects) const;
+
+		// Splits the cells into jobs, results are in no particular order. Scratch comes from the job
+		// system's thread arenas and is left there until they are reset
+		void queryFrustumParallel(const Frustum& frustum, std::vector<uint32_t>& visible_objects, jobs::JobSystem& job_system) const;
+
+		// Closest object whose bounds the ray enters within max_distance
+		RayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float max_distance) const;
+
+	private:
+
+		struct CellHash {
+
+			size_t operator()(const glm::ivec3& coordinates) const;
+
+		};
+
+		struct Cell {
+
+			glm::ivec3 coordinates;
+			std::vector<uint32_t> objects;
+
+		};
+
+		struct Entry {
+
+			AABB bounds;
+			uint32_t cell;
+			uint32_t slot;	// position in the cell's object list, for swap removal
+
+		};
+
+		static const uint32_t not_present = 0xFFFFFFFF;
+
+		float cell_size;
+		float inverse_cell_size;
+		glm::vec3 max_half_extent;
+		size_t object_count;
+
+		std::unordered_map<glm::ivec3, uint32_t, CellHash> cell_lookup;
+		// Never empty, a cell is swapped out of the list once its last object leaves
+		std::vector<Cell> cells;
+		std::vector<Entry> entries;
+
+		glm::ivec3 cellCoordinates(const AABB& bounds) const;
+		uint32_t findOrAddCell(const glm::ivec3& coordinates);
+		// Leaves the object's entry pointing at a cell it is no longer in
+		void removeFromCell(uint32_t object);
+		// Calls emit(object) for each visible object in the cells
+		template<typename Emit>
+		void queryCells(const Frustum& frustum, size_t first_cell, size_t last_cell, Emit&& emit) const;
+		AABB looseCellBounds(const Cell& cell) const;
+
+	};
+
+}
\ No newline at end of file
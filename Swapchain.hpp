@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 #include <iostream>
 #include <set>
 #include <optional>
@@ -210,7 +211,7 @@ namespace vkInit {
 
 		try {
 
-			bundle.swapchain = logical_device.createSwapchainKHR(create_swapchain_info);
+			bundle.swapchain = logical_device.createSwapchainKHR(create_swapchain_info, vkUtil::hostAllocator());
 
 		}
 		catch (vk::SystemError err) {
@@ -242,7 +243,7 @@ namespace vkInit {
 			create_image_view_info.format = format.format;
 
 			bundle.frames[i].image = images[i];
-			bundle.frames[i].image_view = logical_device.createImageView(create_image_view_info);
+			bundle.frames[i].image_view = logical_device.createImageView(create_image_view_info, vkUtil::hostAllocator());
 
 		}
 
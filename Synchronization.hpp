@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.hpp>
+#include "Allocator.hpp"
 
 namespace vkInit {
 
@@ -11,7 +12,7 @@ namespace vkInit {
 
 		try {
 
-			return logical_device.createSemaphore(semaphore_info);
+			return logical_device.createSemaphore(semaphore_info, vkUtil::hostAllocator());
 
 		}
 		catch (vk::SystemError err) {
@@ -35,7 +36,7 @@ namespace vkInit {
 
 		try {
 
-			return logical_device.createFence(fence_info);
+			return logical_device.createFence(fence_info, vkUtil::hostAllocator());
 
 		}
 		catch (vk::SystemError err) {
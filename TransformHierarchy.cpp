@@ -0,0 +1,279 @@
+#include "TransformHierarchy.hpp"
+#include <algorithm>
+
+namespace vkUtil {
+
+	namespace {
+
+		// Below this many objects a level is cheaper to run on one thread than to hand out
+		const size_t parallel_level_threshold = 4096;
+
+	}
+
+	void TransformHierarchy::insert(uint32_t object, uint32_t parent, const glm::mat4& local) {
+
+		if (object >= nodes.size()) {
+
+			size_t size = object + 1;
+			nodes.resize(size, { no_parent, 0, 0, false });
+			children.resize(size);
+			local_matrices.resize(size, glm::mat4(1.0f));
+			world_matrices.resize(size, glm::mat4(1.0f));
+			dirty.resize(size, 0);
+			changed.resize(size, 0);
+
+		}
+
+		if (nodes[object].present) {
+
+			remove(object);
+
+		}
+
+		if (!contains(parent)) {
+
+			parent = no_parent;
+
+		}
+
+		nodes[object].present = true;
+		nodes[object].parent = parent;
+		local_matrices[object] = local;
+		dirty[object] = 1;
+
+		if (parent != no_parent) {
+
+			children[parent].push_back(object);
+
+		}
+
+		addToLevel(object, parent == no_parent ? 0 : nodes[parent].depth + 1);
+
+	}
+
+	void TransformHierarchy::remove(uint32_t object) {
+
+		if (!contains(object)) {
+
+			return;
+
+		}
+
+		// Copied, detaching edits the list
+		std::vector<uint32_t> orphans = children[object];
+
+		for (uint32_t child : orphans) {
+
+			setParent(child, no_parent);
+
+		}
+
+		detach(object);
+		removeFromLevel(object);
+		nodes[object].present = false;
+
+	}
+
+	bool TransformHierarchy::setParent(uint32_t object, uint32_t parent) {
+
+		if (!contains(object)) {
+
+			return false;
+
+		}
+
+		if (!contains(parent)) {
+
+			parent = no_parent;
+
+		}
+
+		for (uint32_t ancestor = parent; ancestor != no_parent; ancestor = nodes[ancestor].parent) {
+
+			if (ancestor == object) {
+
+				return false;
+
+			}
+
+		}
+
+		detach(object);
+		nodes[object].parent = parent;
+
+		if (parent != no_parent) {
+
+			children[parent].push_back(object);
+
+		}
+
+		setDepth(object, parent == no_parent ? 0 : nodes[parent].depth + 1);
+		dirty[object] = 1;
+
+		return true;
+
+	}
+
+	void TransformHierarchy::setLocal(uint32_t object, const glm::mat4& local) {
+
+		local_matrices[object] = local;
+		dirty[object] = 1;
+
+	}
+
+	bool TransformHierarchy::contains(uint32_t object) const {
+
+		return object < nodes.size() && nodes[object].present;
+
+	}
+
+	uint32_t TransformHierarchy::getParent(uint32_t object) const {
+
+		return nodes[object].parent;
+
+	}
+
+	const std::vector<uint32_t>& TransformHierarchy::getChildren(uint32_t object) const {
+
+		return children[object];
+
+	}
+
+	const glm::mat4& TransformHierarchy::getWorld(uint32_t object) const {
+
+		return world_matrices[object];
+
+	}
+
+	void TransformHierarchy::addToLevel(uint32_t object, uint32_t depth) {
+
+		if (depth >= levels.size()) {
+
+			levels.resize(depth + 1);
+
+		}
+
+		nodes[object].depth = depth;
+		nodes[object].level_slot = static_cast<uint32_t>(levels[depth].size());
+		levels[depth].push_back(object);
+
+	}
+
+	void TransformHierarchy::removeFromLevel(uint32_t object) {
+
+		std::vector<uint32_t>& level = levels[nodes[object].depth];
+		uint32_t slot = nodes[object].level_slot;
+		uint32_t last_object = level.back();
+
+		level[slot] = last_object;
+		nodes[last_object].level_slot = slot;
+		level.pop_back();
+
+	}
+
+	void TransformHierarchy::setDepth(uint32_t object, uint32_t depth) {
+
+		if (nodes[object].depth == depth) {
+
+			return;
+
+		}
+
+		removeFromLevel(object);
+		addToLevel(object, depth);
+
+		for (uint32_t child : children[object]) {
+
+			setDepth(child, depth + 1);
+
+		}
+
+	}
+
+	void TransformHierarchy::detach(uint32_t object) {
+
+		uint32_t parent = nodes[object].parent;
+
+		if (parent == no_parent) {
+
+			return;
+
+		}
+
+		std::vector<uint32_t>& siblings = children[parent];
+		siblings.erase(std::find(siblings.begin(), siblings.end(), object));
+		nodes[object].parent = no_parent;
+
+	}
+
+	template<typename Emit>
+	void TransformHierarchy::updateRange(const std::vector<uint32_t>& level, size_t first, size_t last, Emit&& emit) {
+
+		for (size_t i = first; i < last; ++i) {
+
+			uint32_t object = level[i];
+			uint32_t parent = nodes[object].parent;
+			bool recompute = dirty[object] || (parent != no_parent && changed[parent]);
+
+			if (recompute) {
+
+				world_matrices[object] = parent == no_parent ? local_matrices[object] : world_matrices[parent] * local_matrices[object];
+				dirty[object] = 0;
+				emit(object);
+
+			}
+
+			changed[object] = recompute;
+
+		}
+
+	}
+
+	void TransformHierarchy::update(jobs::JobSystem* job_system, std::vector<uint32_t>& changed_objects) {
+
+		struct PartialChange {
+
+			uint32_t* objects;
+			uint32_t count;
+
+		};
+
+		for (const std::vector<uint32_t>& level : levels) {
+
+			if (!job_system || level.size() < parallel_level_threshold) {
+
+				updateRange(level, 0, level.size(), [&changed_objects](uint32_t object) { changed_objects.push_back(object); });
+				continue;
+
+			}
+
+			size_t batch_size = job_system->batchSizeFor(level.size());
+			size_t batch_count = (level.size() + batch_size - 1) / batch_size;
+			PartialChange* partial_changes = job_system->getThreadArena().allocateArray<PartialChange>(batch_count);
+
+			// Returns once the whole level is done, the next level reads its matrices and changed flags
+			job_system->parallelFor(level.size(), batch_size, [&](size_t first, size_t last) {
+
+				PartialChange& partial_change = partial_changes[first / batch_size];
+				partial_change.objects = job_system->getThreadArena().allocateArray<uint32_t>(last - first);
+				partial_change.count = 0;
+
+				updateRange(level, first, last, [&partial_change](uint32_t object) {
+
+					partial_change.objects[partial_change.count++] = object;
+
+				});
+
+			});
+
+			for (size_t i = 0; i < batch_count; ++i) {
+
+				changed_objects.insert(changed_objects.end(), partial_changes[i].objects, partial_changes[i].objects + partial_changes[i].count);
+
+			}
+
+		}
+
+	}
+
+}
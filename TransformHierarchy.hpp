@@ -0,0 +1,68 @@
+#pragma once
+
+#include <glm/glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "JobSystem.hpp"
+
+namespace vkUtil {
+
+	// Parent/child world matrices, kept as one object list per depth. A level only reads the level above
+	// it, so levels run in order while the objects within one are split into jobs. Only objects
+	// whose local matrix changed, and everything below them, are recomputed.
+	class TransformHierarchy {
+
+	public:
+
+		static const uint32_t no_parent = 0xFFFFFFFF;
+
+		// Objects are caller-chosen indices, the hierarchy grows to hold the largest one
+		void insert(uint32_t object, uint32_t parent, const glm::mat4& local);
+
+		// Children of a removed object become roots
+		void remove(uint32_t object);
+
+		// Fails if the new parent sits below the object
+		bool setParent(uint32_t object, uint32_t parent);
+		void setLocal(uint32_t object, const glm::mat4& local);
+
+		bool contains(uint32_t object) const;
+		uint32_t getParent(uint32_t object) const;
+		const std::vector<uint32_t>& getChildren(uint32_t object) const;
+		const glm::mat4& getWorld(uint32_t object) const;
+
+		// Recomputes changed world matrices and appends their objects to changed_objects.
+		// Parallel levels take scratch from the job system's thread arenas
+		void update(jobs::JobSystem* job_system, std::vector<uint32_t>& changed_objects);
+
+	private:
+
+		struct Node {
+
+			uint32_t parent;
+			uint32_t depth;
+			uint32_t level_slot;
+			bool present;
+
+		};
+
+		std::vector<Node> nodes;
+		std::vector<std::vector<uint32_t>> children;
+		std::vector<glm::mat4> local_matrices;
+		std::vector<glm::mat4> world_matrices;
+		// Bytes rather than bools, threads write neighbouring entries
+		std::vector<uint8_t> dirty;
+		std::vector<uint8_t> changed;
+		std::vector<std::vector<uint32_t>> levels;
+
+		void addToLevel(uint32_t object, uint32_t depth);
+		void removeFromLevel(uint32_t object);
+		void setDepth(uint32_t object, uint32_t depth);
+		void detach(uint32_t object);
+		// Calls emit(object) for each object it recomputes
+		template<typename Emit>
+		void updateRange(const std::vector<uint32_t>& level, size_t first, size_t last, Emit&& emit);
+
+	};
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace vkUtil {
+
+	// Hands values from one producer thread to one consumer thread without either waiting on the other.
+	// The producer fills one slot, the consumer reads another, and the third holds the newest published
+	// value. Publishing swaps the filled slot into the middle, so an unread value is replaced by a newer one.
+	template<typename T>
+	class TripleBuffer {
+
+	public:
+
+		TripleBuffer() : state(1), write_index(0), read_index(2) {}
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		// Producer only, the slot to fill before publishing
+		T& getWriteBuffer() {
+
+			return buffers[write_index];
+
+		}
+
+		// Producer only, gives up the filled slot and takes back whichever one sat in the middle
+		void publish() {
+
+			uint8_t previous = state.exchange(static_cast<uint8_t>(write_index | fresh_bit), std::memory_order_acq_rel);
+			write_index = previous & index_mask;
+
+		}
+
+		// Consumer only, moves the newest published value into the read slot. False if nothing was
+		// published since the last call, the read slot then keeps the value it had
+		bool acquire() {
+
+			if (!(state.load(std::memory_order_relaxed) & fresh_bit)) {
+
+				return false;
+
+			}
+
+			uint8_t previous = state.exchange(static_cast<uint8_t>(read_index), std::memory_order_acq_rel);
+			read_index = previous & index_mask;
+
+			return true;
+
+		}
+
+		// Consumer only
+		const T& getReadBuffer() const {
+
+			return buffers[read_index];
+
+		}
+
+	private:
+
+		static const uint8_t index_mask = 3;
+		static const uint8_t fresh_bit = 4;
+
+		T buffers[3];
+		// Index of the middle slot, with fresh_bit set while it holds a value the consumer has not taken
+		std::atomic<uint8_t> state;
+		uint8_t write_index;
+		uint8_t read_index;
+
+	};
+
+}
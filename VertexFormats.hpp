@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vulkan/vulkan.hpp>
+#include <vector>
+#include "Mesh.hpp"
+
+namespace vkMesh {
+
+	std::vector<vk::VertexInputBindingDescription> getVertexBindingDescriptions() {
+
+		vk::VertexInputBindingDescription binding_description = {};
+		binding_description.binding = 0;
+		binding_description.stride = sizeof(Vertex);
+		binding_description.inputRate = vk::VertexInputRate::eVertex;
+
+		return { binding_description };
+
+	}
+
+	std::vector<vk::VertexInputAttributeDescription> getVertexAttributeDescriptions() {
+
+		std::vector<vk::VertexInputAttributeDescription> attribute_descriptions(2);
+
+		attribute_descriptions[0].binding = 0;
+		attribute_descriptions[0].location = 0;
+		attribute_descriptions[0].format = vk::Format::eR32G32B32Sfloat;
+		attribute_descriptions[0].offset = offsetof(Vertex, position);
+
+		attribute_descriptions[1].binding = 0;
+		attribute_descriptions[1].location = 1;
+		attribute_descriptions[1].format = vk::Format::eR32G32B32Sfloat;
+		attribute_descriptions[1].offset = offsetof(Vertex, normal);
+
+		return attribute_descriptions;
+
+	}
+
+}
@@ -1,11 +1,51 @@
 #include "Application.hpp"
 
-int main() {
+int main(int argc, char* argv[]) {
 
-	Application* CyanCrate = new Application(true, 640, 480);
+	bool benchmark = false;
+	bool render_thread = false;
+
+	for (int i = 1; i < argc; ++i) {
+
+		benchmark |= std::string(argv[i]) == "--benchmark";
+		render_thread |= std::string(argv[i]) == "--render-thread";
+
+	}
+
+	EngineSettings settings = {};
+	settings.meshlet_culling = false;
+	settings.sort_front_to_back = true;
+	settings.depth_prepass = false;
+	settings.batch_draws = true;
+	settings.occlusion_culling = false;
+	settings.async_compute = true;
+	settings.shader_hot_reload = true;
+	settings.pipeline_libraries = true;
+	settings.embedded_shaders = true;
+
+	// Validation layers would dominate the frame times and allocations a benchmark reports
+	bool debug = !benchmark;
+
+	Application* CyanCrate = new Application(debug, render_thread, 640, 480, settings);
+	int exit_code = 0;
+
+	if (benchmark) {
+
+		if (!CyanCrate->runBenchmark()) {
+
+			std::cout << "Steady-state loops allocated heap memory\n";
+			exit_code = 1;
+
+		}
+
+	}
+	else {
+
+		CyanCrate->runApplication();
+
+	}
 
-	CyanCrate->runApplication();
 	delete CyanCrate;
 
-	return 0;
+	return exit_code;
 }
\ No newline at end of file